@@ -1,6 +1,12 @@
 [org 0x7c00]
 [bits 16]
 
+; Sectors of kernel.bin to load; the Makefile passes the image size
+%ifndef KERNEL_SECTORS
+%define KERNEL_SECTORS 127
+%endif
+READ_CHUNK equ 64               ; Sectors per read: 32KB, never crosses 64KB
+
 _start:
     jmp main
 
@@ -32,26 +38,36 @@ main:
     mov byte [es:0x0003], 0x0F
     pop es
     
-    ; Load kernel to 0x8000 (32KB)
-    mov ax, 0x0800
-    mov es, ax
-    mov bx, 0x0000
-    mov dh, 127 ; Load 127 sectors (~64KB kernel)
-    mov dl, [boot_drive]
-    
     ; Reset disk system
     mov ah, 0x00
+    mov dl, [boot_drive]
     int 0x13
     jc .disk_error
     
-    ; Read 127 sectors from sector 2 (sector 1 is the bootloader)
-    mov ah, 0x02
-    mov al, 127
-    mov ch, 0x00
-    mov dh, 0x00
-    mov cl, 2
+    ; Load kernel to 0x8000 (32KB) from sector 1 (sector 0 is the
+    ; bootloader) with LBA extended reads, one chunk at a time
+    mov cx, KERNEL_SECTORS
+.read_loop:
+    mov ax, READ_CHUNK
+    cmp cx, ax
+    jae .read_chunk
+    mov ax, cx
+.read_chunk:
+    mov [dap_count], ax
+    push cx
+    mov si, dap
+    mov ah, 0x42
+    mov dl, [boot_drive]
     int 0x13
+    pop cx
     jc .disk_error
+    mov ax, [dap_count]
+    sub cx, ax
+    add [dap_lba], ax
+    shl ax, 5                   ; Sectors to paragraphs
+    add [dap_segment], ax
+    test cx, cx
+    jnz .read_loop
     
     ; Write 'S' to VGA
     push es
@@ -170,42 +186,6 @@ main:
     
     ; Infinite loop if we return
     jmp $
-    
-    ; If we return here, something went wrong
-    ; Write 'E' for error
-    push es
-    mov ax, 0xB800
-    mov es, ax
-    mov byte [es:0x000E], 'E'
-    mov byte [es:0x000F], 0x0F
-    pop es
-    
-    ; Infinite loop if we return
-    jmp $
-    
-    ; If we return here, something went wrong
-    ; Write 'E' for error
-    push es
-    mov ax, 0xB800
-    mov es, ax
-    mov byte [es:0x000E], 'E'
-    mov byte [es:0x000F], 0x0F
-    pop es
-    
-    ; Infinite loop if we return
-    jmp $
-    
-    ; If we return here, something went wrong
-    ; Write 'E' for error
-    push es
-    mov ax, 0xB800
-    mov es, ax
-    mov byte [es:0x000E], 'E'
-    mov byte [es:0x000F], 0x0F
-    pop es
-    
-    ; Infinite loop if we return
-    jmp $
 
 ; GDT
 gdt_start:
@@ -230,6 +210,19 @@ gdt_descriptor:
     dw gdt_end - gdt_start - 1
     dd gdt_start
 
+; Disk address packet for the extended read (int 0x13, ah=0x42)
+dap:
+    db 0x10                     ; Packet size
+    db 0
+dap_count:
+    dw 0                        ; Sectors to read
+    dw 0x0000                   ; Buffer offset
+dap_segment:
+    dw 0x0800                   ; Buffer segment (0x8000)
+dap_lba:
+    dd 1                        ; First sector
+    dd 0
+
 ; Data
 boot_drive db 0
 
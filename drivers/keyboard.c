@@ -1,6 +1,9 @@
 #include "keyboard.h"
 #include "../kernel/log.h"
 #include "../include/idt.h"
+#include "../include/spinlock.h"
+#include "../include/console.h"
+#include "../include/poll.h"
 
 static const char scancode_to_ascii_us[] = {
     0, 0, '&', 'e', '"', '\'', '(', '-', 'e', '_', 'c', 'a', ')', '=', '\b',
@@ -35,6 +38,7 @@ static int scroll_lock = 0;
 static char kb_buffer[KB_BUFFER_SIZE];
 static volatile int kb_write_ptr = 0;
 static volatile int kb_read_ptr = 0;
+static spinlock_t kb_lock;  // Shared between IRQ1 and keyboard_getchar()
 
 // Interrupt wrapper
 static void keyboard_interrupt_handler(struct regs* r) {
@@ -42,8 +46,14 @@ static void keyboard_interrupt_handler(struct regs* r) {
     keyboard_handler();
 }
 
+// Readiness source for epoll
+static uint32_t keyboard_poll(void) {
+    return keyboard_pending() ? POLLIN : 0;
+}
+
 void keyboard_init(void) {
     // Initialize buffer
+    spin_lock_init(&kb_lock, "keyboard");
     kb_write_ptr = 0;
     kb_read_ptr = 0;
 
@@ -55,6 +65,7 @@ void keyboard_init(void) {
 
     // Register the interrupt handler for IRQ1 (Vector 33)
     register_interrupt_handler(33, keyboard_interrupt_handler);
+    poll_register_source(POLL_SRC_KEYBOARD, keyboard_poll);
     
     // Set the command byte: Enable IRQ1 and Translation
     outb(KEYBOARD_STATUS_PORT, 0x20); // Read Command Byte command
@@ -86,11 +97,14 @@ void keyboard_handler(void) {
 
     // Explicitly handle Backspace scancode (Set 1: 0x0E)
     if (scancode == 0x0E) {
+        spin_lock(&kb_lock);
         int next_write = (kb_write_ptr + 1) % KB_BUFFER_SIZE;
         if (next_write != kb_read_ptr) {
             kb_buffer[kb_write_ptr] = '\b';
             kb_write_ptr = next_write;
         }
+        spin_unlock(&kb_lock);
+        console_wake_input();
         return;
     }
 
@@ -147,27 +161,39 @@ void keyboard_handler(void) {
         }
         
         if (base_char != 0) {
-            // Add to buffer
+            // Add to buffer (IRQ context: interrupts are already off)
+            spin_lock(&kb_lock);
             int next_write = (kb_write_ptr + 1) % KB_BUFFER_SIZE;
             if (next_write != kb_read_ptr) { // Buffer not full
                 kb_buffer[kb_write_ptr] = base_char;
                 kb_write_ptr = next_write;
             }
+            spin_unlock(&kb_lock);
+            console_wake_input();
         }
     }
 }
 
 char keyboard_getchar(void) {
+    uint32_t flags = spin_lock_irqsave(&kb_lock);
+
     // Check if buffer is empty
     if (kb_read_ptr == kb_write_ptr) {
+        spin_unlock_irqrestore(&kb_lock, flags);
         return 0;
     }
     
     char c = kb_buffer[kb_read_ptr];
     kb_read_ptr = (kb_read_ptr + 1) % KB_BUFFER_SIZE;
+    spin_unlock_irqrestore(&kb_lock, flags);
     return c;
 }
 
+// Non-zero when the ring holds characters keyboard_getchar() would return
+int keyboard_pending(void) {
+    return kb_read_ptr != kb_write_ptr;
+}
+
 // Check if a key is currently pressed
 int keyboard_is_pressed(int scancode) {
     return inb(KEYBOARD_DATA_PORT) == scancode;
@@ -3,6 +3,7 @@
 #include "../include/idt.h"
 #include "../kernel/log.h"
 #include "../drivers/vga.h"
+#include "../include/coroutine.h"
 
 // PS/2 controller ports (same as keyboard)
 #define PS2_DATA_PORT   0x60
@@ -13,9 +14,17 @@
 #define MOUSE_IRQ_VECTOR 44
 #define MOUSE_IRQ_LINE   12
 
-// Simple 3-byte PS/2 mouse packet state
+// Bytes from IRQ12, consumed by the packet coroutine
+#define MOUSE_RING_SIZE 16
+static volatile uint8_t mouse_ring[MOUSE_RING_SIZE];
+static volatile uint32_t ring_head = 0;   // Written by the IRQ handler
+static volatile uint32_t ring_tail = 0;   // Written by the coroutine
+static co_event_t mouse_event;
+
+// Simple 3-byte PS/2 mouse packet state, assembled by the coroutine
+static coroutine_t mouse_co;
 static uint8_t packet[3];
-static int packet_index = 0;
+static uint8_t mouse_byte;
 
 static int mouse_x = 0;
 static int mouse_y = 0;
@@ -65,7 +74,18 @@ static void clear_cursor(void) {
     vga_print_at(s, mouse_x, mouse_y);
 }
 
-// IRQ12 handler (called via IDT/irq_common_stub)
+// Take the next byte from IRQ12, if any (into mouse_byte)
+static int mouse_next_byte(void) {
+    if (ring_tail == ring_head) {
+        return 0;
+    }
+    mouse_byte = mouse_ring[ring_tail % MOUSE_RING_SIZE];
+    ring_tail++;
+    return 1;
+}
+
+// IRQ12 handler (called via IDT/irq_common_stub): queue the byte and
+// let the coroutine do the rest
 static void mouse_irq_handler(struct regs* r) {
     (void)r;
 
@@ -75,32 +95,53 @@ static void mouse_irq_handler(struct regs* r) {
         return;
     }
 
+    // A full ring loses the byte
     uint8_t data = inb(PS2_DATA_PORT);
-
-    // First byte must always have bit 3 set for a valid packet
-    if (packet_index == 0 && !(data & 0x08)) {
-        return;
+    if (ring_head - ring_tail < MOUSE_RING_SIZE) {
+        mouse_ring[ring_head % MOUSE_RING_SIZE] = data;
+        ring_head++;
     }
+    co_event_signal(&mouse_event);
+}
 
-    packet[packet_index++] = data;
-
-    if (packet_index < 3)
-        return;
-
-    // We have a full 3-byte packet
-    packet_index = 0;
-
-    int dx = (int8_t)packet[1];
-    int dy = (int8_t)packet[2];
-
-    clear_cursor();
-
-    mouse_x += dx;
-    mouse_y -= dy; // PS/2 Y is opposite screen Y
-
-    mouse_buttons = packet[0] & 0x07; // left/mid/right
+// Mouse driver coroutine: enable streaming, then assemble packets.
+// Waits for each byte instead of polling the controller.
+static int mouse_coroutine(coroutine_t* co) {
+    CO_BEGIN(co);
+
+    // Set defaults and enable streaming; the ACKs arrive through IRQ12
+    mouse_write(MOUSE_CMD_SET_DEFAULTS);
+    CO_AWAIT(co, &mouse_event, mouse_next_byte());
+    mouse_write(MOUSE_CMD_ENABLE_PACKET_STREAMING);
+    CO_AWAIT(co, &mouse_event, mouse_next_byte());
+
+    while (1) {
+        // First byte must always have bit 3 set for a valid packet
+        CO_AWAIT(co, &mouse_event, mouse_next_byte());
+        if (!(mouse_byte & 0x08)) {
+            continue;
+        }
+        packet[0] = mouse_byte;
+        CO_AWAIT(co, &mouse_event, mouse_next_byte());
+        packet[1] = mouse_byte;
+        CO_AWAIT(co, &mouse_event, mouse_next_byte());
+        packet[2] = mouse_byte;
+
+        // We have a full 3-byte packet
+        int dx = (int8_t)packet[1];
+        int dy = (int8_t)packet[2];
+
+        clear_cursor();
+
+        mouse_x += dx;
+        mouse_y -= dy; // PS/2 Y is opposite screen Y
+
+        mouse_buttons = packet[0] & 0x07; // left/mid/right
+
+        draw_cursor();
+    }
 
-    draw_cursor();
+    CO_END(co);
 }
 
 void mouse_init(void) {
@@ -120,16 +161,12 @@ void mouse_init(void) {
     outb(PS2_DATA_PORT, status);
 
     // Reset internal state
-    packet_index = 0;
+    ring_head = 0;
+    ring_tail = 0;
     mouse_x = 0;
     mouse_y = 0;
     mouse_buttons = 0;
-
-    // Set defaults and enable streaming
-    mouse_write(0xF6); // Set defaults
-    mouse_read();      // ACK
-    mouse_write(0xF4); // Enable data reporting
-    mouse_read();      // ACK
+    co_event_init(&mouse_event, "mouse");
 
     // Register handler for vector 32+12
     register_interrupt_handler(MOUSE_IRQ_VECTOR, mouse_irq_handler);
@@ -137,6 +174,10 @@ void mouse_init(void) {
     // Unmask IRQ12 on PIC
     enable_irq(MOUSE_IRQ_LINE);
 
+    // Device setup and packet assembly continue asynchronously
+    coroutine_init(&mouse_co, mouse_coroutine, NULL);
+    co_spawn(&mouse_co);
+
     vga_print("Mouse: initialized\n");
     log_info("Mouse driver initialized");
 }
@@ -1,10 +1,15 @@
 #include "serial.h"
 #include "../kernel/log.h"
 #include "../kernel/io.h"
+#include "../include/idt.h"
+#include "../include/spinlock.h"
+#include "../include/console.h"
+#include "../include/poll.h"
 
 // Serial port I/O ports
 #define SERIAL_COM1_BASE    0x3F8
 #define SERIAL_DATA_PORT(base)      (base)
+#define SERIAL_INT_ENABLE_PORT(base) (base + 1)
 #define SERIAL_FIFO_CMD_PORT(base)   (base + 2)
 #define SERIAL_LINE_CMD_PORT(base)  (base + 3)
 #define SERIAL_MODEM_CMD_PORT(base) (base + 4)
@@ -16,10 +21,93 @@
 // Serial port baud rate divisor for 38400 baud
 #define SERIAL_BAUD_DIVISOR        3
 
+// COM1 uses IRQ4 -> interrupt vector 32 + 4 = 36
+#define SERIAL_COM1_IRQ_LINE   4
+#define SERIAL_COM1_IRQ_VECTOR 36
+
+// Interrupt enable register bits
+#define SERIAL_IER_RX_AVAILABLE 0x01
+#define SERIAL_IER_THR_EMPTY    0x02
+
+// Bytes the transmitter accepts per THRE interrupt with the FIFO enabled
+#define SERIAL_TX_FIFO_SIZE 16
+
+// Receive ring filled by the COM1 interrupt handler
+#define SERIAL_RX_BUFFER_SIZE 256
+static char rx_buffer[SERIAL_RX_BUFFER_SIZE];
+static volatile int rx_write_ptr = 0;
+static volatile int rx_read_ptr = 0;
+static spinlock_t rx_lock;
+
+// Transmit ring drained by the THRE interrupt. The THRE interrupt is only
+// enabled while the ring holds data.
+#define SERIAL_TX_BUFFER_SIZE 2048
+static char tx_buffer[SERIAL_TX_BUFFER_SIZE];
+static volatile uint32_t tx_head = 0;   // Next byte to send
+static volatile uint32_t tx_tail = 0;   // Next free slot
+static spinlock_t tx_lock;
+static uint32_t tx_interrupts = 0;
+
+// Refill the transmit FIFO from the ring. Called with tx_lock held.
+static int serial_tx_pump_locked(void) {
+    if (!(inb(SERIAL_LINE_STATUS_PORT(SERIAL_COM1_BASE)) & 0x20)) {
+        return 0;
+    }
+
+    int sent = 0;
+    while (sent < SERIAL_TX_FIFO_SIZE && tx_head != tx_tail) {
+        outb(SERIAL_DATA_PORT(SERIAL_COM1_BASE), tx_buffer[tx_head % SERIAL_TX_BUFFER_SIZE]);
+        tx_head++;
+        sent++;
+    }
+    if (tx_head == tx_tail) {
+        outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE), SERIAL_IER_RX_AVAILABLE);
+    }
+    return sent;
+}
+
+// COM1 interrupt: drain the receive FIFO into the ring and wake readers,
+// then refill the transmit FIFO and wake writers waiting for ring space
+static void serial_rx_handler(struct regs* r) {
+    (void)r;
+    int received = 0;
+
+    spin_lock(&rx_lock);
+    while (serial_is_data_ready(SERIAL_COM1_BASE)) {
+        char c = inb(SERIAL_DATA_PORT(SERIAL_COM1_BASE));
+        int next_write = (rx_write_ptr + 1) % SERIAL_RX_BUFFER_SIZE;
+        if (next_write != rx_read_ptr) { // Drop input when the ring is full
+            rx_buffer[rx_write_ptr] = c;
+            rx_write_ptr = next_write;
+            received = 1;
+        }
+    }
+    spin_unlock(&rx_lock);
+
+    spin_lock(&tx_lock);
+    int sent = serial_tx_pump_locked();
+    if (sent) {
+        tx_interrupts++;
+    }
+    spin_unlock(&tx_lock);
+
+    if (received) {
+        console_wake_input();
+    }
+    if (sent) {
+        console_wake_output();
+    }
+}
+
+// Readiness source for epoll
+static uint32_t serial_poll(void) {
+    return serial_rx_pending() ? POLLIN : 0;
+}
+
 // Initialize serial port for debugging
 int serial_init(void) {
     // Disable interrupts during initialization
-    outb(SERIAL_COM1_BASE + 1, 0x00);
+    outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE), 0x00);
     
     // Enable DLAB (set baud rate divisor)
     outb(SERIAL_LINE_CMD_PORT(SERIAL_COM1_BASE), SERIAL_LINE_ENABLE_DLAB);
@@ -43,6 +131,18 @@ int serial_init(void) {
     // control register, which can cause hangs in QEMU. We are removing
     // the loopback-related writes entirely. The 0x0B write above is sufficient.
     
+    // Receive is interrupt driven so readers can sleep instead of polling LSR
+    spin_lock_init(&rx_lock, "serial_rx");
+    spin_lock_init(&tx_lock, "serial_tx");
+    rx_write_ptr = 0;
+    rx_read_ptr = 0;
+    tx_head = 0;
+    tx_tail = 0;
+    register_interrupt_handler(SERIAL_COM1_IRQ_VECTOR, serial_rx_handler);
+    poll_register_source(POLL_SRC_SERIAL, serial_poll);
+    outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE), SERIAL_IER_RX_AVAILABLE);
+    enable_irq(SERIAL_COM1_IRQ_LINE);
+    
     return 1; // Success
 }
 
@@ -61,6 +161,37 @@ void serial_putchar(uint16_t com, char c) {
     outb(SERIAL_DATA_PORT(com), c);
 }
 
+// Queue up to len bytes for interrupt-driven transmission without
+// waiting. Returns the number of bytes queued; a short count means the
+// ring is full.
+uint32_t serial_tx_enqueue(const char* buf, uint32_t len) {
+    uint32_t flags = spin_lock_irqsave(&tx_lock);
+    uint32_t room = SERIAL_TX_BUFFER_SIZE - (tx_tail - tx_head);
+    uint32_t n = len < room ? len : room;
+    for (uint32_t i = 0; i < n; i++) {
+        tx_buffer[(tx_tail + i) % SERIAL_TX_BUFFER_SIZE] = buf[i];
+    }
+    tx_tail += n;
+
+    // Raising THRE while the transmitter is idle fires the interrupt at
+    // once, so the handler starts the first burst
+    if (n) {
+        outb(SERIAL_INT_ENABLE_PORT(SERIAL_COM1_BASE),
+             SERIAL_IER_RX_AVAILABLE | SERIAL_IER_THR_EMPTY);
+    }
+    spin_unlock_irqrestore(&tx_lock, flags);
+    return n;
+}
+
+// Free space in the transmit ring
+uint32_t serial_tx_room(void) {
+    return SERIAL_TX_BUFFER_SIZE - (tx_tail - tx_head);
+}
+
+uint32_t serial_tx_interrupts(void) {
+    return tx_interrupts;
+}
+
 // Write string to serial port
 void serial_write(uint16_t com, const char* str) {
     for (int i = 0; str[i] != '\0'; i++) {
@@ -76,6 +207,25 @@ int serial_is_data_ready(uint16_t com) {
     return inb(SERIAL_LINE_STATUS_PORT(com)) & 0x01;
 }
 
+// Non-blocking read from the COM1 receive ring; returns 0 when empty
+char serial_rx_getchar(void) {
+    uint32_t flags = spin_lock_irqsave(&rx_lock);
+    if (rx_read_ptr == rx_write_ptr) {
+        spin_unlock_irqrestore(&rx_lock, flags);
+        return 0;
+    }
+
+    char c = rx_buffer[rx_read_ptr];
+    rx_read_ptr = (rx_read_ptr + 1) % SERIAL_RX_BUFFER_SIZE;
+    spin_unlock_irqrestore(&rx_lock, flags);
+    return c;
+}
+
+// Non-zero when the receive ring holds input
+int serial_rx_pending(void) {
+    return rx_read_ptr != rx_write_ptr;
+}
+
 // Read character from serial port
 char serial_getchar(uint16_t com) {
     while (serial_is_data_ready(com) == 0);
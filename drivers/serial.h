@@ -16,6 +16,13 @@ void serial_putchar(uint16_t com, char c);
 void serial_write(uint16_t com, const char* str);
 int serial_is_data_ready(uint16_t com);
 char serial_getchar(uint16_t com);
+char serial_rx_getchar(void);
+int serial_rx_pending(void);
+
+// Interrupt-driven COM1 transmit ring used by the console
+uint32_t serial_tx_enqueue(const char* buf, uint32_t len);
+uint32_t serial_tx_room(void);
+uint32_t serial_tx_interrupts(void);
 
 // Debug functions
 void serial_debug(const char* message);
@@ -1,20 +1,19 @@
 #include "timer.h"
 #include "../include/idt.h"
 #include "../kernel/process.h"
+#include "../include/softirq.h"
+#include "../include/vdso.h"
 
 #define PIT_CMD_PORT 0x43
 #define PIT_CHANNEL0 0x40
-#define PIT_FREQUENCY 100  // 100Hz timer
+#define PIT_FREQUENCY TIMER_HZ
 
 volatile uint32_t timer_ticks = 0;
 
-// Timer interrupt handler
-void timer_interrupt_handler(struct regs* r) {
-    (void)r; // Suppress unused parameter warning
-    timer_ticks++;
-    
-    // Call the scheduler every timer tick
-    schedule();
+// Timer bottom half: runs on IRQ exit with interrupts enabled
+static void timer_softirq(void) {
+    // Round-robin: ask for a reschedule every tick; irq_exit() performs it
+    process_set_need_resched();
     
     // Display timer tick count every 100 ticks (1 second)
     if (timer_ticks % 100 == 0) {
@@ -24,8 +23,18 @@ void timer_interrupt_handler(struct regs* r) {
     }
 }
 
+// Timer interrupt handler (top half)
+void timer_interrupt_handler(struct regs* r) {
+    (void)r; // Suppress unused parameter warning
+    timer_ticks++;
+    vdso_tick(timer_ticks);
+    process_timer_tick(timer_ticks);
+    raise_softirq(SOFTIRQ_TIMER);
+}
+
 void timer_init(void) {
-    // Register the timer handler
+    // Register the timer handler and its bottom half
+    open_softirq(SOFTIRQ_TIMER, timer_softirq);
     register_interrupt_handler(32, timer_interrupt_handler);  // IRQ0 = 32
     
     // Set up PIT (Programmable Interval Timer)
@@ -49,3 +58,8 @@ void timer_wait(uint32_t ticks) {
 uint32_t timer_get_ticks(void) {
     return timer_ticks;
 }
+
+// Rounds up, so a non-zero timeout always lasts at least one tick
+uint32_t timer_ms_to_ticks(uint32_t ms) {
+    return (ms / 1000) * TIMER_HZ + ((ms % 1000) * TIMER_HZ + 999) / 1000;
+}
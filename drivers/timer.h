@@ -5,9 +5,12 @@
 #include "../include/idt.h"
 #include "../kernel/io.h"
 
+#define TIMER_HZ 100  // PIT interrupt rate
+
 void timer_init(void);
 void timer_wait(uint32_t ticks);
 uint32_t timer_get_ticks(void);
+uint32_t timer_ms_to_ticks(uint32_t ms);
 void timer_interrupt_handler(struct regs* r);
 
 #endif
@@ -61,7 +61,8 @@ void vga_set_color(vga_color_t fg, vga_color_t bg) {
     current_color = (uint8_t)((bg << 4) | (fg & 0x0F));
 }
 
-void vga_putchar(char c) {
+// Render one character without touching the hardware cursor
+static void vga_emit(char c) {
     // Ensure cursor is within bounds before processing
     if (cursor_x >= VGA_WIDTH) cursor_x = 0;
     if (cursor_y >= VGA_HEIGHT) cursor_y = VGA_HEIGHT - 1;
@@ -93,14 +94,26 @@ void vga_putchar(char c) {
         vga_scroll();
         cursor_y = VGA_HEIGHT - 1;
     }
+}
 
+void vga_putchar(char c) {
+    vga_emit(c);
     vga_update_cursor();
 }
 
 void vga_print(const char* str) {
     while (*str) {
-        vga_putchar(*str++);
+        vga_emit(*str++);
+    }
+    vga_update_cursor();
+}
+
+// Render a batch with a single cursor update (four port writes) at the end
+void vga_write(const char* buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        vga_emit(buf[i]);
     }
+    vga_update_cursor();
 }
 
 void vga_print_at(const char* str, int x, int y) {
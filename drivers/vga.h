@@ -33,6 +33,7 @@ void vga_set_color(vga_color_t fg, vga_color_t bg);
 void vga_enable_cursor(uint8_t cursor_start, uint8_t cursor_end);
 void vga_putchar(char c);
 void vga_print(const char* str);
+void vga_write(const char* buf, uint32_t len);
 void vga_print_at(const char* str, int x, int y);
 void vga_scroll(void);
 void vga_set_cursor(int x, int y);
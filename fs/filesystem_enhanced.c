@@ -10,8 +10,10 @@ void fs_init(void) {
     // Clear file system
     memset(&fs, 0, sizeof(filesystem_t));
     
-    // Mark first few blocks as used for file system metadata
-    fs.bitmap[0] = 0x0000000F;  // First 4 blocks used
+    // Everything past the metadata blocks starts out as one free run
+    fs.free_extents[0].start = FS_RESERVED_BLOCKS;
+    fs.free_extents[0].count = FS_BLOCKS - FS_RESERVED_BLOCKS;
+    fs.free_extent_count = 1;
     
     // Create root directory
     fs_create("/", FILE_TYPE_DIR);
@@ -32,28 +34,164 @@ void fs_init(void) {
     }
 }
 
-// Allocate a free block
-uint32_t alloc_block(void) {
-    for (uint32_t i = 0; i < FS_SIZE / BLOCK_SIZE / 32; i++) {
-        if (fs.bitmap[i] != 0xFFFFFFFF) {
-            for (uint32_t j = 0; j < 32; j++) {
-                if (!(fs.bitmap[i] & (1 << j))) {
-                    fs.bitmap[i] |= (1 << j);
-                    return i * 32 + j;
-                }
+// Index of the first free run starting after block
+static uint32_t free_extent_search(uint32_t block) {
+    uint32_t lo = 0, hi = fs.free_extent_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (fs.free_extents[mid].start <= block) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void free_extent_remove(uint32_t index) {
+    memmove(&fs.free_extents[index], &fs.free_extents[index + 1],
+            (fs.free_extent_count - index - 1) * sizeof(fs_extent_t));
+    fs.free_extent_count--;
+}
+
+// Take up to count blocks from the front of a free run
+static fs_extent_t free_extent_take(uint32_t index, uint32_t count) {
+    fs_extent_t* run = &fs.free_extents[index];
+    fs_extent_t taken = { run->start, count < run->count ? count : run->count };
+    run->start += taken.count;
+    run->count -= taken.count;
+    if (run->count == 0) {
+        free_extent_remove(index);
+    }
+    return taken;
+}
+
+// Return a run to the free list, merging it with its neighbours
+static void extent_free(uint32_t start, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    uint32_t index = free_extent_search(start);
+    fs_extent_t* prev = index > 0 ? &fs.free_extents[index - 1] : NULL;
+    fs_extent_t* next = index < fs.free_extent_count ? &fs.free_extents[index] : NULL;
+    
+    if (prev && prev->start + prev->count == start) {
+        prev->count += count;
+        if (next && start + count == next->start) {
+            prev->count += next->count;
+            free_extent_remove(index);
+        }
+    } else if (next && start + count == next->start) {
+        next->start = start;
+        next->count += count;
+    } else {
+        memmove(&fs.free_extents[index + 1], &fs.free_extents[index],
+                (fs.free_extent_count - index) * sizeof(fs_extent_t));
+        fs.free_extents[index].start = start;
+        fs.free_extents[index].count = count;
+        fs.free_extent_count++;
+    }
+}
+
+// Best fit: the smallest run that holds count blocks, otherwise the
+// largest there is. Returns a zero-length extent when the disk is full.
+static fs_extent_t extent_alloc(uint32_t count) {
+    fs_extent_t none = { 0, 0 };
+    if (fs.free_extent_count == 0) {
+        return none;
+    }
+    
+    uint32_t best = 0, largest = 0;
+    int fits = 0;
+    for (uint32_t i = 0; i < fs.free_extent_count; i++) {
+        uint32_t size = fs.free_extents[i].count;
+        if (size >= count && (!fits || size < fs.free_extents[best].count)) {
+            best = i;
+            fits = 1;
+            if (size == count) {
+                break;
             }
         }
+        if (size > fs.free_extents[largest].count) {
+            largest = i;
+        }
     }
-    return 0;  // No free blocks
+    return free_extent_take(fits ? best : largest, count);
+}
+
+// Allocate a free block
+uint32_t alloc_block(void) {
+    fs_extent_t extent = extent_alloc(1);
+    return extent.count ? extent.start : 0;  // 0: no free blocks
 }
 
 // Free a block
 void free_block(uint32_t block) {
-    uint32_t bitmap_index = block / 32;
-    uint32_t bit_index = block % 32;
-    
-    if (bitmap_index < FS_SIZE / BLOCK_SIZE / 32) {
-        fs.bitmap[bitmap_index] &= ~(1 << bit_index);
+    if (block >= FS_RESERVED_BLOCKS && block < FS_BLOCKS) {
+        extent_free(block, 1);
+    }
+}
+
+static uint32_t file_blocks(const file_entry_t* file) {
+    uint32_t blocks = 0;
+    for (uint32_t i = 0; i < file->extent_count; i++) {
+        blocks += file->extents[i].count;
+    }
+    return blocks;
+}
+
+// Add count blocks to the end of a file, growing its last run in place
+// when the blocks after it are free. Blocks gained before a failure stay
+// with the file and are released by fs_delete().
+static int file_grow(file_entry_t* file, uint32_t count) {
+    while (count > 0) {
+        fs_extent_t* last = file->extent_count ? &file->extents[file->extent_count - 1] : NULL;
+        if (last) {
+            uint32_t end = last->start + last->count;
+            uint32_t index = free_extent_search(end);
+            if (index > 0 && fs.free_extents[index - 1].start == end) {
+                fs_extent_t taken = free_extent_take(index - 1, count);
+                last->count += taken.count;
+                count -= taken.count;
+                continue;
+            }
+        }
+        
+        if (file->extent_count == FS_MAX_EXTENTS) {
+            return -1;  // Too fragmented
+        }
+        fs_extent_t extent = extent_alloc(count);
+        if (extent.count == 0) {
+            return -1;  // Out of space
+        }
+        file->extents[file->extent_count++] = extent;
+        count -= extent.count;
+    }
+    return 0;
+}
+
+// Copy between a buffer and the file starting at offset, one memcpy per run
+static void file_copy(file_entry_t* file, uint32_t offset, void* buffer, uint32_t count, int write) {
+    uint8_t* buf = (uint8_t*)buffer;
+    for (uint32_t i = 0; i < file->extent_count && count > 0; i++) {
+        uint32_t run_bytes = file->extents[i].count * BLOCK_SIZE;
+        if (offset >= run_bytes) {
+            offset -= run_bytes;
+            continue;
+        }
+        uint32_t chunk = run_bytes - offset;
+        if (chunk > count) {
+            chunk = count;
+        }
+        uint8_t* data = &fs.data[file->extents[i].start * BLOCK_SIZE + offset];
+        if (write) {
+            memcpy(data, buf, chunk);
+        } else {
+            memcpy(buf, data, chunk);
+        }
+        buf += chunk;
+        count -= chunk;
+        offset = 0;
     }
 }
 
@@ -88,12 +226,7 @@ int fs_create(const char* filename, uint8_t type) {
     file->flags = 0;
     file->creation_time = 0;  // Simple - no real time
     file->modify_time = 0;
-    
-    // Allocate first block
-    file->start_block = alloc_block();
-    if (file->start_block == 0) {
-        return -1;  // Out of space
-    }
+    file->extent_count = 0;  // Blocks are allocated on first write
     
     fs.file_count++;
     return fs.file_count - 1;  // Return file index
@@ -107,9 +240,8 @@ int fs_delete(const char* filename) {
     }
     
     // Free all blocks used by file
-    uint32_t blocks = (file->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    for (uint32_t i = 0; i < blocks; i++) {
-        free_block(file->start_block + i);
+    for (uint32_t i = 0; i < file->extent_count; i++) {
+        extent_free(file->extents[i].start, file->extents[i].count);
     }
     
     // Remove file entry (shift remaining files)
@@ -123,10 +255,10 @@ int fs_delete(const char* filename) {
 }
 
 // Open a file
-int fs_open(const char* filename, uint32_t mode) {
+int fs_open(const char* filename, int flags) {
     file_entry_t* file = find_file(filename);
     if (!file) {
-        if (mode & FILE_CREATE) {
+        if (flags & FILE_CREATE) {
             int fd = fs_create(filename, FILE_TYPE_REGULAR);
             if (fd < 0) return -1;
             file = &fs.files[fd];
@@ -162,8 +294,7 @@ int fs_read(int fd, void* buffer, uint32_t count) {
     }
     
     // Copy data from file system
-    uint8_t* file_data = &fs.data[file->start_block * BLOCK_SIZE];
-    memcpy(buffer, file_data, bytes_to_read);
+    file_copy(file, 0, buffer, bytes_to_read, 0);
     
     return bytes_to_read;
 }
@@ -178,21 +309,15 @@ int fs_write(int fd, const void* buffer, uint32_t count) {
     
     // Check if we need more blocks
     uint32_t needed_blocks = (file->size + count + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    uint32_t current_blocks = (file->size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    
-    if (needed_blocks > current_blocks) {
-        // Allocate more blocks (simplified - just allocate sequentially)
-        for (uint32_t i = current_blocks; i < needed_blocks; i++) {
-            uint32_t new_block = alloc_block();
-            if (new_block == 0) {
-                return -1;  // Out of space
-            }
-        }
+    uint32_t current_blocks = file_blocks(file);
+    
+    if (needed_blocks > current_blocks &&
+        file_grow(file, needed_blocks - current_blocks) != 0) {
+        return -1;  // Out of space
     }
     
     // Copy data to file system
-    uint8_t* file_data = &fs.data[file->start_block * BLOCK_SIZE];
-    memcpy(file_data + file->size, buffer, count);
+    file_copy(file, file->size, (void*)buffer, count, 1);
     
     file->size += count;
     file->modify_time = 0;
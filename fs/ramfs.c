@@ -4,28 +4,49 @@
 #include "../drivers/vga.h"
 #include "../kernel/log.h"
 
-// Simple RAM-based filesystem
+// Simple RAM-based filesystem. File data lives in pages allocated as
+// they are first written: a few direct page pointers, then one indirect
+// page of pointers. Holes read as zeros and take no memory.
 
-#define MAX_FILES 64
-#define MAX_FILE_SIZE 4096
+#define RAMFS_MAX_FILES 256
 #define RAMFS_MAGIC 0x52414D46  // "RAMF"
 
+#define RAMFS_DIRECT_PAGES 4
+#define RAMFS_INDIRECT_PAGES (PAGE_SIZE / sizeof(uint32_t))
+#define RAMFS_MAX_PAGES (RAMFS_DIRECT_PAGES + RAMFS_INDIRECT_PAGES)
+
+// Filename index buckets (power of two). Chains stay short as long as
+// the file count is within a small multiple of this.
+#define RAMFS_HASH_SIZE 128
+
+// Slot links hold index + 1, so 0 ends a chain
+#define RAMFS_NO_SLOT 0
+
 // Ramfs file structure
 typedef struct {
     char name[MAX_FILENAME_LEN];
     uint32_t size;
-    uint32_t data;
+    uint32_t pages[RAMFS_DIRECT_PAGES];  // First data pages, 0 for a hole
+    uint32_t* indirect;                  // Pointers to the following pages
     uint8_t in_use;
+    uint8_t unlinked;  // Deleted while open: freed by the last close
+    uint16_t opens;    // Open files referring to the slot
     uint32_t mode;  // File permissions
+    uint32_t hash;  // Hash of name
+    uint16_t next;  // Next slot in the hash chain, or in the free list
 } ramfs_file_t;
 
 // Ramfs filesystem data
 typedef struct {
     uint32_t magic;
-    ramfs_file_t files[MAX_FILES];
-    uint8_t* file_data;
+    ramfs_file_t files[RAMFS_MAX_FILES];
+    uint16_t buckets[RAMFS_HASH_SIZE];  // First slot of each hash chain
+    uint16_t free_head;                 // First unused slot
+    ramfs_stats_t stats;
 } ramfs_t;
 
+// Static: the file table alone is larger than the kernel heap
+static ramfs_t ramfs_storage;
 static ramfs_t* ramfs = NULL;
 
 // Initialize RAM filesystem
@@ -35,30 +56,24 @@ int ramfs_init(void) {
         return 0;
     }
 
-    // Allocate memory for filesystem structure
-    ramfs = kmalloc(sizeof(ramfs_t));
-    if (!ramfs) {
-        log_error("Failed to allocate RAMFS structure");
-        return -1;
-    }
-    
-    // Allocate memory for file data
-    ramfs->file_data = kmalloc(MAX_FILES * MAX_FILE_SIZE);
-    if (!ramfs->file_data) {
-        kfree(ramfs);
-        log_error("Failed to allocate RAMFS data");
-        return -1;
-    }
-    
     // Initialize filesystem
+    ramfs = &ramfs_storage;
+    memset(ramfs, 0, sizeof(ramfs_t));
     ramfs->magic = RAMFS_MAGIC;
     
-    for (int i = 0; i < MAX_FILES; i++) {
+    for (int i = 0; i < RAMFS_HASH_SIZE; i++) {
+        ramfs->buckets[i] = RAMFS_NO_SLOT;
+    }
+    
+    // Free list in slot order to start with; freed slots are reused first
+    ramfs->free_head = RAMFS_NO_SLOT;
+    for (int i = RAMFS_MAX_FILES - 1; i >= 0; i--) {
         ramfs->files[i].in_use = 0;
         ramfs->files[i].size = 0;
-        ramfs->files[i].data = 0;
         ramfs->files[i].name[0] = '\0';
         ramfs->files[i].mode = 0644;  // Default permissions
+        ramfs->files[i].next = ramfs->free_head;
+        ramfs->free_head = (uint16_t)(i + 1);
     }
     
     // Create some default files
@@ -70,76 +85,220 @@ int ramfs_init(void) {
     return 0;
 }
 
-// Find file by name
+// FNV-1a over the stored (possibly truncated) name
+static uint32_t ramfs_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; name[i] && i < MAX_FILENAME_LEN - 1; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static ramfs_file_t* ramfs_slot(uint16_t link) {
+    return (link == RAMFS_NO_SLOT) ? NULL : &ramfs->files[link - 1];
+}
+
+static uint16_t ramfs_link(ramfs_file_t* file) {
+    return (uint16_t)(file - ramfs->files + 1);
+}
+
+// Find file by name; the full compare only runs on a hash match
+static ramfs_file_t* ramfs_find_hashed(const char* name, uint32_t hash) {
+    ramfs_file_t* file = ramfs_slot(ramfs->buckets[hash & (RAMFS_HASH_SIZE - 1)]);
+    while (file) {
+        if (file->hash == hash &&
+            strncmp(file->name, name, MAX_FILENAME_LEN - 1) == 0) {
+            return file;
+        }
+        file = ramfs_slot(file->next);
+    }
+    return NULL;
+}
+
 static ramfs_file_t* ramfs_find_file(const char* name) {
     if (!ramfs || !name) return NULL;
+    return ramfs_find_hashed(name, ramfs_hash(name));
+}
+
+// Take a slot off the free list and index it under hash
+static ramfs_file_t* ramfs_alloc_slot(uint32_t hash) {
+    ramfs_file_t* file = ramfs_slot(ramfs->free_head);
+    if (!file) {
+        return NULL;
+    }
+    ramfs->free_head = file->next;
     
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (ramfs->files[i].in_use && 
-            strcmp(ramfs->files[i].name, name) == 0) {
-            return &ramfs->files[i];
+    uint16_t* bucket = &ramfs->buckets[hash & (RAMFS_HASH_SIZE - 1)];
+    file->hash = hash;
+    file->next = *bucket;
+    *bucket = ramfs_link(file);
+    return file;
+}
+
+// Slot holding the frame of page index, or NULL past the indirect page.
+// The indirect page is allocated when create is set.
+static uint32_t* ramfs_page_slot(ramfs_file_t* file, uint32_t index, int create) {
+    if (index < RAMFS_DIRECT_PAGES) {
+        return &file->pages[index];
+    }
+    index -= RAMFS_DIRECT_PAGES;
+    if (index >= RAMFS_INDIRECT_PAGES) {
+        return NULL;
+    }
+    if (!file->indirect) {
+        if (!create) {
+            return NULL;
+        }
+        uint32_t frame = alloc_page();
+        if (!frame) {
+            return NULL;
         }
+        // Frames are reachable through the kernel's identity map
+        file->indirect = (uint32_t*)frame;
+        memset(file->indirect, 0, PAGE_SIZE);
+        ramfs->stats.index_pages++;
     }
-    
-    return NULL;
+    return &file->indirect[index];
 }
 
-// Find free file slot
-static ramfs_file_t* ramfs_find_free_slot(void) {
-    if (!ramfs) return NULL;
-    
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (!ramfs->files[i].in_use) {
-            return &ramfs->files[i];
+// Data page index of file, or NULL for a hole. With create set a hole
+// gets a zeroed page; NULL then means out of memory.
+static uint8_t* ramfs_page(ramfs_file_t* file, uint32_t index, int create) {
+    uint32_t* slot = ramfs_page_slot(file, index, create);
+    if (!slot) {
+        return NULL;
+    }
+    if (!*slot && create) {
+        uint32_t frame = alloc_page();
+        if (!frame) {
+            return NULL;
         }
+        memset((void*)frame, 0, PAGE_SIZE);
+        *slot = frame;
+        ramfs->stats.data_pages++;
+    }
+    return (uint8_t*)*slot;
+}
+
+// Free every data page from index first on, and the indirect page once
+// it maps nothing
+static void ramfs_free_pages(ramfs_file_t* file, uint32_t first) {
+    for (uint32_t i = first; i < RAMFS_DIRECT_PAGES; i++) {
+        if (file->pages[i]) {
+            free_page(file->pages[i]);
+            file->pages[i] = 0;
+            ramfs->stats.data_pages--;
+        }
+    }
+    if (!file->indirect) {
+        return;
+    }
+    uint32_t start = (first > RAMFS_DIRECT_PAGES) ? first - RAMFS_DIRECT_PAGES : 0;
+    for (uint32_t i = start; i < RAMFS_INDIRECT_PAGES; i++) {
+        if (file->indirect[i]) {
+            free_page(file->indirect[i]);
+            file->indirect[i] = 0;
+            ramfs->stats.data_pages--;
+        }
+    }
+    if (start == 0) {
+        free_page((uint32_t)file->indirect);
+        file->indirect = NULL;
+        ramfs->stats.index_pages--;
     }
-    
-    return NULL;
 }
 
+static ramfs_file_t* ramfs_inode(uint32_t inode) {
+    if (!ramfs || inode == 0 || inode > RAMFS_MAX_FILES) return NULL;
+    ramfs_file_t* file = &ramfs->files[inode - 1];
+    return file->in_use ? file : NULL;
+}
+
+static int ramfs_write_file(ramfs_file_t* file, const void* buffer, uint32_t count, uint32_t offset);
+
 // Create a file
 int ramfs_create_file(const char* name, const void* data, uint32_t size) {
     if (!ramfs || !name) return -1;
-    
-    if (size > MAX_FILE_SIZE) {
-        log_error("File size exceeds maximum: %d", size);
-        return -1;
-    }
 
     // Check if file already exists
-    if (ramfs_find_file(name)) {
+    uint32_t hash = ramfs_hash(name);
+    if (ramfs_find_hashed(name, hash)) {
         log_error("File already exists: %s", name);
         return -1;
     }
     
-    // Find free slot
-    ramfs_file_t* file = ramfs_find_free_slot();
+    // Take a free slot
+    ramfs_file_t* file = ramfs_alloc_slot(hash);
     if (!file) {
         log_error("No free file slots");
         return -1;
     }
     
-    // Calculate data offset based on the file pointer position in the array
-    uint32_t file_index = (uint32_t)(file - ramfs->files);
-    uint32_t data_offset = file_index * MAX_FILE_SIZE;
-    
-    // Initialize file
+    // Initialize file; a fresh slot maps no pages
     strncpy(file->name, name, MAX_FILENAME_LEN - 1);
     file->name[MAX_FILENAME_LEN - 1] = '\0';
-    file->size = size;
-    file->data = data_offset;
+    file->size = 0;
     file->in_use = 1;
+    file->unlinked = 0;
+    file->opens = 0;
     file->mode = 0644;
+    ramfs->stats.files++;
     
     // Copy data if provided
-    if (data && size > 0) {
-        memcpy(ramfs->file_data + data_offset, data, size);
+    if (data && size > 0 && ramfs_write_file(file, data, size, 0) != (int)size) {
+        log_error("Out of memory creating %s", name);
+        ramfs_delete(name);
+        return -1;
     }
     
     log_info("File created: %s (%d bytes)", name, size);
     return 0;
 }
 
+// Free the pages of a file that has no name left and put its slot back
+// on the free list
+static void ramfs_release(ramfs_file_t* file) {
+    ramfs_free_pages(file, 0);
+    file->in_use = 0;
+    file->unlinked = 0;
+    file->size = 0;
+    ramfs->stats.files--;
+    file->name[0] = '\0';
+    file->next = ramfs->free_head;
+    ramfs->free_head = ramfs_link(file);
+}
+
+// Delete a file. The name goes at once; an open file keeps its data and
+// slot until it is last closed, so its inode is never reused under it.
+int ramfs_delete(const char* name) {
+    if (!ramfs || !name) return -1;
+    
+    uint32_t hash = ramfs_hash(name);
+    uint16_t* link = &ramfs->buckets[hash & (RAMFS_HASH_SIZE - 1)];
+    ramfs_file_t* file;
+    while ((file = ramfs_slot(*link)) != NULL) {
+        if (file->hash == hash &&
+            strncmp(file->name, name, MAX_FILENAME_LEN - 1) == 0) {
+            break;
+        }
+        link = &file->next;
+    }
+    if (!file) {
+        log_error("File not found: %s", name);
+        return -1;
+    }
+    
+    *link = file->next;
+    if (file->opens) {
+        file->unlinked = 1;
+    } else {
+        ramfs_release(file);
+    }
+    
+    log_info("File deleted: %s", name);
+    return 0;
+}
+
 // Open file (returns inode number)
 int ramfs_open(const char* path, int flags) {
     if (!ramfs || !path) return -1;
@@ -160,25 +319,29 @@ int ramfs_open(const char* path, int flags) {
         }
     }
     
-    // Return inode number (file index + 1)
+    // Return inode number (file index + 1); ramfs_close() drops the open
+    file->opens++;
     return (file - ramfs->files) + 1;
 }
 
 // Close file
 int ramfs_close(uint32_t inode) {
-    if (!ramfs || inode == 0 || inode > MAX_FILES) return -1;
+    ramfs_file_t* file = ramfs_inode(inode);
+    if (!file || file->opens == 0) return -1;
     
-    // Nothing to do for RAMFS - files are always in memory
+    if (--file->opens == 0 && file->unlinked) {
+        ramfs_release(file);
+    }
     log_debug("File closed (inode=%d)", inode);
     return 0;
 }
 
 // Read from file
 int ramfs_read(uint32_t inode, void* buffer, uint32_t count, uint32_t offset) {
-    if (!ramfs || !buffer || inode == 0 || inode > MAX_FILES) return -1;
+    if (!buffer) return -1;
     
-    ramfs_file_t* file = &ramfs->files[inode - 1];
-    if (!file->in_use) {
+    ramfs_file_t* file = ramfs_inode(inode);
+    if (!file) {
         log_error("Invalid inode: %d", inode);
         return -1;
     }
@@ -189,48 +352,108 @@ int ramfs_read(uint32_t inode, void* buffer, uint32_t count, uint32_t offset) {
     }
     
     uint32_t bytes_to_read = count;
-    if (offset + bytes_to_read > file->size) {
+    if (bytes_to_read > file->size - offset) {
         bytes_to_read = file->size - offset;
     }
     
-    // Copy data
-    memcpy(buffer, ramfs->file_data + file->data + offset, bytes_to_read);
+    // Copy page by page; holes read as zeros
+    uint8_t* dst = (uint8_t*)buffer;
+    uint32_t done = 0;
+    while (done < bytes_to_read) {
+        uint32_t pos = offset + done;
+        uint32_t in_page = pos % PAGE_SIZE;
+        uint32_t n = PAGE_SIZE - in_page;
+        if (n > bytes_to_read - done) {
+            n = bytes_to_read - done;
+        }
+        uint8_t* page = ramfs_page(file, pos / PAGE_SIZE, 0);
+        if (page) {
+            memcpy(dst + done, page + in_page, n);
+        } else {
+            memset(dst + done, 0, n);
+        }
+        done += n;
+    }
     
     log_debug("Read %d bytes from inode %d", bytes_to_read, inode);
     return bytes_to_read;
 }
 
+// Copy into the file, allocating the pages written. Stops early when
+// memory or the page index runs out.
+static int ramfs_write_file(ramfs_file_t* file, const void* buffer, uint32_t count, uint32_t offset) {
+    const uint8_t* src = (const uint8_t*)buffer;
+    uint32_t done = 0;
+    while (done < count) {
+        uint32_t pos = offset + done;
+        if (pos < offset) {
+            break;  // Wrapped past 4GB
+        }
+        uint32_t in_page = pos % PAGE_SIZE;
+        uint32_t n = PAGE_SIZE - in_page;
+        if (n > count - done) {
+            n = count - done;
+        }
+        uint8_t* page = ramfs_page(file, pos / PAGE_SIZE, 1);
+        if (!page) {
+            break;
+        }
+        memcpy(page + in_page, src + done, n);
+        done += n;
+    }
+    
+    // Update file size if necessary
+    if (done && offset + done > file->size) {
+        file->size = offset + done;
+    }
+    return done ? (int)done : (count ? -1 : 0);
+}
+
 // Write to file
 int ramfs_write(uint32_t inode, const void* buffer, uint32_t count, uint32_t offset) {
-    if (!ramfs || !buffer || inode == 0 || inode > MAX_FILES) return -1;
+    if (!buffer) return -1;
     
-    ramfs_file_t* file = &ramfs->files[inode - 1];
-    if (!file->in_use) {
+    ramfs_file_t* file = ramfs_inode(inode);
+    if (!file) {
         log_error("Invalid inode: %d", inode);
         return -1;
     }
     
-    // Check bounds
-    if (offset >= MAX_FILE_SIZE) {
-        log_error("File offset too large");
+    int written = ramfs_write_file(file, buffer, count, offset);
+    if (written < 0) {
+        log_error("No room to write inode %d at %d", inode, offset);
         return -1;
     }
     
-    uint32_t bytes_to_write = count;
-    if (offset + bytes_to_write > MAX_FILE_SIZE) {
-        bytes_to_write = MAX_FILE_SIZE - offset;
+    log_debug("Wrote %d bytes to inode %d", written, inode);
+    return written;
+}
+
+// Set the file size. Growing leaves a hole; shrinking frees the pages
+// past the end and clears the rest of the last one.
+int ramfs_truncate(uint32_t inode, uint32_t size) {
+    ramfs_file_t* file = ramfs_inode(inode);
+    if (!file) {
+        return -1;
     }
-    
-    // Copy data
-    memcpy(ramfs->file_data + file->data + offset, buffer, bytes_to_write);
-    
-    // Update file size if necessary
-    if (offset + bytes_to_write > file->size) {
-        file->size = offset + bytes_to_write;
+    if (size < file->size) {
+        uint32_t keep = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+        ramfs_free_pages(file, keep);
+        uint8_t* last = (size % PAGE_SIZE) ? ramfs_page(file, size / PAGE_SIZE, 0) : NULL;
+        if (last) {
+            memset(last + size % PAGE_SIZE, 0, PAGE_SIZE - size % PAGE_SIZE);
+        }
+    } else if (size > RAMFS_MAX_PAGES * PAGE_SIZE) {
+        return -1;
+    }
+    file->size = size;
+    return 0;
+}
+
+void ramfs_get_stats(ramfs_stats_t* stats) {
+    if (stats && ramfs) {
+        memcpy(stats, &ramfs->stats, sizeof(ramfs_stats_t));
     }
-    
-    log_debug("Wrote %d bytes to inode %d", bytes_to_write, inode);
-    return bytes_to_write;
 }
 
 // Get file status
@@ -0,0 +1,35 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+// Console input: merges the keyboard and COM1 receive rings
+void console_init(void);
+char console_getchar(void);      // Sleeps until a character arrives
+char console_trygetchar(void);   // Returns 0 when no input is pending
+
+// Called by input drivers from IRQ context when new data arrives
+void console_wake_input(void);
+
+// Console output: VGA through a line buffer, COM1 through the serial
+// transmit ring. Writers sleep while the ring is full; writers that
+// cannot sleep drop the serial copy and count it.
+#define CONSOLE_OUT_SIZE 1024
+
+typedef struct {
+    uint32_t bytes_written;      // Accepted by console_write()
+    uint32_t vga_flushes;        // Batches rendered, one cursor update each
+    uint32_t buffered;           // Partial line waiting for its newline
+    uint32_t serial_stalls;      // Writers that slept on a full transmit ring
+    uint32_t serial_dropped;     // Bytes lost by writers that could not sleep
+    uint32_t serial_interrupts;  // THRE interrupts that refilled the FIFO
+} console_stats_t;
+
+int console_write(const char* buf, uint32_t len);
+void console_flush(void);        // Render any buffered partial line
+void console_get_stats(console_stats_t* stats);
+
+// Called by the serial driver from IRQ context when transmit space frees up
+void console_wake_output(void);
+
+#endif // CONSOLE_H
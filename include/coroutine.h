@@ -0,0 +1,98 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdint.h>
+#include "spinlock.h"
+
+// Stackless kernel coroutines. A coroutine is a function that runs a
+// state machine step by step: at every suspension point it records where
+// to resume and returns to the executor, so it needs no stack of its own
+// and costs only a coroutine_t. Local variables do NOT survive a
+// suspension; keep state in the structure pointed to by co->data.
+//
+//   static int my_co(coroutine_t* co) {
+//       CO_BEGIN(co);
+//       while (1) {
+//           CO_AWAIT(co, &dev_event, dev_has_data());
+//           ...
+//       }
+//       CO_END(co);
+//   }
+//
+// All coroutines run on the single "kasync" executor thread. They must
+// not sleep (no mutex_lock or wait_event); wait with CO_AWAIT instead.
+
+// Values returned by a coroutine step
+#define CO_WAIT   0  // Suspended on an event
+#define CO_YIELD  1  // Runnable again, after the others
+#define CO_DONE   2  // Finished
+
+// Coroutine states
+#define CO_STATE_IDLE    0
+#define CO_STATE_READY   1
+#define CO_STATE_WAITING 2
+#define CO_STATE_DONE    3
+
+typedef struct coroutine {
+    int (*fn)(struct coroutine* co);
+    void* data;
+    uint16_t resume_point;        // __LINE__ of the last suspension, 0 = start
+    volatile uint8_t state;
+    struct coroutine* next;       // Run queue or event waiter link
+} coroutine_t;
+
+// Something coroutines can wait for; signal it from any context
+typedef struct co_event {
+    spinlock_t lock;
+    coroutine_t* waiters;
+} co_event_t;
+
+#define CO_BEGIN(co) switch ((co)->resume_point) { case 0:
+
+#define CO_END(co) } (co)->resume_point = 0; return CO_DONE
+
+// Let the other coroutines run, then continue here
+#define CO_YIELD_NOW(co) \
+    do { \
+        (co)->resume_point = __LINE__; \
+        return CO_YIELD; \
+        case __LINE__:; \
+    } while (0)
+
+// Suspend until cond holds. cond is re-evaluated every time ev is
+// signalled; the check and the queueing are atomic against the signal.
+#define CO_AWAIT(co, ev, cond) \
+    do { \
+        (co)->resume_point = __LINE__; \
+        __attribute__((fallthrough)); \
+        case __LINE__: { \
+            uint32_t _co_flags = spin_lock_irqsave(&(ev)->lock); \
+            if (!(cond)) { \
+                co_wait_locked((co), (ev)); \
+                spin_unlock_irqrestore(&(ev)->lock, _co_flags); \
+                return CO_WAIT; \
+            } \
+            spin_unlock_irqrestore(&(ev)->lock, _co_flags); \
+        } \
+    } while (0)
+
+void co_executor_init(void);
+
+void coroutine_init(coroutine_t* co, int (*fn)(coroutine_t*), void* data);
+
+// Hand a coroutine to the executor. Safe from interrupt handlers.
+void co_spawn(coroutine_t* co);
+
+void co_event_init(co_event_t* ev, const char* name);
+
+// Make every coroutine waiting on ev runnable. Safe from interrupt handlers.
+void co_event_signal(co_event_t* ev);
+
+// Used by CO_AWAIT with ev->lock held
+void co_wait_locked(coroutine_t* co, co_event_t* ev);
+
+// Statistics
+uint32_t co_get_resumes(void);
+uint32_t co_get_live(void);
+
+#endif // COROUTINE_H
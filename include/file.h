@@ -0,0 +1,74 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include <stdint.h>
+
+// Open files and per-process descriptor tables. Every process owns a
+// table of MAX_FDS slots (shared by its threads) pointing at reference
+// counted open files; the console sits on descriptors 0, 1 and 2.
+
+#define MAX_FDS        16    // Descriptors per process
+#define MAX_OPEN_FILES 64    // Open files system-wide
+#define IOV_MAX        16    // Buffers per readv/writev call
+
+struct file;
+struct proc_shared;
+struct device;
+
+// Backend operations; offset is ignored by non-seekable backends. poll
+// returns the POLL* readiness bits; backends without one never block.
+typedef struct file_ops {
+    int (*read)(struct file* f, void* buffer, uint32_t count, uint32_t offset);
+    int (*write)(struct file* f, const void* buffer, uint32_t count, uint32_t offset);
+    void (*release)(struct file* f);
+    uint32_t (*poll)(struct file* f);
+} file_ops_t;
+
+typedef struct file {
+    const file_ops_t* ops;       // NULL: slot free
+    uint32_t refcount;           // Descriptors and in-flight calls
+    uint32_t flags;              // O_* open flags
+    uint32_t offset;             // Position shared by read/write
+    uint8_t seekable;
+    uint32_t inode;              // ramfs backend
+    struct device* dev;          // Device backend
+    void* private_data;          // Other backends' own state
+} file_t;
+
+typedef struct {
+    void* iov_base;
+    uint32_t iov_len;
+} iovec_t;
+
+void file_init(void);
+
+// New open file with one reference, for backends outside file.c
+file_t* file_alloc(const file_ops_t* ops, uint32_t flags);
+
+// Descriptor tables
+void fd_table_init(struct proc_shared* owner);
+void fd_table_release(struct proc_shared* owner);
+int fd_install(struct proc_shared* owner, file_t* file);
+int fd_close(struct proc_shared* owner, int fd);
+
+// Returns the file with a reference held; drop it with file_put()
+file_t* fd_get(struct proc_shared* owner, int fd);
+void file_put(file_t* file);
+
+// "/dev/<name>" opens a device, anything else a ramfs file
+file_t* file_open(const char* path, uint32_t flags);
+int file_unlink(const char* path);
+
+// Sequential I/O at the file position, and positional I/O that leaves
+// the position alone. Return bytes transferred or -1.
+int file_read(file_t* file, void* buffer, uint32_t count);
+int file_write(file_t* file, const void* buffer, uint32_t count);
+int file_pread(file_t* file, void* buffer, uint32_t count, uint32_t offset);
+int file_pwrite(file_t* file, const void* buffer, uint32_t count, uint32_t offset);
+int file_readv(file_t* file, const iovec_t* iov, uint32_t iovcnt);
+int file_writev(file_t* file, const iovec_t* iov, uint32_t iovcnt);
+int file_seek(file_t* file, uint32_t position);
+int file_truncate(file_t* file, uint32_t size);
+uint32_t file_poll(file_t* file);
+
+#endif // FILE_H
@@ -26,13 +26,23 @@ typedef struct {
     uint32_t atime;
 } vfs_stat_t;
 
+// RAMFS memory use
+typedef struct {
+    uint32_t files;
+    uint32_t data_pages;         // Pages holding file data
+    uint32_t index_pages;        // Indirect page-pointer pages
+} ramfs_stats_t;
+
 // RAMFS function declarations
 int ramfs_init(void);
 int ramfs_create_file(const char* name, const void* data, uint32_t size);
+int ramfs_delete(const char* name);
 int ramfs_open(const char* path, int flags);
 int ramfs_close(uint32_t inode);
 int ramfs_read(uint32_t inode, void* buffer, uint32_t count, uint32_t offset);
 int ramfs_write(uint32_t inode, const void* buffer, uint32_t count, uint32_t offset);
+int ramfs_truncate(uint32_t inode, uint32_t size);
+void ramfs_get_stats(ramfs_stats_t* stats);
 int ramfs_stat(const char* path, vfs_stat_t* stat);
 int ramfs_mount(void);
 
@@ -41,6 +51,9 @@ int ramfs_mount(void);
 #define MAX_FILES 64
 #define BLOCK_SIZE 512
 #define FS_SIZE (1024 * 1024)  // 1MB file system
+#define FS_BLOCKS (FS_SIZE / BLOCK_SIZE)
+#define FS_RESERVED_BLOCKS 4     // File system metadata
+#define FS_MAX_EXTENTS 8         // Contiguous runs per file
 
 // File modes
 #define FILE_READ    0x01
@@ -52,11 +65,18 @@ int ramfs_mount(void);
 #define FILE_TYPE_REGULAR  1
 #define FILE_TYPE_DIR      2
 
+// A run of contiguous blocks
+typedef struct {
+    uint32_t start;
+    uint32_t count;
+} fs_extent_t;
+
 // File descriptor structure
 typedef struct {
     char filename[MAX_FILENAME_LEN];
     uint32_t size;
-    uint32_t start_block;
+    fs_extent_t extents[FS_MAX_EXTENTS];  // In file order
+    uint32_t extent_count;
     uint8_t type;
     uint8_t flags;
     uint32_t creation_time;
@@ -73,10 +93,12 @@ typedef struct {
 // File system structure
 typedef struct {
     uint8_t data[FS_SIZE];
-    uint32_t bitmap[FS_SIZE / BLOCK_SIZE / 32];  // Block allocation bitmap
+    // Free space as coalesced runs sorted by start block. Runs never
+    // touch, so there can be at most one per two blocks.
+    fs_extent_t free_extents[FS_BLOCKS / 2 + 1];
+    uint32_t free_extent_count;
     file_entry_t files[MAX_FILES];
     uint32_t file_count;
-    uint32_t next_block;
 } filesystem_t;
 
 // File system functions
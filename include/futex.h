@@ -0,0 +1,30 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <stdint.h>
+
+// Futex operations (SYS_FUTEX)
+#define FUTEX_WAIT 0  // Sleep if *uaddr still equals val
+#define FUTEX_WAKE 1  // Wake up to val sleepers on uaddr
+
+// Number of hashed wait-queue buckets (power of two)
+#define FUTEX_HASH_SIZE 32
+
+typedef struct {
+    uint32_t waits;               // FUTEX_WAIT calls that went to sleep
+    uint32_t wait_mismatch;       // FUTEX_WAIT calls that found *uaddr changed
+    uint32_t wakes;               // FUTEX_WAKE calls
+    uint32_t woken;               // Sleepers woken
+} futex_stats_t;
+
+void futex_init(void);
+
+// Returns 0 after a wake-up, -1 if *uaddr != val or uaddr is invalid
+int futex_wait(volatile uint32_t* uaddr, uint32_t val);
+
+// Returns the number of sleepers woken
+int futex_wake(volatile uint32_t* uaddr, uint32_t count);
+
+void futex_get_stats(futex_stats_t* stats);
+
+#endif // FUTEX_H
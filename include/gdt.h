@@ -0,0 +1,35 @@
+#ifndef GDT_H
+#define GDT_H
+
+#include <stdint.h>
+
+// Segment selectors of the kernel GDT
+#define GDT_KERNEL_CS 0x08
+#define GDT_KERNEL_DS 0x10
+#define GDT_USER_CS   0x18
+#define GDT_USER_DS   0x20
+#define GDT_TLS_SEL   0x2B  // Per-thread TLS segment (RPL 3), loaded into %gs
+#define GDT_TSS_SEL   0x30  // Task state segment (ring 0 stack for traps from ring 3)
+
+// Load the kernel GDT and reload every segment register
+void gdt_init(void);
+
+// Point the TLS segment at [base, base + limit) and reload %gs.
+// A zero limit selects a flat segment for threads without TLS.
+void gdt_set_tls(uint32_t base, uint32_t limit);
+
+// Install the TSS descriptor and load the task register
+void gdt_set_tss(uint32_t base, uint32_t limit);
+
+// Thread-local storage accessors (offsets into the current thread's block)
+static inline uint32_t tls_read32(uint32_t offset) {
+    uint32_t value;
+    asm volatile ("movl %%gs:(%1), %0" : "=r"(value) : "r"(offset));
+    return value;
+}
+
+static inline void tls_write32(uint32_t offset, uint32_t value) {
+    asm volatile ("movl %0, %%gs:(%1)" : : "r"(value), "r"(offset) : "memory");
+}
+
+#endif // GDT_H
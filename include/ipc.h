@@ -3,19 +3,121 @@
 
 #include <stdint.h>
 
+// Message passing between processes. Every process owns one mailbox, a
+// ring of messages whose capacity is fixed when it is created; sends to a
+// full mailbox fail and are counted as drops. A mailbox is created with
+// IPC_MAILBOX_DEFAULT slots on first use unless ipc_mailbox_create()
+// sized it earlier. Processes are addressed by process id.
+
 #define MAX_MSG_SIZE 256
-#define MAX_MESSAGES 16
+#define IPC_MAILBOX_DEFAULT 16   // Capacity of an implicitly created mailbox
+#define IPC_MAILBOX_MAX     32   // Largest capacity
 
 typedef struct {
     uint32_t sender;
     uint32_t receiver;
     uint8_t type;
+    uint8_t flags;               // IPC_MSG_* bits set by the kernel
     uint16_t length;
     uint8_t data[MAX_MSG_SIZE];
 } ipc_msg_t;
 
+typedef struct {
+    uint32_t capacity;
+    uint32_t depth;              // Messages queued now
+    uint32_t max_depth;          // High-water mark
+    uint32_t sent;               // Messages accepted
+    uint32_t received;
+    uint32_t dropped;            // Sends refused because the mailbox was full
+    uint32_t timeouts;           // Blocking receives that gave up
+    uint32_t pages_received;     // Pages moved in by ipc_send_pages()
+} ipc_mailbox_stats_t;
+
+struct proc_shared;
+
 void ipc_init(void);
+
+// Size the mailbox of owner; fails if it already holds messages
+int ipc_mailbox_create(struct proc_shared* owner, uint32_t capacity);
+void ipc_mailbox_release(struct proc_shared* owner);
+
+// Returns 0, -1 if the receiver does not exist or its mailbox is full,
+// or -2 if the message is too long
 int ipc_send(uint32_t receiver, uint8_t type, void* data, uint16_t len);
+
+// Take the oldest message, or the oldest from sender if non-zero.
+// ipc_receive() returns -1 at once when none is queued; the timed
+// variant sleeps up to timeout_ms (negative: forever).
 int ipc_receive(uint32_t sender, ipc_msg_t* msg);
+int ipc_receive_timeout(uint32_t sender, ipc_msg_t* msg, int32_t timeout_ms);
+
+int ipc_get_stats(uint32_t pid, ipc_mailbox_stats_t* stats);
+
+// Zero-copy transfer of large payloads. A page buffer is a run of pages
+// in the IPC window owned by one process. ipc_send_pages() moves its
+// page table entries to a free run owned by the receiver and queues a
+// message flagged IPC_MSG_PAGES whose data is an ipc_page_grant_t; the
+// cost is a PTE update per page whatever the payload, and the sender
+// loses its mapping.
+
+#define IPC_WINDOW_BASE      0x40000000
+#define IPC_BUFFER_MAX_PAGES 64      // Largest buffer (256KB)
+#define IPC_MAX_BUFFERS      32      // Buffers system-wide
+
+#define IPC_MSG_PAGES 0x01           // data is an ipc_page_grant_t
+
+typedef struct {
+    uint32_t addr;               // Where the pages now live for the receiver
+    uint32_t pages;
+} ipc_page_grant_t;
+
+// Zeroed buffer of the given number of pages, or NULL
+void* ipc_buffer_alloc(struct proc_shared* owner, uint32_t pages);
+int ipc_buffer_free(struct proc_shared* owner, void* addr);
+
+// Move the buffer at addr, owned by the caller, to receiver. Returns 0,
+// or -1 with the buffer left in place.
+int ipc_send_pages(uint32_t receiver, uint8_t type, void* addr);
+
+// Synchronous call/reply between threads. A short message of a few
+// words is copied straight into the peer's buffer; when the server is
+// already waiting, the caller switches directly to it, and the reply
+// switches directly back, without a pass through the run queue.
+
+#define IPC_SHORT_WORDS 4
+
+typedef struct {
+    uint32_t label;              // Operation or status, chosen by the peers
+    uint32_t words[IPC_SHORT_WORDS];
+} ipc_short_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t handoffs;           // Switches made directly to the peer
+    uint32_t queued;             // Calls that waited for a busy server
+} ipc_call_stats_t;
+
+// Send request to the server thread and sleep until it replies.
+// Returns 0, or -1 if the server does not exist or exits first.
+int ipc_call(uint32_t server, const ipc_short_t* request, ipc_short_t* reply);
+
+// Reply to caller (0: nobody) and wait for the next call, which is stored
+// in request. Returns the caller's thread id, or -1.
+int ipc_reply_wait(uint32_t caller, const ipc_short_t* reply, ipc_short_t* request);
+
+void ipc_get_call_stats(ipc_call_stats_t* stats);
+
+struct process;
+void ipc_thread_exit(struct process* thread);
+
+// Ping-pong round trips against an echo server process, through the
+// mailboxes and through ipc_call(), in TSC cycles per round trip
+typedef struct {
+    uint32_t mailbox_cycles;
+    uint32_t call_cycles;
+    uint32_t handoffs;           // Direct switches during the call rounds
+} ipc_bench_t;
+
+int ipc_pingpong_benchmark(uint32_t rounds, ipc_bench_t* result);
 
 #endif
@@ -48,6 +48,20 @@ void unmap_page(uint32_t virt_addr);
 // Memory utilities
 uint32_t get_phys_addr(uint32_t virt_addr);
 void flush_tlb(void);
+void invlpg(uint32_t virt_addr);
+
+// Runs of pages in a 4MB window of virtual addresses, for subsystems
+// that map their own frames. Not locked: callers serialize.
+#define VM_WINDOW_PAGES 1024
+
+typedef struct {
+    uint32_t base;
+    uint32_t map[VM_WINDOW_PAGES / 32];  // Bit set: page in use
+} vm_window_t;
+
+void vm_window_init(vm_window_t* window, uint32_t base);
+uint32_t vm_window_alloc(vm_window_t* window, uint32_t pages);  // 0: no free run
+void vm_window_free(vm_window_t* window, uint32_t addr, uint32_t pages);
 
 // Heap management
 void heap_init(void);
@@ -0,0 +1,73 @@
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include <stdint.h>
+#include "spinlock.h"
+#include "wait.h"
+
+struct process;
+
+// Spin iterations a contender may burn while the owner is running
+#define MUTEX_SPIN_LIMIT 1000
+
+// Longest owner chain a priority boost is propagated along
+#define MUTEX_PI_DEPTH 8
+
+#ifdef LOCK_STATS
+typedef struct mutex_stats {
+    const char* name;
+    uint32_t acquisitions;        // Successful mutex_lock/trylock calls
+    uint32_t contentions;         // mutex_lock calls that found it held
+    uint32_t spin_acquired;       // Contended, but taken while spinning
+    uint32_t sleeps;              // Times a contender went to sleep
+    uint32_t boosts;              // Priority inheritance boosts applied
+    uint64_t wait_cycles;         // Total TSC cycles spent contending
+    uint32_t max_wait_cycles;
+    struct mutex_stats* next;     // Link in the global registry
+    uint8_t registered;
+} mutex_stats_t;
+#endif
+
+// Sleeping mutex with priority inheritance: while a higher-priority task
+// waits, the owner runs at the waiter's priority. Contenders spin briefly
+// while the owner is running, then block on a wait queue.
+// Process context only; never take a mutex from an interrupt handler.
+typedef struct mutex {
+    spinlock_t lock;              // Protects locked/owner
+    volatile int locked;
+    struct process* owner;
+    wait_queue_t waiters;
+    struct mutex* next_held;      // Link in the owner's held list
+#ifdef LOCK_STATS
+    mutex_stats_t stats;
+#endif
+} mutex_t;
+
+// Counting semaphore built on the same wait queues
+typedef struct {
+    spinlock_t lock;              // Protects count
+    volatile int count;
+    wait_queue_t waiters;
+} semaphore_t;
+
+// Mutex functions
+void mutex_init(mutex_t* mutex, const char* name);
+void mutex_lock(mutex_t* mutex);
+int mutex_trylock(mutex_t* mutex);
+void mutex_unlock(mutex_t* mutex);
+int mutex_is_locked(mutex_t* mutex);
+
+// Recompute a task's effective priority from its base priority and the
+// waiters of the mutexes it holds
+void mutex_update_priority(struct process* task);
+
+// Print the statistics of every registered mutex
+void mutex_stats_dump(void);
+
+// Semaphore functions
+void sem_init(semaphore_t* sem, int count, const char* name);
+void sem_down(semaphore_t* sem);
+int sem_trydown(semaphore_t* sem);
+void sem_up(semaphore_t* sem);
+
+#endif // MUTEX_H
@@ -31,6 +31,7 @@ typedef struct net_device {
 void net_init(void);
 int  net_register_device(net_device_t* dev);
 void net_poll_all(void);
+void net_rx_schedule(void);
 uint32_t net_get_device_count(void);
 net_device_t* net_get_device(uint32_t index);
 
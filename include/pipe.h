@@ -0,0 +1,39 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+#include <stdint.h>
+
+// Anonymous pipes. A pipe is a ring of page buffers between a read end
+// and a write end, both ordinary descriptors. Reads sleep until data
+// arrives and return what is there; writes sleep until everything fits.
+// Reading a pipe without writers returns 0, writing one without readers
+// fails. splice() moves data between a pipe and another descriptor
+// straight through the pipe's pages; between two pipes full pages
+// change hands without being copied.
+
+#define PIPE_BUFFERS 4           // Pages per pipe
+#define MAX_PIPES    8
+
+typedef struct {
+    uint32_t pipes;              // Pipes open now
+    uint32_t bytes_written;      // Through write() and splice()
+    uint32_t bytes_read;
+    uint32_t splices;
+    uint32_t pages_moved;        // Pages handed between pipes without a copy
+} pipe_stats_t;
+
+struct file;
+struct proc_shared;
+
+void pipe_init(void);
+
+// Install the read end in fds[0] and the write end in fds[1]
+int pipe_create(struct proc_shared* owner, int fds[2]);
+
+// Move up to len bytes from in to out, one of which must be a pipe.
+// Returns the bytes moved, 0 at end of input, or -1.
+int pipe_splice(struct file* in, struct file* out, uint32_t len);
+
+void pipe_get_stats(pipe_stats_t* stats);
+
+#endif // PIPE_H
@@ -0,0 +1,62 @@
+#ifndef POLL_H
+#define POLL_H
+
+#include <stdint.h>
+
+// Readiness notification. Every event source exposes a callback that
+// reports its POLL* bits without consuming anything, and calls
+// poll_notify() whenever that state may have changed. An epoll instance
+// is a descriptor holding an interest set of descriptors and sources;
+// epoll_wait() sleeps until one of them is ready or the timeout passes.
+// Readiness is level-triggered.
+
+#define POLLIN   0x001   // Data can be read without blocking
+#define POLLOUT  0x004   // Data can be written without blocking
+#define POLLERR  0x008   // Always reported
+#define POLLHUP  0x010   // Always reported
+
+// Sources that are not files
+#define POLL_SRC_KEYBOARD 0   // Keyboard ring holds input
+#define POLL_SRC_SERIAL   1   // COM1 receive ring holds input
+#define POLL_SRC_IPC      2   // A message is queued for the caller
+#define POLL_SRC_NET      3   // A packet is queued for network_receive_packet()
+#define POLL_NR_SOURCES   4
+
+// Interest targets: a descriptor number, or EPOLL_SOURCE(id)
+#define EPOLL_SOURCE_BASE 0x100
+#define EPOLL_SOURCE(id)  (EPOLL_SOURCE_BASE + (id))
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+#define EPOLL_MAX_ITEMS 16   // Interest set size per instance
+#define MAX_EPOLL       16   // Instances system-wide
+
+typedef struct {
+    uint32_t events;             // POLL* bits: requested, or reported
+    uint32_t data;               // Returned with the event untouched
+} epoll_event_t;
+
+struct file;
+struct proc_shared;
+
+// Evaluated in the waiting task's context with interrupts disabled
+typedef uint32_t (*poll_source_fn)(void);
+
+void poll_init(void);
+void poll_register_source(uint32_t id, poll_source_fn fn);
+
+// Wake every epoll_wait() sleeper to re-check. Safe from interrupt handlers.
+void poll_notify(void);
+
+// Return a descriptor, or -1
+int epoll_create(struct proc_shared* owner);
+int epoll_ctl(struct file* epfile, struct proc_shared* owner, int op, uint32_t target,
+              const epoll_event_t* event);
+
+// timeout_ms < 0 waits forever, 0 only checks. Returns the number of
+// events stored, 0 on timeout, or -1.
+int epoll_wait(struct file* epfile, epoll_event_t* events, uint32_t max_events, int32_t timeout_ms);
+
+#endif // POLL_H
@@ -0,0 +1,22 @@
+#ifndef PREEMPT_H
+#define PREEMPT_H
+
+#include <stdint.h>
+
+// Kernel preemption control. Each task carries its own preempt count;
+// while it is non-zero the task is never switched out from IRQ exit.
+void preempt_disable(void);
+void preempt_enable(void);
+void preempt_enable_no_resched(void);
+int preempt_count(void);
+
+// Preemption point: reschedule now if one is pending and it is safe
+void preempt_check_resched(void);
+
+// Voluntary preemption point for long-running kernel loops
+void cond_resched(void);
+
+// Worst observed delay between a reschedule request and the switch
+uint32_t preempt_get_max_latency(void);
+
+#endif // PREEMPT_H
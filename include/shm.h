@@ -0,0 +1,48 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdint.h>
+
+// Shared memory segments. A segment is a set of frames; every attach
+// maps them at a fresh address in the shared-memory window, so the same
+// segment appears at different addresses in different attachments and
+// data inside it should refer to itself by offset. A segment is freed
+// when its last attachment goes away, or by shm_remove() if it has none.
+
+#define SHM_WINDOW_BASE  0x40400000
+#define SHM_MAX_SEGMENTS 16
+#define SHM_MAX_PAGES    64          // Largest segment (256KB)
+#define SHM_MAX_ATTACH   32          // Attachments system-wide
+
+#define SHM_KEY_PRIVATE  0           // Always creates a new segment
+
+typedef struct {
+    uint32_t segments;           // Segments in use
+    uint32_t attachments;
+    uint32_t pages;              // Frames held by segments
+} shm_stats_t;
+
+struct proc_shared;
+
+void shm_init(void);
+
+// Segment id for key, created zeroed with at least size bytes if no
+// segment has the key yet. Returns -1 if an existing segment is smaller.
+int shm_create(uint32_t key, uint32_t size);
+
+// Forget the segment's key and free it once nothing is attached: at
+// once if nothing is now, else with the last detach
+int shm_remove(int id);
+
+// Returns the address of the new mapping, or NULL
+void* shm_attach(struct proc_shared* owner, int id);
+int shm_detach(struct proc_shared* owner, void* addr);
+void shm_release(struct proc_shared* owner);
+
+// Frame backing addr if it lies in an attachment, else 0. Futexes in a
+// segment are keyed by it, so every attachment sees the same futex.
+uint32_t shm_phys_addr(uint32_t addr);
+
+void shm_get_stats(shm_stats_t* stats);
+
+#endif // SHM_H
@@ -0,0 +1,40 @@
+#ifndef SOFTIRQ_H
+#define SOFTIRQ_H
+
+#include <stdint.h>
+
+// Bottom-half vectors, processed in priority order on IRQ exit
+enum {
+    SOFTIRQ_TIMER = 0,    // Per-tick housekeeping deferred from IRQ0
+    SOFTIRQ_NET_RX,       // NIC receive processing
+    SOFTIRQ_TASKLET,      // Generic tasklets
+    NR_SOFTIRQS
+};
+
+typedef void (*softirq_handler_t)(void);
+
+// Tasklet: a one-shot deferred function run from SOFTIRQ_TASKLET.
+// A tasklet that is already scheduled is not queued a second time.
+typedef struct tasklet {
+    void (*func)(uint32_t data);
+    uint32_t data;
+    volatile uint8_t scheduled;
+    struct tasklet* next;
+} tasklet_t;
+
+#define TASKLET_INIT(fn, arg) { (fn), (arg), 0, 0 }
+
+void softirq_init(void);
+void open_softirq(uint32_t nr, softirq_handler_t handler);
+void raise_softirq(uint32_t nr);
+
+// IRQ entry/exit bookkeeping called by irq_handler(). irq_exit() runs
+// pending softirqs with interrupts enabled once the outermost IRQ unwinds.
+void irq_enter(void);
+void irq_exit(void);
+int in_interrupt(void);
+
+void tasklet_init(tasklet_t* t, void (*func)(uint32_t), uint32_t data);
+void tasklet_schedule(tasklet_t* t);
+
+#endif // SOFTIRQ_H
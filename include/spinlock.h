@@ -0,0 +1,118 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <stdint.h>
+#include "../kernel/cpu.h"
+#include "preempt.h"
+
+// Optional per-lock statistics (build with: make LOCK_STATS=1)
+#ifdef LOCK_STATS
+typedef struct lock_stats {
+    const char* name;
+    uint32_t acquisitions;        // Successful lock acquisitions
+    uint32_t contentions;         // Acquisitions that had to spin
+    uint64_t hold_cycles;         // Total TSC cycles the lock was held
+    uint32_t max_hold_cycles;     // Longest single hold
+    uint64_t acquired_at;         // TSC at the last acquisition
+    struct lock_stats* next;      // Link in the global registry
+    uint8_t registered;
+} lock_stats_t;
+#endif
+
+// Ticket spinlock: FIFO-fair, one locked xadd per acquisition.
+// Holding a spinlock disables kernel preemption.
+typedef struct {
+    volatile uint16_t next;       // Next ticket to hand out
+    volatile uint16_t owner;      // Ticket currently being served
+#ifdef LOCK_STATS
+    lock_stats_t stats;
+#endif
+} spinlock_t;
+
+#ifdef LOCK_STATS
+void lock_stat_acquired(spinlock_t* lock, int contended);
+void lock_stat_released(spinlock_t* lock);
+#endif
+
+// Initialize a lock; the name is only kept when LOCK_STATS is enabled
+void spin_lock_init(spinlock_t* lock, const char* name);
+
+// Print the statistics of every registered lock
+void lock_stats_dump(void);
+
+static inline void spin_lock(spinlock_t* lock) {
+    preempt_disable();
+
+    uint16_t ticket = 1;
+    asm volatile ("lock xaddw %0, %1" : "+r"(ticket), "+m"(lock->next) : : "memory");
+
+    int contended = 0;
+    while (lock->owner != ticket) {
+        contended = 1;
+        cpu_relax();
+    }
+#ifdef LOCK_STATS
+    lock_stat_acquired(lock, contended);
+#else
+    (void)contended;
+#endif
+}
+
+static inline int spin_trylock(spinlock_t* lock) {
+    preempt_disable();
+
+    uint16_t owner = lock->owner;
+    uint32_t old = ((uint32_t)owner << 16) | owner;
+    uint32_t new_val = ((uint32_t)owner << 16) | (uint16_t)(owner + 1);
+
+    // next and owner are adjacent, so compare-and-swap both at once
+    uint32_t prev;
+    asm volatile ("lock cmpxchgl %2, %1"
+                  : "=a"(prev), "+m"(*(volatile uint32_t*)&lock->next)
+                  : "r"(new_val), "0"(old)
+                  : "memory");
+    if (prev != old) {
+        preempt_enable();
+        return 0;
+    }
+#ifdef LOCK_STATS
+    lock_stat_acquired(lock, 0);
+#endif
+    return 1;
+}
+
+// Release without acting on a pending reschedule
+static inline void spin_unlock_no_resched(spinlock_t* lock) {
+#ifdef LOCK_STATS
+    lock_stat_released(lock);
+#endif
+    asm volatile ("" : : : "memory");
+    lock->owner++;
+    preempt_enable_no_resched();
+}
+
+static inline void spin_unlock(spinlock_t* lock) {
+    spin_unlock_no_resched(lock);
+    preempt_check_resched();
+}
+
+static inline int spin_is_locked(spinlock_t* lock) {
+    return lock->next != lock->owner;
+}
+
+// IRQ-safe variants for data shared with interrupt handlers
+static inline uint32_t spin_lock_irqsave(spinlock_t* lock) {
+    uint32_t flags = irq_save();
+    spin_lock(lock);
+    return flags;
+}
+
+// Interrupts are restored before the preemption point, so a reschedule
+// requested while the lock was held is not deferred to the next IRQ
+static inline void spin_unlock_irqrestore(spinlock_t* lock, uint32_t flags) {
+    spin_unlock_no_resched(lock);
+    irq_restore(flags);
+    preempt_check_resched();
+}
+
+#endif // SPINLOCK_H
@@ -0,0 +1,82 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+
+// Lock-free single-producer/single-consumer channel of fixed-size
+// records, laid out inside a shared memory segment. Each side writes its
+// own index on its own cache line and keeps a private copy of the other
+// side's index, refreshed only when the ring looks full or empty, so the
+// lines bounce only when a side actually catches up with the other.
+// Records are published in batches: spsc_push() fills slots privately
+// and spsc_publish() makes them all visible with one store. The kernel
+// is entered only to sleep on an empty or full ring and to wake a
+// sleeping peer, through futexes on the index words.
+
+#define SPSC_CACHE_LINE 64
+#define SPSC_MAGIC      0x53505343   // "SPSC"
+
+typedef struct {
+    // Written once by spsc_init()
+    uint32_t magic;
+    uint32_t mask;               // Capacity - 1 (capacity is a power of two)
+    uint32_t record_size;
+    uint32_t slots;              // Offset of the first slot from the ring
+    uint8_t pad0[SPSC_CACHE_LINE - 16];
+
+    // Producer line
+    volatile uint32_t tail;      // Records published
+    volatile uint32_t producer_waiting;  // Producer asleep on a full ring
+    uint32_t wakeups;            // Futex wakes issued by the producer
+    uint8_t pad1[SPSC_CACHE_LINE - 12];
+
+    // Consumer line
+    volatile uint32_t head;      // Records released
+    volatile uint32_t consumer_waiting;  // Consumer asleep on an empty ring
+    uint32_t sleeps;             // Times the consumer went to sleep
+    uint8_t pad2[SPSC_CACHE_LINE - 12];
+} __attribute__((aligned(SPSC_CACHE_LINE))) spsc_ring_t;
+
+// Process-private ends
+typedef struct {
+    spsc_ring_t* ring;
+    uint32_t tail;               // Next slot to fill; published up to ring->tail
+    uint32_t head_cache;         // Last ring->head seen
+} spsc_producer_t;
+
+typedef struct {
+    spsc_ring_t* ring;
+    uint32_t head;               // Next record to read; released up to ring->head
+    uint32_t tail_cache;         // Last ring->tail seen
+} spsc_consumer_t;
+
+// Format a ring in size bytes at mem. Returns the capacity in records
+// (the largest power of two that fits), or -1.
+int spsc_init(void* mem, uint32_t size, uint32_t record_size);
+
+// Attach to a ring formatted by spsc_init(); -1 if mem holds none
+int spsc_producer_init(spsc_producer_t* p, void* mem);
+int spsc_consumer_init(spsc_consumer_t* c, void* mem);
+
+// Producer: copy a record into the next slot without publishing it.
+// Returns 0, or -1 if the ring is full.
+int spsc_push(spsc_producer_t* p, const void* record);
+
+// Make every pushed record visible and wake the consumer if it sleeps
+void spsc_publish(spsc_producer_t* p);
+
+// Publish, then sleep until a slot is free
+void spsc_wait_space(spsc_producer_t* p);
+
+// Consumer: the next record, or NULL if none is published. The slot
+// stays valid until spsc_release().
+const void* spsc_peek(spsc_consumer_t* c);
+void spsc_next(spsc_consumer_t* c);
+
+// Hand every consumed slot back to the producer
+void spsc_release(spsc_consumer_t* c);
+
+// Release, then sleep until a record is published
+void spsc_wait_data(spsc_consumer_t* c);
+
+#endif // SPSC_H
@@ -2,6 +2,9 @@
 #define SYSCALL_H
 
 #include <stdint.h>
+#include "file.h"
+#include "poll.h"
+#include "ipc.h"
 
 // Basic system call numbers
 #define SYS_EXIT      1
@@ -39,6 +42,50 @@
 #define SYS_POWER_STATE 33
 #define SYS_GET_BATTERY_INFO 34
 #define SYS_GET_POWER_STATS 35
+#define SYS_GETTID    36
+#define SYS_THREAD_CREATE 37
+#define SYS_THREAD_JOIN   38
+#define SYS_THREAD_EXIT   39
+#define SYS_FUTEX     40
+#define SYS_RING_SETUP 41
+#define SYS_RING_ENTER 42
+#define SYS_VDSO_PAGE  43
+#define SYS_TRACE_CTL  44
+#define SYS_TRACE_READ 45
+#define SYS_READV     46
+#define SYS_WRITEV    47
+#define SYS_PREAD     48
+#define SYS_PWRITE    49
+#define SYS_EPOLL_CREATE 50
+#define SYS_EPOLL_CTL    51
+#define SYS_EPOLL_WAIT   52
+#define SYS_IPC_SEND     53
+#define SYS_IPC_RECEIVE  54
+#define SYS_IPC_MAILBOX  55
+#define SYS_IPC_CALL     56
+#define SYS_IPC_REPLY_WAIT 57
+#define SYS_IPC_BUF_ALLOC  58
+#define SYS_IPC_BUF_FREE   59
+#define SYS_IPC_SEND_PAGES 60
+#define SYS_SHM_CREATE   61
+#define SYS_SHM_ATTACH   62
+#define SYS_SHM_DETACH   63
+#define SYS_PIPE         64
+#define SYS_SPLICE       65
+#define SYS_UNLINK       66
+#define SYS_FTRUNCATE    67
+#define SYS_SHM_REMOVE   68
+
+// sys_get_stats types
+#define STATS_SYSTEM      0  // system_stats_t
+#define STATS_PERFORMANCE 1  // performance_metrics_t
+#define STATS_SCHED       2  // sched_stats_t of the task given as arg
+#define STATS_SYSCALL     3  // syscall_counter_t of the syscall given as arg
+#define STATS_CONSOLE     4  // console_stats_t
+#define STATS_IPC         5  // ipc_mailbox_stats_t of the process given as arg
+#define STATS_SHM         6  // shm_stats_t
+#define STATS_PIPE        7  // pipe_stats_t
+#define STATS_RAMFS       8  // ramfs_stats_t
 
 // System call return values
 #define SYS_SUCCESS 0
@@ -52,11 +99,19 @@ uint32_t syscall_register(uint32_t syscall_num, syscall_handler_t handler);
 
 // C wrapper for invoking a system call from C code
 uint32_t syscall(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+uint32_t syscall4(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4);
+
+// Fast variant: SYSENTER/SYSEXIT from ring 3, a plain call from ring 0
+uint32_t syscall_fast(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3);
 
 // System call implementations
 uint32_t sys_exit(uint32_t status);
 uint32_t sys_write(uint32_t fd, const char* buf, uint32_t count);
 uint32_t sys_read(uint32_t fd, char* buf, uint32_t count);
+uint32_t sys_readv(uint32_t fd, const iovec_t* iov, uint32_t iovcnt);
+uint32_t sys_writev(uint32_t fd, const iovec_t* iov, uint32_t iovcnt);
+uint32_t sys_pread(uint32_t fd, void* buf, uint32_t count, uint32_t offset);
+uint32_t sys_pwrite(uint32_t fd, const void* buf, uint32_t count, uint32_t offset);
 uint32_t sys_open(const char* path, uint32_t flags);
 uint32_t sys_close(uint32_t fd);
 uint32_t sys_getpid(void);
@@ -66,7 +121,7 @@ uint32_t sys_free(uint32_t ptr);
 uint32_t sys_sleep(uint32_t ticks);
 uint32_t sys_get_time(void);
 uint32_t sys_log(uint8_t level, const char* message);
-uint32_t sys_get_stats(uint32_t stats_type, void* buffer);
+uint32_t sys_get_stats(uint32_t stats_type, void* buffer, uint32_t arg);
 uint32_t sys_fork(void);
 uint32_t sys_wait(uint32_t pid);
 uint32_t sys_exec(const char* path);
@@ -89,5 +144,34 @@ uint32_t sys_dump_logs(void);
 uint32_t sys_power_state(uint32_t state);
 uint32_t sys_get_battery_info(void* buffer);
 uint32_t sys_get_power_stats(void* buffer);
+uint32_t sys_gettid(void);
+uint32_t sys_thread_create(uint32_t entry, uint32_t arg, uint32_t tls_base);
+uint32_t sys_thread_join(uint32_t tid, int* status);
+uint32_t sys_thread_exit(uint32_t status);
+uint32_t sys_futex(uint32_t* uaddr, uint32_t op, uint32_t val);
+uint32_t sys_ring_setup(void);
+uint32_t sys_ring_enter(uint32_t to_submit, uint32_t min_complete);
+uint32_t sys_vdso_page(void);
+uint32_t sys_trace_ctl(uint32_t pid, uint32_t enable);
+uint32_t sys_trace_read(uint32_t pid, void* buffer, uint32_t max_records);
+uint32_t sys_ipc_send(uint32_t receiver, uint8_t type, const void* data, uint16_t length);
+uint32_t sys_ipc_receive(uint32_t sender, ipc_msg_t* msg, int32_t timeout_ms);
+uint32_t sys_ipc_mailbox(uint32_t capacity);
+uint32_t sys_ipc_call(uint32_t server, const ipc_short_t* request, ipc_short_t* reply);
+uint32_t sys_ipc_reply_wait(uint32_t caller, const ipc_short_t* reply, ipc_short_t* request);
+uint32_t sys_ipc_buf_alloc(uint32_t pages);
+uint32_t sys_ipc_buf_free(void* addr);
+uint32_t sys_ipc_send_pages(uint32_t receiver, uint8_t type, void* addr);
+uint32_t sys_shm_create(uint32_t key, uint32_t size);
+uint32_t sys_shm_attach(uint32_t id);
+uint32_t sys_shm_detach(void* addr);
+uint32_t sys_shm_remove(uint32_t id);
+uint32_t sys_pipe(int* fds);
+uint32_t sys_splice(uint32_t fd_in, uint32_t fd_out, uint32_t len);
+uint32_t sys_unlink(const char* path);
+uint32_t sys_ftruncate(uint32_t fd, uint32_t size);
+uint32_t sys_epoll_create(void);
+uint32_t sys_epoll_ctl(uint32_t epfd, uint32_t op, uint32_t target, const epoll_event_t* event);
+uint32_t sys_epoll_wait(uint32_t epfd, epoll_event_t* events, uint32_t max_events, int32_t timeout_ms);
 
 #endif // SYSCALL_H
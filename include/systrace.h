@@ -0,0 +1,48 @@
+#ifndef SYSTRACE_H
+#define SYSTRACE_H
+
+#include <stdint.h>
+
+// Per-syscall accounting, kept by syscall_dispatch() for every call, and
+// an optional strace-style record ring per traced process.
+
+#define SYSCALL_NR_MAX  64   // Counter slots; larger numbers share the last
+#define TRACE_RING_SIZE 64   // Records per traced process (power of two)
+
+typedef struct {
+    uint32_t calls;
+    uint32_t errors;             // Returned SYS_ERROR
+    uint64_t total_cycles;       // Includes time spent blocked in the call
+    uint32_t max_cycles;
+} syscall_counter_t;
+
+typedef struct {
+    uint32_t num;
+    uint32_t args[4];
+    uint32_t result;
+    uint32_t cycles;
+    int32_t tid;
+} trace_record_t;
+
+struct proc_shared;
+
+void systrace_init(void);
+
+// Called by the dispatcher after every system call
+void systrace_account(uint32_t num, const uint32_t args[4], uint32_t result, uint32_t cycles);
+
+// Start/stop recording a process (by pid). Returns 0 or -1.
+int systrace_enable(int pid, int enable);
+
+// Move up to max of the oldest records of a traced process into buf.
+// Returns the number copied, or -1 if the process is not traced.
+int systrace_read(int pid, trace_record_t* buf, uint32_t max);
+
+void systrace_get_counter(uint32_t num, syscall_counter_t* counter);
+void systrace_release(struct proc_shared* owner);
+
+// Shell output
+void systrace_dump_counters(void);
+void systrace_dump_trace(int pid);
+
+#endif // SYSTRACE_H
@@ -0,0 +1,32 @@
+#ifndef ULOCK_H
+#define ULOCK_H
+
+#include <stdint.h>
+
+// User-space locks on top of SYS_FUTEX. Only contended operations
+// enter the kernel; lock/unlock of a free mutex is a single atomic.
+
+// Mutex states: 0 free, 1 locked, 2 locked with (possible) sleepers
+typedef struct {
+    volatile uint32_t state;
+} umutex_t;
+
+// Condition variable: sleepers wait for seq to change
+typedef struct {
+    volatile uint32_t seq;
+} ucond_t;
+
+#define UMUTEX_INITIALIZER { 0 }
+#define UCOND_INITIALIZER { 0 }
+
+void umutex_init(umutex_t* m);
+void umutex_lock(umutex_t* m);
+int umutex_trylock(umutex_t* m);
+void umutex_unlock(umutex_t* m);
+
+void ucond_init(ucond_t* c);
+void ucond_wait(ucond_t* c, umutex_t* m);
+void ucond_signal(ucond_t* c);
+void ucond_broadcast(ucond_t* c);
+
+#endif // ULOCK_H
@@ -0,0 +1,96 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stdint.h>
+
+// Submission/completion rings shared between a process and the kernel.
+// The process fills SQEs and advances sq_tail, then one SYS_RING_ENTER
+// hands the whole batch to the "kuring" worker thread, which runs the
+// operations and posts a CQE for each. Indices run freely and are
+// masked on access.
+
+#define URING_ENTRIES    64                    // SQ size (power of two)
+#define URING_CQ_ENTRIES (URING_ENTRIES * 2)   // Room for a full SQ in flight
+
+// Opcodes. Fields used: fd, addr (buffer), len, arg
+#define URING_OP_NOP          0
+#define URING_OP_READ         1  // read(fd, addr, len) on the owner's descriptor
+#define URING_OP_WRITE        2  // write(fd, addr, len)
+#define URING_OP_DEVICE_READ  3  // device_read(arg = name, addr, len)
+#define URING_OP_DEVICE_WRITE 4  // device_write(arg = name, addr, len)
+#define URING_OP_NET_SEND     5  // network_send_packet(arg = ip, fd = type, addr, len)
+#define URING_OP_NET_RECEIVE  6  // network_receive_packet(addr)
+
+typedef struct {
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved;
+    int32_t fd;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t arg;
+    uint32_t user_data;          // Copied to the completion untouched
+} uring_sqe_t;
+
+typedef struct {
+    uint32_t user_data;
+    int32_t res;                 // Return value of the operation
+} uring_cqe_t;
+
+// The page returned by SYS_RING_SETUP
+typedef struct {
+    volatile uint32_t sq_head;   // Written by the kernel
+    volatile uint32_t sq_tail;   // Written by the process
+    volatile uint32_t cq_head;   // Written by the process
+    volatile uint32_t cq_tail;   // Written by the kernel
+    uring_sqe_t sqes[URING_ENTRIES];
+    uring_cqe_t cqes[URING_CQ_ENTRIES];
+} __attribute__((aligned(4096))) uring_shared_t;
+
+typedef struct {
+    uint32_t setups;
+    uint32_t enters;             // SYS_RING_ENTER calls
+    uint32_t submitted;          // SQEs handed to the worker
+    uint32_t completed;          // CQEs posted
+    uint32_t cq_stalls;          // Worker stopped on a full CQ
+} uring_stats_t;
+
+struct proc_shared;
+
+// Kernel side
+void uring_init(void);
+uring_shared_t* uring_setup(struct proc_shared* owner);
+int uring_enter(struct proc_shared* owner, uint32_t to_submit, uint32_t min_complete);
+void uring_release(struct proc_shared* owner);
+void uring_get_stats(uring_stats_t* stats);
+
+// Process side helpers
+
+// Next free SQE, or NULL if the SQ is full. Published by uring_sq_push().
+static inline uring_sqe_t* uring_get_sqe(uring_shared_t* ring) {
+    if (ring->sq_tail - ring->sq_head >= URING_ENTRIES) {
+        return 0;
+    }
+    return &ring->sqes[ring->sq_tail & (URING_ENTRIES - 1)];
+}
+
+static inline void uring_sq_push(uring_shared_t* ring) {
+    asm volatile ("" : : : "memory");  // SQE contents before the tail
+    ring->sq_tail++;
+}
+
+// Oldest unreaped completion, or NULL. Release it with uring_cqe_seen().
+static inline uring_cqe_t* uring_peek_cqe(uring_shared_t* ring) {
+    if (ring->cq_head == ring->cq_tail) {
+        return 0;
+    }
+    asm volatile ("" : : : "memory");  // Tail before the CQE contents
+    return &ring->cqes[ring->cq_head & (URING_CQ_ENTRIES - 1)];
+}
+
+static inline void uring_cqe_seen(uring_shared_t* ring) {
+    asm volatile ("" : : : "memory");
+    ring->cq_head++;
+}
+
+#endif // URING_H
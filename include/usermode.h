@@ -9,9 +9,9 @@
 #define RING2   0x40  // Driver mode
 #define RING3   0x60  // User mode
 
-// User memory segment selectors
-#define USER_CS 0x18 | RING3  // User code segment
-#define USER_DS 0x20 | RING3  // User data segment
+// User memory segment selectors (GDT_USER_CS/DS with RPL 3)
+#define USER_CS (0x18 | 3)  // User code segment
+#define USER_DS (0x20 | 3)  // User data segment
 
 // TSS structure for task switching
 typedef struct {
@@ -48,6 +48,7 @@ typedef struct {
 void usermode_init(void);
 void enter_usermode(uint32_t entry_point, uint32_t stack_top);
 void setup_tss(uint32_t kernel_stack);
+void usermode_set_kernel_stack(uint32_t esp0);
 
 // User process creation
 uint32_t create_user_process(void (*entry_point)());
@@ -0,0 +1,50 @@
+#ifndef VDSO_H
+#define VDSO_H
+
+#include <stdint.h>
+
+// Kernel data page readable by every process without a trap. The kernel
+// updates it from the timer interrupt and on every task switch; readers
+// retry while seq is odd or changed under them (seqlock).
+
+#define VDSO_TSC_SHIFT 24        // ns = (tsc delta * tsc_mult) >> VDSO_TSC_SHIFT
+
+#define VDSO_CLOCK_REALTIME  0   // Wall clock, from the RTC at boot
+#define VDSO_CLOCK_MONOTONIC 1   // Time since boot
+
+typedef struct {
+    volatile uint32_t seq;       // Odd while the kernel is writing
+    uint32_t ticks;              // Timer ticks since boot
+    uint32_t hz;                 // Timer ticks per second
+    uint64_t tick_tsc;           // TSC at the last tick
+    uint32_t tsc_per_tick;       // Calibrated TSC rate, 0 until known
+    uint32_t tsc_mult;
+    uint32_t boot_time;          // Seconds since 1970 at boot
+    int32_t pid;                 // Identity of the running task
+    int32_t tid;
+    uint32_t uid;
+    uint32_t gid;
+} vdso_data_t;
+
+typedef struct {
+    uint32_t tv_sec;
+    uint32_t tv_nsec;
+} vdso_timespec_t;
+
+struct process;
+
+// Kernel side
+void vdso_init(void);
+void vdso_tick(uint32_t ticks);            // Timer interrupt
+void vdso_set_task(struct process* task);  // Task switch or credential change
+vdso_data_t* vdso_get_page(void);
+
+// Process side (library, no system calls after the first lookup)
+uint32_t vdso_get_ticks(void);
+int vdso_getpid(void);
+int vdso_gettid(void);
+uint32_t vdso_getuid(void);
+uint32_t vdso_getgid(void);
+int vdso_clock_gettime(int clock, vdso_timespec_t* ts);
+
+#endif // VDSO_H
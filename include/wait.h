@@ -0,0 +1,77 @@
+#ifndef WAIT_H
+#define WAIT_H
+
+#include <stdint.h>
+#include "spinlock.h"
+
+struct process;
+
+// One sleeping task; lives on the sleeper's own stack
+typedef struct wait_queue_entry {
+    struct process* task;
+    struct wait_queue_entry* next;
+    uint8_t woken;
+} wait_queue_entry_t;
+
+// FIFO of tasks blocked on some condition
+typedef struct wait_queue {
+    spinlock_t lock;
+    wait_queue_entry_t* head;
+    wait_queue_entry_t* tail;
+} wait_queue_t;
+
+void wait_queue_init(wait_queue_t* wq, const char* name);
+int wait_queue_empty(wait_queue_t* wq);
+
+// Low-level sleep protocol used by wait_event(). wait_prepare() disables
+// interrupts, queues the caller and marks it PROCESS_BLOCKED; the caller
+// re-checks its condition, calls wait_block() if it still has to sleep,
+// and always finishes with wait_finish().
+uint32_t wait_prepare(wait_queue_t* wq, wait_queue_entry_t* entry);
+void wait_block(void);
+void wait_finish(wait_queue_t* wq, wait_queue_entry_t* entry, uint32_t flags);
+
+// Timed sleeps. Deadlines are absolute timer ticks; wait_block_timeout()
+// also returns once the deadline passes.
+uint32_t wait_deadline(uint32_t timeout_ticks);
+int wait_timed_out(uint32_t deadline);
+void wait_block_timeout(uint32_t deadline);
+
+// Wake the first / every sleeper. Safe to call from interrupt handlers.
+int wake_up(wait_queue_t* wq);
+int wake_up_all(wait_queue_t* wq);
+
+// wake_up() returning the task it woke, or NULL
+struct process* wake_up_task(wait_queue_t* wq);
+
+// Sleep until condition becomes true. Process context only.
+#define wait_event(wq, condition) \
+    do { \
+        while (!(condition)) { \
+            wait_queue_entry_t __wait; \
+            uint32_t __flags = wait_prepare(&(wq), &__wait); \
+            if (!(condition)) { \
+                wait_block(); \
+            } \
+            wait_finish(&(wq), &__wait, __flags); \
+        } \
+    } while (0)
+
+// Like wait_event(), giving up after timeout_ticks. Evaluates to
+// non-zero if the condition became true, 0 on timeout.
+#define wait_event_timeout(wq, condition, timeout_ticks) \
+    ({ \
+        uint32_t __deadline = wait_deadline(timeout_ticks); \
+        int __done; \
+        while (!(__done = (condition)) && !wait_timed_out(__deadline)) { \
+            wait_queue_entry_t __wait; \
+            uint32_t __flags = wait_prepare(&(wq), &__wait); \
+            if (!(condition) && !wait_timed_out(__deadline)) { \
+                wait_block_timeout(__deadline); \
+            } \
+            wait_finish(&(wq), &__wait, __flags); \
+        } \
+        __done; \
+    })
+
+#endif // WAIT_H
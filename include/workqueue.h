@@ -0,0 +1,27 @@
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <stdint.h>
+
+// Deferred work item, run in process context by a kernel worker thread.
+// Unlike tasklets, work functions may sleep (take mutexes, wait_event).
+typedef struct work {
+    void (*func)(struct work* work);
+    void* data;
+    volatile uint8_t pending;
+    struct work* next;
+} work_t;
+
+#define WORK_INIT(fn, arg) { (fn), (arg), 0, 0 }
+
+void workqueue_init(void);
+void work_init(work_t* work, void (*func)(work_t*), void* data);
+
+// Queue work for the worker thread. Safe from interrupt handlers.
+// Returns 0 if the work was already pending, 1 if it was queued.
+int queue_work(work_t* work);
+
+// Statistics
+uint32_t workqueue_get_processed(void);
+
+#endif // WORKQUEUE_H
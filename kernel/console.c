@@ -0,0 +1,162 @@
+#include "../include/console.h"
+#include "../include/wait.h"
+#include "../include/spinlock.h"
+#include "../include/softirq.h"
+#include "../include/poll.h"
+#include "../drivers/keyboard.h"
+#include "../drivers/serial.h"
+#include "../drivers/vga.h"
+#include "process.h"
+#include "string.h"
+
+// Readers sleep here until the keyboard or serial IRQ delivers input
+static wait_queue_t console_input_wait;
+
+// Output buffer in front of the VGA text screen. Complete lines are
+// rendered in one batch per write; a trailing partial line waits for
+// its newline or for the flush tasklet.
+static char out_buf[CONSOLE_OUT_SIZE];
+static uint32_t out_len = 0;
+static spinlock_t out_lock;
+
+// Writers sleep here while the serial transmit ring is full
+static wait_queue_t console_output_wait;
+
+static console_stats_t console_stats;
+
+static void console_flush_tasklet(uint32_t data);
+static tasklet_t flush_tasklet = TASKLET_INIT(console_flush_tasklet, 0);
+
+void console_init(void) {
+    wait_queue_init(&console_input_wait, "console_input");
+    wait_queue_init(&console_output_wait, "console_output");
+    spin_lock_init(&out_lock, "console_out");
+    out_len = 0;
+    memset(&console_stats, 0, sizeof(console_stats));
+}
+
+char console_trygetchar(void) {
+    char c = keyboard_getchar();
+    if (c == 0) {
+        c = serial_rx_getchar();
+    }
+    return c;
+}
+
+char console_getchar(void) {
+    char c = 0;
+
+    // Show a pending prompt before sleeping on input
+    console_flush();
+
+    // The condition stores the character it found, so no input is lost
+    // between the wake-up and the read
+    wait_event(console_input_wait, (c = console_trygetchar()) != 0);
+    return c;
+}
+
+void console_wake_input(void) {
+    wake_up_all(&console_input_wait);
+    poll_notify();
+}
+
+// Render the first len buffered bytes. Called with out_lock held.
+static void console_flush_locked(uint32_t len) {
+    if (!len) {
+        return;
+    }
+    vga_write(out_buf, len);
+    out_len -= len;
+    memmove(out_buf, out_buf + len, out_len);
+    console_stats.vga_flushes++;
+}
+
+void console_flush(void) {
+    uint32_t flags = spin_lock_irqsave(&out_lock);
+    console_flush_locked(out_len);
+    spin_unlock_irqrestore(&out_lock, flags);
+}
+
+static void console_flush_tasklet(uint32_t data) {
+    (void)data;
+    console_flush();
+}
+
+static void console_vga_write(const char* buf, uint32_t len) {
+    uint32_t flags = spin_lock_irqsave(&out_lock);
+    for (uint32_t i = 0; i < len; i++) {
+        if (out_len == CONSOLE_OUT_SIZE) {
+            console_flush_locked(out_len);
+        }
+        out_buf[out_len++] = buf[i];
+    }
+
+    // Everything up to the last newline goes out now
+    uint32_t complete = out_len;
+    while (complete && out_buf[complete - 1] != '\n') {
+        complete--;
+    }
+    console_flush_locked(complete);
+    int partial = out_len != 0;
+    spin_unlock_irqrestore(&out_lock, flags);
+
+    if (partial) {
+        tasklet_schedule(&flush_tasklet);
+    }
+}
+
+// Sleeping is only possible for a scheduled task outside interrupt context
+static int console_may_sleep(void) {
+    return !in_interrupt() && process_get_current() != NULL;
+}
+
+static void console_serial_write(const char* buf, uint32_t len) {
+    while (len) {
+        uint32_t n = serial_tx_enqueue(buf, len);
+        buf += n;
+        len -= n;
+        if (!len) {
+            break;
+        }
+
+        if (!console_may_sleep()) {
+            uint32_t flags = spin_lock_irqsave(&out_lock);
+            console_stats.serial_dropped += len;
+            spin_unlock_irqrestore(&out_lock, flags);
+            break;
+        }
+
+        // Backpressure: wait for the THRE interrupt to make room
+        uint32_t flags = spin_lock_irqsave(&out_lock);
+        console_stats.serial_stalls++;
+        spin_unlock_irqrestore(&out_lock, flags);
+        wait_event(console_output_wait, serial_tx_room() != 0);
+    }
+}
+
+int console_write(const char* buf, uint32_t len) {
+    if (!buf) {
+        return -1;
+    }
+    console_vga_write(buf, len);
+    console_serial_write(buf, len);
+
+    uint32_t flags = spin_lock_irqsave(&out_lock);
+    console_stats.bytes_written += len;
+    spin_unlock_irqrestore(&out_lock, flags);
+    return (int)len;
+}
+
+void console_wake_output(void) {
+    wake_up_all(&console_output_wait);
+}
+
+void console_get_stats(console_stats_t* stats) {
+    if (stats) {
+        uint32_t flags = spin_lock_irqsave(&out_lock);
+        memcpy(stats, &console_stats, sizeof(console_stats_t));
+        stats->buffered = out_len;
+        stats->serial_interrupts = serial_tx_interrupts();
+        spin_unlock_irqrestore(&out_lock, flags);
+    }
+}
@@ -0,0 +1,45 @@
+#include "../include/console.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "CONSOLE Test: "
+#include "test_output.h"
+
+// Buffered console output test process
+void console_test_process(void) {
+    char msg[] = "CONSOLE Test: Buffered output test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    console_stats_t before, after;
+    syscall(SYS_GET_STATS, STATS_CONSOLE, (uint32_t)&before, 0);
+
+    // Three lines in one write render as a single VGA batch
+    char lines[] = "CONSOLE Test: line 1\nCONSOLE Test: line 2\nCONSOLE Test: line 3\n";
+    int n = (int)syscall(SYS_WRITE, 1, (uint32_t)lines, sizeof(lines) - 1);
+    syscall(SYS_GET_STATS, STATS_CONSOLE, (uint32_t)&after, 0);
+    report(n == (int)sizeof(lines) - 1, "write");
+    report(after.bytes_written - before.bytes_written >= sizeof(lines) - 1, "bytes counted");
+    report(after.vga_flushes - before.vga_flushes < 3, "lines batched");
+
+    // A partial line stays buffered until its newline arrives
+    syscall(SYS_WRITE, 1, (uint32_t)"CONSOLE Test: partial", 21);
+    syscall(SYS_GET_STATS, STATS_CONSOLE, (uint32_t)&after, 0);
+    report(after.buffered > 0, "partial line buffered");
+
+    // Process context applies backpressure instead of dropping
+    syscall(SYS_GET_STATS, STATS_CONSOLE, (uint32_t)&before, 0);
+    for (int i = 0; i < 64; i++) {
+        syscall(SYS_WRITE, 1, (uint32_t)"................................................................", 64);
+    }
+    syscall(SYS_WRITE, 1, (uint32_t)"\n", 1);
+    syscall(SYS_GET_STATS, STATS_CONSOLE, (uint32_t)&after, 0);
+    report(after.serial_dropped == before.serial_dropped, "no drops under load");
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
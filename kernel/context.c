@@ -1,44 +1,63 @@
 #include "context.h"
 #include "process.h"
+#include "cpu.h"
 #include "../include/idt.h"
 #include <stddef.h>
 #include "string.h"
 
 // External assembly functions
 void context_switch(cpu_context_t* old_context, cpu_context_t* new_context);
-void context_init(cpu_context_t* context, void (*entry_point)(), uint32_t stack_top);
+extern void context_trampoline(void);
 
 // Current running context
 static cpu_context_t* current_context = NULL;
 
+// Lay out the frame context_switch() pops: edi, esi, ebx, ebp, return
+// address. The extra zero slot is the return address the entered
+// function sees, so it starts with the stack layout of a normal call.
+static void context_build_frame(cpu_context_t* context, uint32_t ret_addr,
+                                uint32_t ebx, uint32_t esi, uint32_t stack_top) {
+    uint32_t* sp = (uint32_t*)(stack_top & ~0xFu);
+
+    *--sp = 0;          // Return address of the entered function
+    *--sp = ret_addr;   // Popped by context_switch's ret
+    *--sp = 0;          // ebp
+    *--sp = ebx;        // ebx
+    *--sp = esi;        // esi
+    *--sp = 0;          // edi
+
+    context->esp = (uint32_t)sp;
+    context->cr3 = 0;
+}
+
+// Initialize a context that starts entry_point with interrupts enabled
+void context_init(cpu_context_t* context, void (*entry_point)(), uint32_t stack_top) {
+    context_build_frame(context, (uint32_t)context_trampoline,
+                        (uint32_t)entry_point, 0, stack_top);
+}
+
+// Same, passing arg to the entry point
+void context_init_arg(cpu_context_t* context, void (*entry_point)(void*), void* arg, uint32_t stack_top) {
+    context_build_frame(context, (uint32_t)context_trampoline,
+                        (uint32_t)entry_point, (uint32_t)arg, stack_top);
+}
+
 // Switch to a new process context
 void switch_to_process(process_t* new_process) {
     if (!new_process) return;
-    
+
     cpu_context_t* new_context = &new_process->context;
-    
+
     if (current_context) {
         // Save current context and load new one
         context_switch(current_context, new_context);
     } else {
-        // First switch - just load new context
+        // First switch - the boot stack is never resumed
+        static cpu_context_t boot_context;
         current_context = new_context;
-        
-        // Jump to new context
-        asm volatile (
-            "movl %0, %%esp\n"
-            "popl %%eax\n"
-            "popl %%ebx\n"
-            "popl %%ecx\n"
-            "popl %%edx\n"
-            "popl %%esi\n"
-            "popl %%edi\n"
-            "popl %%ebp\n"
-            "ret\n"
-            : : "r" (new_context) : "memory"
-        );
+        context_switch(&boot_context, new_context);
     }
-    
+
     current_context = new_context;
 }
 
@@ -46,7 +65,82 @@ void switch_to_process(process_t* new_process) {
 void setup_process_context(process_t* process, void (*entry_point)()) {
     // Allocate stack (4KB for now)
     uint32_t stack_top = (uint32_t)process->stack + STACK_SIZE;
-    
+
     // Initialize context
     context_init(&process->context, entry_point, stack_top);
 }
+
+// Switch benchmark: a private context that bounces straight back
+static cpu_context_t bench_caller;
+static cpu_context_t bench_peer;
+static uint8_t bench_stack[1024] __attribute__((aligned(16)));
+
+typedef void (*context_switch_fn)(cpu_context_t* old_context, cpu_context_t* new_context);
+
+void context_switch_full(cpu_context_t* old_context, cpu_context_t* new_context);
+
+static void bench_peer_entry(void) {
+    while (1) {
+        context_switch(&bench_peer, &bench_caller);
+    }
+}
+
+static void bench_full_peer_entry(void) {
+    while (1) {
+        context_switch_full(&bench_peer, &bench_caller);
+    }
+}
+
+// Frame context_switch_full() pops: eight pushal slots, EFLAGS, return
+// address. IF stays clear, as the benchmark runs with interrupts off.
+static void bench_full_frame(cpu_context_t* context, uint32_t ret_addr, uint32_t stack_top) {
+    uint32_t* sp = (uint32_t*)(stack_top & ~0xFu);
+
+    *--sp = 0;          // Return address of the entered function
+    *--sp = ret_addr;
+    *--sp = 0x2;        // EFLAGS: reserved bit only
+    for (int i = 0; i < 8; i++) {
+        *--sp = 0;      // edi, esi, ebp, esp (skipped), ebx, edx, ecx, eax
+    }
+
+    context->esp = (uint32_t)sp;
+    context->cr3 = 0;
+}
+
+// Called with interrupts disabled and the peer frame built
+static uint32_t bench_run(context_switch_fn do_switch, uint32_t iterations) {
+    // Warm up caches and the branch predictor before timing
+    do_switch(&bench_caller, &bench_peer);
+
+    uint64_t start = rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        do_switch(&bench_caller, &bench_peer);
+    }
+    uint64_t elapsed = rdtsc() - start;
+
+    // Each iteration is two switches
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    return cycles / (iterations * 2);
+}
+
+void context_switch_benchmark(uint32_t iterations, context_bench_t* result) {
+    if (!result) {
+        return;
+    }
+    result->switch_cycles = 0;
+    result->full_switch_cycles = 0;
+    if (iterations == 0) {
+        return;
+    }
+
+    // No interrupts: the peer context is not a task the scheduler knows
+    uint32_t flags = irq_save();
+    uint32_t stack_top = (uint32_t)bench_stack + sizeof(bench_stack);
+
+    context_build_frame(&bench_peer, (uint32_t)bench_peer_entry, 0, 0, stack_top);
+    result->switch_cycles = bench_run(context_switch, iterations);
+
+    bench_full_frame(&bench_peer, (uint32_t)bench_full_peer_entry, stack_top);
+    result->full_switch_cycles = bench_run(context_switch_full, iterations);
+    irq_restore(flags);
+}
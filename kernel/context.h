@@ -3,18 +3,25 @@
 
 #include <stdint.h>
 
-// CPU context structure for process switching
+// CPU context structure for process switching. The callee-saved
+// registers (ebp, ebx, esi, edi) and the return address live on the
+// task's own stack, so only the stack pointer is kept here.
 typedef struct {
-    uint32_t eax, ebx, ecx, edx;
-    uint32_t esi, edi;
-    uint32_t ebp, esp;
-    uint32_t eip;
-    uint32_t eflags;
+    uint32_t esp;
     uint32_t cr3;  // Page directory
 } cpu_context_t;
 
 // Function prototypes
 void context_switch(cpu_context_t* old_context, cpu_context_t* new_context);
 void context_init(cpu_context_t* context, void (*entry_point)(), uint32_t stack_top);
+void context_init_arg(cpu_context_t* context, void (*entry_point)(void*), void* arg, uint32_t stack_top);
+
+// Average cycles of one switch, measured by bouncing between two contexts
+typedef struct {
+    uint32_t switch_cycles;       // context_switch(): callee-saved registers
+    uint32_t full_switch_cycles;  // Every register and EFLAGS, as before
+} context_bench_t;
+
+void context_switch_benchmark(uint32_t iterations, context_bench_t* result);
 
 #endif
@@ -1,86 +1,72 @@
 /* Context switching assembly functions */
 
 .global context_switch
-.global context_init
+.global context_trampoline
+.global context_switch_full
+
+.extern process_exit
 
 .section .text
 
 /* context_switch: Switch from old_context to new_context */
-/* void context_switch(context_t* old_context, context_t* new_context); */
+/* void context_switch(cpu_context_t* old_context, cpu_context_t* new_context); */
+/*
+ * Only the callee-saved registers are preserved: the C caller already
+ * assumes eax/ecx/edx are clobbered. EFLAGS is not saved either, since
+ * every caller of schedule() runs with interrupts disabled and restores
+ * its own flags once it is switched back in.
+ */
 context_switch:
+    movl 4(%esp), %eax       /* old_context */
+    movl 8(%esp), %edx       /* new_context */
+
     pushl %ebp
-    movl %esp, %ebp
-    
-    /* Save current context to old_context */
-    pushl %eax
     pushl %ebx
-    pushl %ecx
-    pushl %edx
     pushl %esi
     pushl %edi
-    pushl %ebp
-    
-    /* Save ESP and EIP */
-    movl 8(%ebp), %eax      /* Get old_context pointer */
-    movl %esp, 28(%eax)      /* Save ESP */
-    movl 4(%ebp), %ebx       /* Get return address */
-    movl %ebx, 32(%eax)      /* Save EIP */
-    
-    /* Save EFLAGS */
-    pushfl
-    popl %ebx
-    movl %ebx, 36(%eax)      /* Save EFLAGS */
-    
-    /* Load new context */
-    movl 12(%ebp), %eax      /* Get new_context pointer */
-    movl 28(%eax), %esp      /* Load ESP */
-    
-    /* Load EIP and EFLAGS */
-    pushl 36(%eax)            /* Push EFLAGS */
-    popfl                     /* Load EFLAGS */
-    pushl 32(%eax)            /* Push EIP */
-    
-    /* Restore registers */
-    popl %ebp
+
+    movl %esp, 0(%eax)       /* old_context->esp */
+    movl 0(%edx), %esp       /* new_context->esp */
+
     popl %edi
     popl %esi
-    popl %edx
-    popl %ecx
     popl %ebx
-    popl %eax
-    
     popl %ebp
     ret
 
-/* context_init: Initialize a new context */
-/* void context_init(context_t* context, void* entry_point, void* stack_top); */
-context_init:
-    pushl %ebp
-    movl %esp, %ebp
-    
-    /* Get parameters */
-    movl 8(%ebp), %eax       /* context pointer */
-    movl 12(%ebp), %ebx      /* entry_point */
-    movl 16(%ebp), %ecx      /* stack_top */
-    
-    /* Clear context structure */
-    pushl %edi
-    pushl %eax
-    movl %eax, %edi
-    xorl %eax, %eax
-    movl $10, %ecx           /* 10 dwords to clear */
-    rep stosl
-    popl %eax
-    popl %edi
-    
-    /* Set up initial context */
-    movl 12(%ebp), %ebx      /* entry_point */
-    movl %ebx, 32(%eax)      /* eip = entry_point */
-    movl 16(%ebp), %ecx      /* stack_top */
-    movl %ecx, 28(%eax)      /* esp = stack_top */
-    
-    /* Set EFLAGS (interrupts enabled) */
-    movl $0x202, 36(%eax)    /* EFLAGS */
-    
-    popl %ebp
+/* context_switch_full: Full-frame switch, the baseline for the benchmark */
+/* Saves every general register and EFLAGS like the switch this file used */
+/* before; nothing schedules through it. */
+context_switch_full:
+    movl 4(%esp), %eax       /* old_context */
+    movl 8(%esp), %edx       /* new_context */
+
+    pushfl
+    pushal
+
+    movl %esp, 0(%eax)
+    movl 0(%edx), %esp
+
+    popal
+    popfl
     ret
+
+/* context_trampoline: First return target of a new task (see context_init) */
+/* The entry point and its argument are handed over in %ebx and %esi. */
+/* The stack is realigned so the entry point sees %esp+4 on a 16-byte */
+/* boundary, as the i386 SysV ABI and FXSAVE-using code expect. */
+context_trampoline:
+    sti
+    andl $-16, %esp
+    subl $12, %esp
+    pushl %esi
+    call *%ebx
+    addl $4, %esp
+
+    /* Entry point returned: the task is finished */
+    cli
+    pushl $0
+    call process_exit
+1:
+    hlt
+    jmp 1b
@@ -0,0 +1,49 @@
+#include "context.h"
+#include "fpu.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+// Context switch and lazy FPU test process
+void context_test_process(void) {
+    char msg[] = "CTX Test: Context switch test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    // Callee-saved switch against the full-frame one it replaced
+    context_bench_t bench;
+    context_switch_benchmark(1000, &bench);
+    uint32_t fpu_cycles = fpu_save_restore_cycles();
+    if (bench.switch_cycles > 0) {
+        char buf[16];
+        char bench_msg[] = "CTX Test: Switch cycles: ";
+        syscall(SYS_WRITE, 1, (uint32_t)bench_msg, sizeof(bench_msg) - 1);
+        itoa((int)bench.switch_cycles, buf, 10);
+        syscall(SYS_WRITE, 1, (uint32_t)buf, strlen(buf));
+
+        char full_msg[] = ", full-frame: ";
+        syscall(SYS_WRITE, 1, (uint32_t)full_msg, sizeof(full_msg) - 1);
+        itoa((int)bench.full_switch_cycles, buf, 10);
+        syscall(SYS_WRITE, 1, (uint32_t)buf, strlen(buf));
+
+        char fpu_msg[] = ", eager FPU cost: ";
+        syscall(SYS_WRITE, 1, (uint32_t)fpu_msg, sizeof(fpu_msg) - 1);
+        itoa((int)fpu_cycles, buf, 10);
+        syscall(SYS_WRITE, 1, (uint32_t)buf, strlen(buf));
+        syscall(SYS_WRITE, 1, (uint32_t)"\n", 1);
+    }
+
+    // First FPU use must trap to #NM and load a fresh state
+    uint32_t restores = fpu_get_restore_count();
+    asm volatile ("fld1; fstp %%st(0)" : : : "memory");
+    if (fpu_get_restore_count() == restores + 1) {
+        char fpu_ok[] = "CTX Test: Lazy FPU OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)fpu_ok, sizeof(fpu_ok) - 1);
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,133 @@
+#include "../include/coroutine.h"
+#include "../include/wait.h"
+#include "process.h"
+#include "log.h"
+
+// Run queue of the "kasync" executor thread
+static coroutine_t* run_head = NULL;
+static coroutine_t* run_tail = NULL;
+static spinlock_t run_lock;
+static wait_queue_t executor_wait;
+
+static volatile uint32_t co_resumes = 0;
+static volatile uint32_t co_live = 0;
+
+// Append to the run queue. Called with run_lock held.
+static void run_enqueue_locked(coroutine_t* co) {
+    co->state = CO_STATE_READY;
+    co->next = NULL;
+    if (run_tail) {
+        run_tail->next = co;
+    } else {
+        run_head = co;
+    }
+    run_tail = co;
+}
+
+static coroutine_t* run_dequeue(void) {
+    uint32_t flags = spin_lock_irqsave(&run_lock);
+    coroutine_t* co = run_head;
+    if (co) {
+        run_head = co->next;
+        if (!run_head) {
+            run_tail = NULL;
+        }
+        co->next = NULL;
+    }
+    spin_unlock_irqrestore(&run_lock, flags);
+    return co;
+}
+
+// Executor: one thread multiplexing every coroutine
+static void executor_thread(void) {
+    while (1) {
+        wait_event(executor_wait, run_head != NULL);
+
+        coroutine_t* co;
+        while ((co = run_dequeue()) != NULL) {
+            co_resumes++;
+            int result = co->fn(co);
+
+            if (result == CO_YIELD) {
+                uint32_t flags = spin_lock_irqsave(&run_lock);
+                run_enqueue_locked(co);
+                spin_unlock_irqrestore(&run_lock, flags);
+            } else if (result == CO_DONE) {
+                uint32_t flags = spin_lock_irqsave(&run_lock);
+                co->state = CO_STATE_DONE;
+                co_live--;
+                spin_unlock_irqrestore(&run_lock, flags);
+            }
+            // CO_WAIT: already queued on its event (or re-queued by a
+            // signal that arrived since)
+        }
+    }
+}
+
+void co_executor_init(void) {
+    spin_lock_init(&run_lock, "co_runqueue");
+    wait_queue_init(&executor_wait, "kasync");
+    run_head = NULL;
+    run_tail = NULL;
+
+    if (process_create("kasync", executor_thread) < 0) {
+        log_error("Failed to create kasync thread");
+    }
+}
+
+void coroutine_init(coroutine_t* co, int (*fn)(coroutine_t*), void* data) {
+    co->fn = fn;
+    co->data = data;
+    co->resume_point = 0;
+    co->state = CO_STATE_IDLE;
+    co->next = NULL;
+}
+
+void co_spawn(coroutine_t* co) {
+    uint32_t flags = spin_lock_irqsave(&run_lock);
+    co_live++;
+    run_enqueue_locked(co);
+    spin_unlock_irqrestore(&run_lock, flags);
+
+    wake_up(&executor_wait);
+}
+
+void co_event_init(co_event_t* ev, const char* name) {
+    spin_lock_init(&ev->lock, name);
+    ev->waiters = NULL;
+}
+
+void co_wait_locked(coroutine_t* co, co_event_t* ev) {
+    co->state = CO_STATE_WAITING;
+    co->next = ev->waiters;
+    ev->waiters = co;
+}
+
+void co_event_signal(co_event_t* ev) {
+    uint32_t flags = spin_lock_irqsave(&ev->lock);
+    coroutine_t* list = ev->waiters;
+    ev->waiters = NULL;
+    spin_unlock_irqrestore(&ev->lock, flags);
+
+    if (!list) {
+        return;
+    }
+
+    flags = spin_lock_irqsave(&run_lock);
+    while (list) {
+        coroutine_t* next = list->next;
+        run_enqueue_locked(list);
+        list = next;
+    }
+    spin_unlock_irqrestore(&run_lock, flags);
+
+    wake_up(&executor_wait);
+}
+
+uint32_t co_get_resumes(void) {
+    return co_resumes;
+}
+
+uint32_t co_get_live(void) {
+    return co_live;
+}
@@ -0,0 +1,71 @@
+#include "../include/coroutine.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_COROUTINES 1000
+
+static coroutine_t test_cos[TEST_COROUTINES];
+static co_event_t test_event;
+static volatile int test_stage = 0;
+static volatile uint32_t stage1_done = 0;
+static volatile uint32_t stage2_done = 0;
+
+// Two-step state machine: wait for stage 1, yield once, wait for stage 2
+static int test_coroutine(coroutine_t* co) {
+    CO_BEGIN(co);
+    CO_AWAIT(co, &test_event, test_stage >= 1);
+    stage1_done++;
+    CO_YIELD_NOW(co);
+    CO_AWAIT(co, &test_event, test_stage >= 2);
+    stage2_done++;
+    CO_END(co);
+}
+
+// Coroutine executor test process
+void coroutine_test_process(void) {
+    char msg[] = "CO Test: Coroutine test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    co_event_init(&test_event, "co_test");
+    for (int i = 0; i < TEST_COROUTINES; i++) {
+        coroutine_init(&test_cos[i], test_coroutine, NULL);
+        co_spawn(&test_cos[i]);
+    }
+
+    // Let every coroutine park on the event, then release them in two steps
+    for (int i = 0; i < 10; i++) {
+        syscall(SYS_YIELD, 0, 0, 0);
+    }
+    int none_early = (stage1_done == 0);
+
+    test_stage = 1;
+    co_event_signal(&test_event);
+    for (int i = 0; i < 100 && stage1_done < TEST_COROUTINES; i++) {
+        syscall(SYS_YIELD, 0, 0, 0);
+    }
+
+    test_stage = 2;
+    co_event_signal(&test_event);
+    for (int i = 0; i < 100 && stage2_done < TEST_COROUTINES; i++) {
+        syscall(SYS_YIELD, 0, 0, 0);
+    }
+
+    int all_done = 1;
+    for (int i = 0; i < TEST_COROUTINES; i++) {
+        if (test_cos[i].state != CO_STATE_DONE) {
+            all_done = 0;
+        }
+    }
+    if (none_early && all_done && stage2_done == TEST_COROUTINES) {
+        char ok_msg[] = "CO Test: 1000 coroutines on one thread OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)ok_msg, sizeof(ok_msg) - 1);
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
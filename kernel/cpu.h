@@ -0,0 +1,60 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdint.h>
+
+// EFLAGS bits
+#define EFLAGS_IF 0x200  // Interrupt enable flag
+
+// Disable interrupts and return the previous EFLAGS
+static inline uint32_t irq_save(void) {
+    uint32_t flags;
+    asm volatile ("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+// Re-enable interrupts only if they were enabled in the saved EFLAGS
+static inline void irq_restore(uint32_t flags) {
+    if (flags & EFLAGS_IF) {
+        asm volatile ("sti" : : : "memory");
+    }
+}
+
+// Check whether interrupts are currently enabled
+static inline int irqs_enabled(void) {
+    uint32_t flags;
+    asm volatile ("pushfl; popl %0" : "=r"(flags));
+    return (flags & EFLAGS_IF) != 0;
+}
+
+// Spin-wait hint for busy loops
+static inline void cpu_relax(void) {
+    asm volatile ("pause" : : : "memory");
+}
+
+// Read the time stamp counter
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// 64/32 division (no libgcc); the caller guarantees the quotient fits 32 bits
+static inline uint32_t div64_32(uint64_t n, uint32_t d) {
+    uint32_t q, r;
+    asm ("divl %4" : "=a"(q), "=d"(r) : "a"((uint32_t)n), "d"((uint32_t)(n >> 32)), "rm"(d));
+    return q;
+}
+
+// Model-specific registers
+static inline void wrmsr(uint32_t msr, uint64_t value) {
+    asm volatile ("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+static inline uint64_t rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    asm volatile ("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+#endif // CPU_H
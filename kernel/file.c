@@ -0,0 +1,361 @@
+#include "../include/file.h"
+#include "../include/filesystem.h"
+#include "../include/device.h"
+#include "../include/console.h"
+#include "../include/poll.h"
+#include "../drivers/keyboard.h"
+#include "../drivers/serial.h"
+#include "process.h"
+#include "cpu.h"
+#include "string.h"
+
+static file_t file_pool[MAX_OPEN_FILES];
+static file_t* console_file = NULL;
+
+// Console backend: keyboard/serial in, buffered VGA and COM1 out
+
+static int console_file_read(file_t* f, void* buffer, uint32_t count, uint32_t offset) {
+    (void)f; (void)offset;
+    char* buf = (char*)buffer;
+    // Sleeps until keyboard or serial input arrives
+    for (uint32_t i = 0; i < count; i++) {
+        buf[i] = console_getchar();
+    }
+    return count;
+}
+
+static int console_file_write(file_t* f, const void* buffer, uint32_t count, uint32_t offset) {
+    (void)f; (void)offset;
+    return console_write((const char*)buffer, count);
+}
+
+// Output never blocks for long, so the console is always writable
+static uint32_t console_file_poll(file_t* f) {
+    (void)f;
+    return ((keyboard_pending() || serial_rx_pending()) ? POLLIN : 0) | POLLOUT;
+}
+
+static const file_ops_t console_ops = { console_file_read, console_file_write, NULL, console_file_poll };
+
+// ramfs backend
+
+static int ramfs_file_read(file_t* f, void* buffer, uint32_t count, uint32_t offset) {
+    return ramfs_read(f->inode, buffer, count, offset);
+}
+
+static int ramfs_file_write(file_t* f, const void* buffer, uint32_t count, uint32_t offset) {
+    return ramfs_write(f->inode, buffer, count, offset);
+}
+
+// Open counts and the slot free list change with interrupts off
+static void ramfs_file_release(file_t* f) {
+    uint32_t flags = irq_save();
+    ramfs_close(f->inode);
+    irq_restore(flags);
+}
+
+static const file_ops_t ramfs_file_ops = { ramfs_file_read, ramfs_file_write, ramfs_file_release, NULL };
+
+// Device backend: the driver is looked up once at open time
+
+static int device_file_read(file_t* f, void* buffer, uint32_t count, uint32_t offset) {
+    (void)offset;
+    return f->dev->ops->read ? f->dev->ops->read(buffer, count) : -1;
+}
+
+static int device_file_write(file_t* f, const void* buffer, uint32_t count, uint32_t offset) {
+    (void)offset;
+    return f->dev->ops->write ? f->dev->ops->write(buffer, count) : -1;
+}
+
+static void device_file_release(file_t* f) {
+    if (f->dev->ops->close) {
+        f->dev->ops->close();
+    }
+}
+
+static const file_ops_t device_file_ops = { device_file_read, device_file_write, device_file_release, NULL };
+
+file_t* file_alloc(const file_ops_t* ops, uint32_t flags) {
+    file_t* file = NULL;
+    uint32_t irq = irq_save();
+    for (int i = 0; i < MAX_OPEN_FILES; i++) {
+        if (!file_pool[i].ops) {
+            file = &file_pool[i];
+            memset(file, 0, sizeof(file_t));
+            file->ops = ops;
+            file->refcount = 1;
+            file->flags = flags;
+            break;
+        }
+    }
+    irq_restore(irq);
+    return file;
+}
+
+static void file_get(file_t* file) {
+    uint32_t flags = irq_save();
+    file->refcount++;
+    irq_restore(flags);
+}
+
+void file_put(file_t* file) {
+    if (!file) {
+        return;
+    }
+    uint32_t flags = irq_save();
+    int last = (--file->refcount == 0);
+    irq_restore(flags);
+
+    if (last) {
+        if (file->ops->release) {
+            file->ops->release(file);
+        }
+        file->ops = NULL;  // Slot free
+    }
+}
+
+void file_init(void) {
+    memset(file_pool, 0, sizeof(file_pool));
+    // The kernel keeps its own reference, so the console is never released
+    console_file = file_alloc(&console_ops, O_RDWR);
+}
+
+file_t* file_open(const char* path, uint32_t flags) {
+    if (!path) {
+        return NULL;
+    }
+
+    if (strncmp(path, "/dev/", 5) == 0) {
+        device_t* dev = device_find(path + 5);
+        if (!dev || !dev->ops || (dev->ops->open && dev->ops->open() != 0)) {
+            return NULL;
+        }
+        file_t* file = file_alloc(&device_file_ops, flags);
+        if (!file) {
+            if (dev->ops->close) {
+                dev->ops->close();
+            }
+            return NULL;
+        }
+        file->dev = dev;
+        return file;
+    }
+
+    while (*path == '/') {
+        path++;
+    }
+    uint32_t irq = irq_save();
+    int inode = ramfs_open(path, (int)flags);
+    irq_restore(irq);
+    if (inode <= 0) {
+        return NULL;
+    }
+    file_t* file = file_alloc(&ramfs_file_ops, flags);
+    if (!file) {
+        irq = irq_save();
+        ramfs_close((uint32_t)inode);
+        irq_restore(irq);
+        return NULL;
+    }
+    file->inode = (uint32_t)inode;
+    file->seekable = 1;
+    return file;
+}
+
+// Remove a ramfs file; devices cannot be unlinked. Descriptors still
+// open on it keep working until closed.
+int file_unlink(const char* path) {
+    if (!path || strncmp(path, "/dev/", 5) == 0) {
+        return -1;
+    }
+    while (*path == '/') {
+        path++;
+    }
+    uint32_t flags = irq_save();
+    int result = ramfs_delete(path);
+    irq_restore(flags);
+    return result;
+}
+
+// New processes start with the console on 0, 1 and 2
+void fd_table_init(proc_shared_t* owner) {
+    memset(owner->fds, 0, sizeof(owner->fds));
+    for (int fd = 0; fd < 3 && console_file; fd++) {
+        file_get(console_file);
+        owner->fds[fd] = console_file;
+    }
+}
+
+// The last thread exited
+void fd_table_release(proc_shared_t* owner) {
+    for (int fd = 0; fd < MAX_FDS; fd++) {
+        fd_close(owner, fd);
+    }
+}
+
+// Lowest free descriptor; the table takes over the caller's reference
+int fd_install(proc_shared_t* owner, file_t* file) {
+    int result = -1;
+    uint32_t flags = irq_save();
+    for (int fd = 0; fd < MAX_FDS; fd++) {
+        if (!owner->fds[fd]) {
+            owner->fds[fd] = file;
+            result = fd;
+            break;
+        }
+    }
+    irq_restore(flags);
+    return result;
+}
+
+int fd_close(proc_shared_t* owner, int fd) {
+    if (!owner || fd < 0 || fd >= MAX_FDS) {
+        return -1;
+    }
+    uint32_t flags = irq_save();
+    file_t* file = owner->fds[fd];
+    owner->fds[fd] = NULL;
+    irq_restore(flags);
+
+    if (!file) {
+        return -1;
+    }
+    file_put(file);
+    return 0;
+}
+
+// A reference keeps the file alive even if another thread closes the
+// descriptor while this one sleeps in a read
+file_t* fd_get(proc_shared_t* owner, int fd) {
+    if (fd < 0 || fd >= MAX_FDS) {
+        return NULL;
+    }
+    uint32_t flags = irq_save();
+    // Kernel code running before the first process uses the console
+    file_t* file = owner ? owner->fds[fd] : (fd < 3 ? console_file : NULL);
+    if (file) {
+        file->refcount++;
+    }
+    irq_restore(flags);
+    return file;
+}
+
+static int may_read(const file_t* file) {
+    return (file->flags & 3) != O_WRONLY;
+}
+
+static int may_write(const file_t* file) {
+    return (file->flags & 3) != O_RDONLY;
+}
+
+// Move iovcnt buffers starting at offset, stopping at the first short
+// transfer as a loop of read()/write() calls would. Backends without a
+// read or write operation (epoll) refuse that direction.
+static int file_rw(file_t* file, const iovec_t* iov, uint32_t iovcnt, int write, uint32_t offset) {
+    if (!iov || iovcnt > IOV_MAX || (write ? !may_write(file) : !may_read(file))) {
+        return -1;
+    }
+    if (write ? !file->ops->write : !file->ops->read) {
+        return -1;
+    }
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < iovcnt; i++) {
+        if (!iov[i].iov_len) continue;
+        int n = write
+            ? file->ops->write(file, iov[i].iov_base, iov[i].iov_len, offset + total)
+            : file->ops->read(file, iov[i].iov_base, iov[i].iov_len, offset + total);
+        if (n < 0) {
+            return total ? (int)total : -1;
+        }
+        total += (uint32_t)n;
+        if ((uint32_t)n < iov[i].iov_len) {
+            break;
+        }
+    }
+    return (int)total;
+}
+
+// Transfer at the file position and advance it
+static int file_rw_pos(file_t* file, const iovec_t* iov, uint32_t iovcnt, int write) {
+    if (!file->seekable) {
+        return file_rw(file, iov, iovcnt, write, 0);
+    }
+
+    // Seekable backends never sleep, so with interrupts off the transfer
+    // and the position update are atomic against other threads
+    uint32_t flags = irq_save();
+    int n = file_rw(file, iov, iovcnt, write, file->offset);
+    if (n > 0) {
+        file->offset += (uint32_t)n;
+    }
+    irq_restore(flags);
+    return n;
+}
+
+int file_read(file_t* file, void* buffer, uint32_t count) {
+    iovec_t iov = { buffer, count };
+    return file ? file_rw_pos(file, &iov, 1, 0) : -1;
+}
+
+int file_write(file_t* file, const void* buffer, uint32_t count) {
+    iovec_t iov = { (void*)buffer, count };
+    return file ? file_rw_pos(file, &iov, 1, 1) : -1;
+}
+
+int file_readv(file_t* file, const iovec_t* iov, uint32_t iovcnt) {
+    return file ? file_rw_pos(file, iov, iovcnt, 0) : -1;
+}
+
+int file_writev(file_t* file, const iovec_t* iov, uint32_t iovcnt) {
+    return file ? file_rw_pos(file, iov, iovcnt, 1) : -1;
+}
+
+// Positional I/O needs no lock: the shared position is not involved
+int file_pread(file_t* file, void* buffer, uint32_t count, uint32_t offset) {
+    if (!file || !file->seekable) {
+        return -1;
+    }
+    iovec_t iov = { buffer, count };
+    return file_rw(file, &iov, 1, 0, offset);
+}
+
+int file_pwrite(file_t* file, const void* buffer, uint32_t count, uint32_t offset) {
+    if (!file || !file->seekable) {
+        return -1;
+    }
+    iovec_t iov = { (void*)buffer, count };
+    return file_rw(file, &iov, 1, 1, offset);
+}
+
+int file_seek(file_t* file, uint32_t position) {
+    if (!file || !file->seekable) {
+        return -1;
+    }
+    uint32_t flags = irq_save();
+    file->offset = position;
+    irq_restore(flags);
+    return (int)position;
+}
+
+// Only ramfs files have a size to change
+int file_truncate(file_t* file, uint32_t size) {
+    if (!file || file->ops != &ramfs_file_ops || !may_write(file)) {
+        return -1;
+    }
+    uint32_t flags = irq_save();
+    int result = ramfs_truncate(file->inode, size);
+    irq_restore(flags);
+    return result;
+}
+
+uint32_t file_poll(file_t* file) {
+    if (!file) {
+        return POLLERR;
+    }
+    if (file->ops->poll) {
+        return file->ops->poll(file);
+    }
+    return (may_read(file) ? POLLIN : 0) | (may_write(file) ? POLLOUT : 0);
+}
@@ -0,0 +1,61 @@
+#include "../include/file.h"
+#include "../include/filesystem.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "FILE Test: "
+#include "test_output.h"
+
+// Descriptor table and vectored/positional I/O test process
+void file_test_process(void) {
+    char msg[] = "FILE Test: Vectored I/O test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    // Gather three buffers into one write on the console
+    iovec_t out[3] = {
+        { "FILE Test: ", 11 },
+        { "writev to console", 17 },
+        { "\n", 1 },
+    };
+    report(syscall(SYS_WRITEV, 1, (uint32_t)out, 3) == 29, "writev console");
+
+    int fd = (int)syscall(SYS_OPEN, (uint32_t)"/iov_test.txt", O_RDWR | O_CREAT, 0);
+    report(fd >= 3, "open");
+    if (fd >= 3) {
+        iovec_t parts[3] = {
+            { "alpha-", 6 },
+            { "beta-", 5 },
+            { "gamma", 5 },
+        };
+        report(syscall(SYS_WRITEV, fd, (uint32_t)parts, 3) == 16, "writev file");
+
+        // Positional reads leave the file position at the end
+        char buf[8];
+        memset(buf, 0, sizeof(buf));
+        int n = (int)syscall4(SYS_PREAD, fd, (uint32_t)buf, 4, 6);
+        report(n == 4 && memcmp(buf, "beta", 4) == 0, "pread");
+        report(syscall(SYS_READ, fd, (uint32_t)buf, sizeof(buf)) == 0, "position kept");
+
+        n = (int)syscall4(SYS_PWRITE, fd, (uint32_t)"BETA", 4, 6);
+        report(n == 4, "pwrite");
+
+        // Scatter the file back into two buffers
+        char head[6], tail[10];
+        iovec_t in[2] = { { head, sizeof(head) }, { tail, sizeof(tail) } };
+        syscall(SYS_SEEK, fd, 0, 0);
+        n = (int)syscall(SYS_READV, fd, (uint32_t)in, 2);
+        report(n == 16 && memcmp(head, "alpha-", 6) == 0 &&
+               memcmp(tail, "BETA-gamma", 10) == 0, "readv");
+
+        report(syscall(SYS_CLOSE, fd, 0, 0) == SYS_SUCCESS, "close");
+        report(syscall(SYS_READ, fd, (uint32_t)buf, 1) == (uint32_t)SYS_ERROR, "closed fd rejected");
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
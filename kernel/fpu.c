@@ -0,0 +1,171 @@
+#include "fpu.h"
+#include "process.h"
+#include "cpu.h"
+#include "../include/idt.h"
+
+#define CR0_MP  (1u << 1)   // Monitor coprocessor: WAIT/FWAIT honour TS
+#define CR0_EM  (1u << 2)   // Emulate FPU: must be clear
+#define CR0_TS  (1u << 3)   // Task switched: next FPU use raises #NM
+#define CR0_NE  (1u << 5)   // Native x87 error reporting (#MF)
+
+#define CR4_OSFXSR     (1u << 9)   // FXSAVE/FXRSTOR and SSE enabled
+#define CR4_OSXMMEXCPT (1u << 10)  // Unmasked SSE exceptions raise #XM
+
+#define CPUID_EDX_FXSR (1u << 24)
+#define CPUID_EDX_SSE  (1u << 25)
+
+#define MXCSR_DEFAULT 0x1F80       // All SSE exceptions masked
+
+// Task whose state is live in the FPU registers, NULL if none
+static struct process* fpu_owner = NULL;
+static int fpu_has_fxsr = 0;
+static int fpu_has_sse = 0;
+static int ts_set = 0;
+static uint32_t fpu_restores = 0;
+
+static inline uint32_t read_cr0(void) {
+    uint32_t cr0;
+    asm volatile ("mov %%cr0, %0" : "=r"(cr0));
+    return cr0;
+}
+
+static inline void write_cr0(uint32_t cr0) {
+    asm volatile ("mov %0, %%cr0" : : "r"(cr0) : "memory");
+}
+
+static inline void fpu_set_ts(void) {
+    write_cr0(read_cr0() | CR0_TS);
+    ts_set = 1;
+}
+
+static inline void fpu_clear_ts(void) {
+    asm volatile ("clts" : : : "memory");
+    ts_set = 0;
+}
+
+static void fpu_save(uint8_t* area) {
+    if (fpu_has_fxsr) {
+        asm volatile ("fxsave (%0)" : : "r"(area) : "memory");
+    } else {
+        asm volatile ("fnsave (%0); fwait" : : "r"(area) : "memory");
+    }
+}
+
+static void fpu_restore(const uint8_t* area) {
+    if (fpu_has_fxsr) {
+        asm volatile ("fxrstor (%0)" : : "r"(area) : "memory");
+    } else {
+        asm volatile ("frstor (%0)" : : "r"(area) : "memory");
+    }
+}
+
+// Give a task that has never used the FPU a clean register file
+static void fpu_load_initial(void) {
+    asm volatile ("fninit" : : : "memory");
+    if (fpu_has_sse) {
+        uint32_t mxcsr = MXCSR_DEFAULT;
+        asm volatile ("ldmxcsr %0" : : "m"(mxcsr));
+    }
+}
+
+// #NM: the current task touched the FPU with CR0.TS set
+static void fpu_nm_handler(struct regs* r) {
+    (void)r;
+    process_t* self = process_get_current();
+
+    fpu_clear_ts();
+    if (fpu_owner == self) {
+        return;
+    }
+
+    if (fpu_owner) {
+        fpu_save(fpu_owner->fpu_state);
+    }
+    if (self && self->fpu_used) {
+        fpu_restore(self->fpu_state);
+    } else {
+        fpu_load_initial();
+        if (self) {
+            self->fpu_used = 1;
+        }
+    }
+    fpu_owner = self;
+    fpu_restores++;
+}
+
+void fpu_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    fpu_has_fxsr = (edx & CPUID_EDX_FXSR) != 0;
+    fpu_has_sse = fpu_has_fxsr && (edx & CPUID_EDX_SSE);
+
+    uint32_t cr0 = read_cr0();
+    cr0 &= ~(CR0_EM | CR0_TS);
+    cr0 |= CR0_MP | CR0_NE;
+    write_cr0(cr0);
+
+    if (fpu_has_fxsr) {
+        uint32_t cr4;
+        asm volatile ("mov %%cr4, %0" : "=r"(cr4));
+        cr4 |= CR4_OSFXSR;
+        if (fpu_has_sse) {
+            cr4 |= CR4_OSXMMEXCPT;
+        }
+        asm volatile ("mov %0, %%cr4" : : "r"(cr4));
+    }
+
+    fpu_load_initial();
+    register_interrupt_handler(7, fpu_nm_handler);
+
+    // Nobody owns the FPU yet: trap on first use
+    fpu_set_ts();
+}
+
+void fpu_switch(struct process* next) {
+    if (next == fpu_owner) {
+        // Its state is still in the registers; no trap needed
+        if (ts_set) {
+            fpu_clear_ts();
+        }
+    } else if (!ts_set) {
+        fpu_set_ts();
+    }
+}
+
+void fpu_release(struct process* task) {
+    if (task) {
+        task->fpu_used = 0;
+    }
+    if (fpu_owner == task) {
+        fpu_owner = NULL;
+    }
+}
+
+uint32_t fpu_get_restore_count(void) {
+    return fpu_restores;
+}
+
+uint32_t fpu_save_restore_cycles(void) {
+    static uint8_t scratch[FPU_STATE_SIZE] __attribute__((aligned(16)));
+    const uint32_t rounds = 64;
+
+    uint32_t flags = irq_save();
+    int was_set = ts_set;
+    fpu_clear_ts();
+
+    // Saving and reloading the same image leaves the live state intact
+    uint64_t start = rdtsc();
+    for (uint32_t i = 0; i < rounds; i++) {
+        fpu_save(scratch);
+        fpu_restore(scratch);
+    }
+    uint64_t elapsed = rdtsc() - start;
+
+    if (was_set) {
+        fpu_set_ts();
+    }
+    irq_restore(flags);
+
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    return cycles / rounds;
+}
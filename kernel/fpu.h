@@ -0,0 +1,28 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+
+// FXSAVE area; FNSAVE needs only 108 bytes of it
+#define FPU_STATE_SIZE 512
+
+struct process;
+
+// Detect FXSR/SSE, enable the FPU and install the #NM handler
+void fpu_init(void);
+
+// Called by the scheduler before switching to next. The FPU registers
+// are left as they are and CR0.TS is set; the first FPU/SSE instruction
+// next executes traps to #NM, which does the actual save/restore.
+void fpu_switch(struct process* next);
+
+// Drop ownership of a task's live FPU state (the task is going away)
+void fpu_release(struct process* task);
+
+// Number of lazy FPU state restores performed by the #NM handler
+uint32_t fpu_get_restore_count(void);
+
+// Cycles of one FXSAVE+FXRSTOR pair: what an eager switch would add
+uint32_t fpu_save_restore_cycles(void);
+
+#endif // FPU_H
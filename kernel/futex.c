@@ -0,0 +1,148 @@
+#include "../include/futex.h"
+#include "../include/shm.h"
+#include "../include/spinlock.h"
+#include "../include/wait.h"
+#include "process.h"
+#include "string.h"
+
+// A futex word: the address space and virtual address, or for a word in
+// a shared memory segment no address space and the physical address
+typedef struct {
+    proc_shared_t* mm;
+    uint32_t addr;
+} futex_key_t;
+
+// One sleeper; lives on the sleeper's own stack
+typedef struct futex_waiter {
+    futex_key_t key;
+    process_t* task;
+    uint8_t woken;
+    struct futex_waiter* next;
+} futex_waiter_t;
+
+typedef struct {
+    spinlock_t lock;
+    futex_waiter_t* head;
+} futex_bucket_t;
+
+static futex_bucket_t futex_table[FUTEX_HASH_SIZE];
+static futex_stats_t futex_stats;
+
+static futex_key_t futex_key(proc_shared_t* mm, volatile uint32_t* uaddr) {
+    futex_key_t key = { mm, (uint32_t)uaddr };
+    uint32_t phys = shm_phys_addr((uint32_t)uaddr);
+    if (phys) {
+        key.mm = NULL;
+        key.addr = phys;
+    }
+    return key;
+}
+
+static futex_bucket_t* futex_hash(futex_key_t k) {
+    uint32_t key = (k.addr >> 2) ^ (uint32_t)k.mm;
+    key ^= key >> 16;
+    key *= 0x45D9F3Bu;
+    key ^= key >> 16;
+    return &futex_table[key & (FUTEX_HASH_SIZE - 1)];
+}
+
+void futex_init(void) {
+    for (int i = 0; i < FUTEX_HASH_SIZE; i++) {
+        spin_lock_init(&futex_table[i].lock, "futex_bucket");
+        futex_table[i].head = NULL;
+    }
+    memset(&futex_stats, 0, sizeof(futex_stats));
+}
+
+int futex_wait(volatile uint32_t* uaddr, uint32_t val) {
+    process_t* self = process_get_current();
+    if (!self || !uaddr || ((uint32_t)uaddr & 3)) {
+        return -1;
+    }
+
+    futex_waiter_t waiter;
+    waiter.key = futex_key(self->shared, uaddr);
+    waiter.task = self;
+    waiter.woken = 0;
+
+    futex_bucket_t* bucket = futex_hash(waiter.key);
+    uint32_t flags = irq_save();
+    spin_lock(&bucket->lock);
+
+    // Checked under the bucket lock, so a FUTEX_WAKE issued after the
+    // waker changed *uaddr cannot slip in between check and sleep
+    if (*uaddr != val) {
+        futex_stats.wait_mismatch++;
+        spin_unlock_no_resched(&bucket->lock);
+        irq_restore(flags);
+        return -1;
+    }
+
+    // Append, so sleepers on one address are woken in FIFO order
+    futex_waiter_t** tail = &bucket->head;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    waiter.next = NULL;
+    *tail = &waiter;
+    process_set_state(self, PROCESS_BLOCKED);
+    futex_stats.waits++;
+    spin_unlock_no_resched(&bucket->lock);
+
+    wait_block();
+
+    spin_lock(&bucket->lock);
+    if (!waiter.woken) {
+        futex_waiter_t** link = &bucket->head;
+        while (*link && *link != &waiter) {
+            link = &(*link)->next;
+        }
+        if (*link) {
+            *link = waiter.next;
+        }
+    }
+    spin_unlock_no_resched(&bucket->lock);
+
+    process_set_state(self, PROCESS_RUNNING);
+    irq_restore(flags);
+    return 0;
+}
+
+int futex_wake(volatile uint32_t* uaddr, uint32_t count) {
+    process_t* self = process_get_current();
+    if (!self || !uaddr || ((uint32_t)uaddr & 3)) {
+        return -1;
+    }
+
+    int woken = 0;
+    futex_key_t key = futex_key(self->shared, uaddr);
+    futex_bucket_t* bucket = futex_hash(key);
+    uint32_t flags = spin_lock_irqsave(&bucket->lock);
+    futex_stats.wakes++;
+
+    futex_waiter_t** link = &bucket->head;
+    while (*link && (uint32_t)woken < count) {
+        futex_waiter_t* w = *link;
+        if (w->key.addr != key.addr || w->key.mm != key.mm) {
+            link = &w->next;
+            continue;
+        }
+        *link = w->next;
+        w->next = NULL;
+        w->woken = 1;
+        if (w->task->state == PROCESS_BLOCKED) {
+            process_set_state(w->task, PROCESS_READY);
+        }
+        woken++;
+    }
+    futex_stats.woken += woken;
+
+    spin_unlock_irqrestore(&bucket->lock, flags);
+    return woken;
+}
+
+void futex_get_stats(futex_stats_t* stats) {
+    if (stats) {
+        memcpy(stats, &futex_stats, sizeof(futex_stats_t));
+    }
+}
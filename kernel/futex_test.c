@@ -0,0 +1,109 @@
+#include "../include/ulock.h"
+#include "../include/futex.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+#include "cpu.h"
+#include "test_output.h"
+
+#define BENCH_THREADS 3
+#define BENCH_ITERATIONS 200
+#define UNCONTENDED_ROUNDS 10000
+
+static umutex_t bench_mutex = UMUTEX_INITIALIZER;
+static volatile uint32_t bench_counter = 0;
+
+static umutex_t cond_mutex = UMUTEX_INITIALIZER;
+static ucond_t cond = UCOND_INITIALIZER;
+static volatile int cond_ready = 0;
+
+// Contention benchmark worker: yields inside the critical section so
+// the other workers find the mutex held
+static void bench_worker(void* arg) {
+    (void)arg;
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        umutex_lock(&bench_mutex);
+        uint32_t v = bench_counter;
+        syscall(SYS_YIELD, 0, 0, 0);
+        bench_counter = v + 1;
+        umutex_unlock(&bench_mutex);
+    }
+    syscall(SYS_THREAD_EXIT, 0, 0, 0);
+}
+
+static void cond_waiter(void* arg) {
+    (void)arg;
+    umutex_lock(&cond_mutex);
+    while (!cond_ready) {
+        ucond_wait(&cond, &cond_mutex);
+    }
+    umutex_unlock(&cond_mutex);
+    syscall(SYS_THREAD_EXIT, 1, 0, 0);
+}
+
+// Futex and user-space lock test process
+void futex_test_process(void) {
+    char msg[] = "FUTEX Test: Futex test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    // Uncontended lock/unlock must never enter the kernel
+    futex_stats_t before, after;
+    futex_get_stats(&before);
+    uint64_t start = rdtsc();
+    for (int i = 0; i < UNCONTENDED_ROUNDS; i++) {
+        umutex_lock(&bench_mutex);
+        umutex_unlock(&bench_mutex);
+    }
+    uint64_t elapsed = rdtsc() - start;
+    futex_get_stats(&after);
+    if (after.waits == before.waits && after.wakes == before.wakes) {
+        char fast_msg[] = "FUTEX Test: Uncontended path OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)fast_msg, sizeof(fast_msg) - 1);
+    }
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    test_print_value("FUTEX Test: Uncontended cycles/op: ", cycles / UNCONTENDED_ROUNDS);
+
+    // Contended: several threads hammer one mutex
+    int tids[BENCH_THREADS];
+    futex_get_stats(&before);
+    start = rdtsc();
+    for (int i = 0; i < BENCH_THREADS; i++) {
+        tids[i] = (int)syscall(SYS_THREAD_CREATE, (uint32_t)bench_worker, 0, 0);
+    }
+    for (int i = 0; i < BENCH_THREADS; i++) {
+        if (tids[i] >= 0) {
+            syscall(SYS_THREAD_JOIN, (uint32_t)tids[i], 0, 0);
+        }
+    }
+    elapsed = rdtsc() - start;
+    futex_get_stats(&after);
+    if (bench_counter == BENCH_THREADS * BENCH_ITERATIONS) {
+        char cont_msg[] = "FUTEX Test: Contended mutex OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)cont_msg, sizeof(cont_msg) - 1);
+    }
+    cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    test_print_value("FUTEX Test: Contended cycles/op: ", cycles / (BENCH_THREADS * BENCH_ITERATIONS));
+    test_print_value("FUTEX Test: Futex sleeps: ", after.waits - before.waits);
+
+    // Condition variable hand-off
+    int waiter = (int)syscall(SYS_THREAD_CREATE, (uint32_t)cond_waiter, 0, 0);
+    syscall(SYS_YIELD, 0, 0, 0);
+    umutex_lock(&cond_mutex);
+    cond_ready = 1;
+    ucond_signal(&cond);
+    umutex_unlock(&cond_mutex);
+    int status = 0;
+    if (waiter >= 0 &&
+        syscall(SYS_THREAD_JOIN, (uint32_t)waiter, (uint32_t)&status, 0) == SYS_SUCCESS &&
+        status == 1) {
+        char cond_msg[] = "FUTEX Test: Condition variable OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)cond_msg, sizeof(cond_msg) - 1);
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
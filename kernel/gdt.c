@@ -0,0 +1,83 @@
+#include "../include/gdt.h"
+#include "cpu.h"
+
+#define GDT_ENTRIES 7
+#define GDT_TLS_INDEX 5
+#define GDT_TSS_INDEX 6
+
+// GDT entry structure
+struct gdt_entry {
+    uint16_t limit_lo;
+    uint16_t base_lo;
+    uint8_t  base_mid;
+    uint8_t  access;
+    uint8_t  granularity;  // Flags in the high nibble, limit 19:16 below
+    uint8_t  base_hi;
+} __attribute__((packed));
+
+// GDT pointer structure
+struct gdt_ptr {
+    uint16_t limit;
+    uint32_t base;
+} __attribute__((packed));
+
+static struct gdt_entry gdt[GDT_ENTRIES];
+static struct gdt_ptr gdtp;
+
+// Function to set a descriptor in the GDT
+static void gdt_set_gate(int num, uint32_t base, uint32_t limit, uint8_t access, uint8_t flags) {
+    gdt[num].base_lo = base & 0xFFFF;
+    gdt[num].base_mid = (base >> 16) & 0xFF;
+    gdt[num].base_hi = (base >> 24) & 0xFF;
+    gdt[num].limit_lo = limit & 0xFFFF;
+    gdt[num].granularity = (uint8_t)((flags & 0xF0) | ((limit >> 16) & 0x0F));
+    gdt[num].access = access;
+}
+
+void gdt_init(void) {
+    gdtp.limit = sizeof(gdt) - 1;
+    gdtp.base = (uint32_t)&gdt;
+
+    gdt_set_gate(0, 0, 0, 0, 0);                 // Null segment
+    gdt_set_gate(1, 0, 0xFFFFF, 0x9A, 0xC0);     // Kernel code
+    gdt_set_gate(2, 0, 0xFFFFF, 0x92, 0xC0);     // Kernel data
+    gdt_set_gate(3, 0, 0xFFFFF, 0xFA, 0xC0);     // User code
+    gdt_set_gate(4, 0, 0xFFFFF, 0xF2, 0xC0);     // User data
+    gdt_set_gate(GDT_TLS_INDEX, 0, 0xFFFFF, 0xF2, 0xC0);  // TLS, flat until a thread sets it
+
+    asm volatile (
+        "lgdt %0\n"
+        "ljmp %1, $1f\n"
+        "1:\n"
+        "movw %2, %%ax\n"
+        "movw %%ax, %%ds\n"
+        "movw %%ax, %%es\n"
+        "movw %%ax, %%fs\n"
+        "movw %%ax, %%ss\n"
+        "movw %3, %%ax\n"
+        "movw %%ax, %%gs\n"
+        : : "m"(gdtp), "i"(GDT_KERNEL_CS), "i"(GDT_KERNEL_DS), "i"(GDT_TLS_SEL)
+        : "eax", "memory");
+}
+
+void gdt_set_tls(uint32_t base, uint32_t limit) {
+    uint32_t flags = irq_save();
+    if (limit == 0) {
+        gdt_set_gate(GDT_TLS_INDEX, 0, 0xFFFFF, 0xF2, 0xC0);
+    } else if (limit > 0xFFFFF) {
+        // Too large for byte granularity: round up to 4KB pages
+        gdt_set_gate(GDT_TLS_INDEX, base, ((limit + 0xFFF) >> 12) - 1, 0xF2, 0xC0);
+    } else {
+        gdt_set_gate(GDT_TLS_INDEX, base, limit - 1, 0xF2, 0x40);
+    }
+
+    // The descriptor is only re-read when the selector is loaded
+    asm volatile ("movw %0, %%gs" : : "r"((uint16_t)GDT_TLS_SEL) : "memory");
+    irq_restore(flags);
+}
+
+void gdt_set_tss(uint32_t base, uint32_t limit) {
+    // Present, DPL 0, 32-bit available TSS; byte granularity
+    gdt_set_gate(GDT_TSS_INDEX, base, limit, 0x89, 0x00);
+    asm volatile ("ltr %0" : : "r"((uint16_t)GDT_TSS_SEL));
+}
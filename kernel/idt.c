@@ -3,6 +3,7 @@
 #include "../include/idt.h"
 #include "io.h"
 #include "../drivers/vga.h"
+#include "../include/softirq.h"
 
 // PIC I/O Ports
 #define PIC1_CMD    0x20
@@ -40,6 +41,7 @@ extern void isr16(); extern void isr17(); extern void isr18(); extern void isr19
 extern void isr20(); extern void isr21(); extern void isr22(); extern void isr23();
 extern void isr24(); extern void isr25(); extern void isr26(); extern void isr27();
 extern void isr28(); extern void isr29(); extern void isr30(); extern void isr31();
+extern void isr128();
 
 extern void irq0(); extern void irq1(); extern void irq2(); extern void irq3();
 extern void irq4(); extern void irq5(); extern void irq6(); extern void irq7();
@@ -74,6 +76,12 @@ void pic_remap(void) {
 
 // Generic C-level interrupt handler
 void fault_handler(struct regs *r) {
+    // Recoverable exceptions (e.g. #NM for lazy FPU switching)
+    if (interrupt_handlers[r->int_no] != 0) {
+        interrupt_handlers[r->int_no](r);
+        return;
+    }
+
     vga_set_color(VGA_COLOR_WHITE, VGA_COLOR_RED);
     vga_print("\n*** CPU EXCEPTION: ");
     char buf[16];
@@ -83,8 +91,11 @@ void fault_handler(struct regs *r) {
     asm volatile ("cli; hlt");
 }
 
-// Generic C-level IRQ handler
+// Generic C-level IRQ handler. Top halves registered here should only
+// acknowledge the device and defer the rest via softirqs or queue_work().
 void irq_handler(struct regs *r) {
+    irq_enter();
+
     // Send EOI to the PICs
     if (r->int_no >= 40) {
         outb(PIC2_CMD, 0x20);
@@ -95,6 +106,9 @@ void irq_handler(struct regs *r) {
     if (interrupt_handlers[r->int_no] != 0) {
         interrupt_handlers[r->int_no](r);
     }
+
+    // Run deferred bottom halves and any pending reschedule
+    irq_exit();
 }
 
 // Register an interrupt handler
@@ -160,6 +174,9 @@ void idt_init() {
     idt_set_gate(30, (uint32_t)isr30, 0x08, 0x8E);
     idt_set_gate(31, (uint32_t)isr31, 0x08, 0x8E);
 
+    // System call gate, callable from ring 3
+    idt_set_gate(0x80, (uint32_t)isr128, 0x08, 0xEE);
+
     // Set up all 16 IRQs (hardware interrupts 32-47)
     idt_set_gate(32, (uint32_t)irq0, 0x08, 0x8E);
     idt_set_gate(33, (uint32_t)irq1, 0x08, 0x8E);
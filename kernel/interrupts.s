@@ -114,6 +114,9 @@ ISR_NOERRCODE 29
 ISR_NOERRCODE 30
 ISR_NOERRCODE 31
 
+/* System call gate (int $0x80) */
+ISR_NOERRCODE 128
+
 IRQ 0,  32
 IRQ 1,  33
 IRQ 2,  34
@@ -1,70 +1,612 @@
 #include "../include/ipc.h"
+#include "../include/spinlock.h"
+#include "../include/poll.h"
+#include "../include/memory.h"
+#include "../drivers/timer.h"
 #include "process.h"
+#include "cpu.h"
+#include "log.h"
 #include "string.h"
+#include <stddef.h>
 
-static ipc_msg_t message_queue[MAX_MESSAGES];
-static int queue_head = 0;
-static int queue_tail = 0;
-static int queue_count = 0;
+// One mailbox per process at most, so the pool matches the process table
+typedef struct ipc_mailbox {
+    proc_shared_t* owner;        // NULL: slot free
+    uint32_t capacity;
+    uint32_t head;               // Oldest message
+    uint32_t count;
+    ipc_mailbox_stats_t stats;
+    wait_queue_t recv_wait;      // Receivers sleeping on an empty mailbox
+    ipc_msg_t slots[IPC_MAILBOX_MAX];
+} ipc_mailbox_t;
+
+static ipc_mailbox_t mailbox_pool[MAX_PROCESSES];
+static spinlock_t ipc_lock;  // Protects the pool and every mailbox
+
+// Rendezvous state of each thread, indexed by thread id. Only touched
+// with interrupts disabled.
+#define RV_IDLE      0
+#define RV_RECEIVING 1               // In ipc_reply_wait(), waiting for a call
+#define RV_CALLING   2               // In ipc_call(), waiting for the reply
+
+typedef struct {
+    uint8_t state;
+    ipc_short_t* buf;                // Where the peer deposits its message
+    uint32_t peer;                   // Caller served, or server called
+    int result;                      // ipc_call() outcome
+    wait_queue_t callers;            // Callers waiting for us to receive
+} rendezvous_t;
+
+static rendezvous_t rendezvous[MAX_PROCESSES];
+static ipc_call_stats_t call_stats;
+
+// Page buffers and the window pages they occupy. Protected by ipc_lock.
+typedef struct {
+    proc_shared_t* owner;            // NULL: slot free
+    uint32_t addr;
+    uint32_t pages;
+} ipc_buffer_t;
+
+#define IPC_BUFFER_FLAGS (PAGE_PRESENT | PAGE_WRITE | PAGE_USER)
+
+static ipc_buffer_t buffer_pool[IPC_MAX_BUFFERS];
+static vm_window_t ipc_window;
+
+static uint32_t slot_index(const ipc_mailbox_t* mb, uint32_t i) {
+    uint32_t index = mb->head + i;
+    return (index >= mb->capacity) ? index - mb->capacity : index;
+}
+
+// Called with ipc_lock held
+static ipc_mailbox_t* mailbox_alloc_locked(proc_shared_t* owner, uint32_t capacity) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        ipc_mailbox_t* mb = &mailbox_pool[i];
+        if (!mb->owner) {
+            mb->owner = owner;
+            mb->capacity = capacity;
+            mb->head = 0;
+            mb->count = 0;
+            memset(&mb->stats, 0, sizeof(mb->stats));
+            wait_queue_init(&mb->recv_wait, "ipc_recv");
+            owner->mailbox = mb;
+            return mb;
+        }
+    }
+    return NULL;
+}
+
+// The mailbox of owner, created at the default size on first use.
+// Called with ipc_lock held.
+static ipc_mailbox_t* mailbox_get_locked(proc_shared_t* owner) {
+    if (!owner) {
+        return NULL;
+    }
+    return owner->mailbox ? owner->mailbox : mailbox_alloc_locked(owner, IPC_MAILBOX_DEFAULT);
+}
+
+static proc_shared_t* current_owner(void) {
+    process_t* current = process_get_current();
+    return current ? current->shared : NULL;
+}
+
+// Readiness source for epoll: a message is queued for the caller
+static uint32_t ipc_poll(void) {
+    proc_shared_t* owner = current_owner();
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    uint32_t ready = (owner && owner->mailbox && owner->mailbox->count) ? POLLIN : 0;
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return ready;
+}
 
 void ipc_init(void) {
-    queue_head = 0;
-    queue_tail = 0;
-    queue_count = 0;
+    spin_lock_init(&ipc_lock, "ipc");
+    memset(mailbox_pool, 0, sizeof(mailbox_pool));
+    memset(rendezvous, 0, sizeof(rendezvous));
+    memset(&call_stats, 0, sizeof(call_stats));
+    memset(buffer_pool, 0, sizeof(buffer_pool));
+    vm_window_init(&ipc_window, IPC_WINDOW_BASE);
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        wait_queue_init(&rendezvous[i].callers, "ipc_call");
+    }
+    poll_register_source(POLL_SRC_IPC, ipc_poll);
 }
 
-int ipc_send(uint32_t receiver, uint8_t type, void* data, uint16_t len) {
-    if (queue_count >= MAX_MESSAGES) {
+int ipc_mailbox_create(proc_shared_t* owner, uint32_t capacity) {
+    if (!owner || capacity == 0 || capacity > IPC_MAILBOX_MAX) {
         return -1;
     }
-    
-    if (len > MAX_MSG_SIZE) {
-        return -2;
+
+    int result = -1;
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = owner->mailbox;
+    if (!mb) {
+        result = mailbox_alloc_locked(owner, capacity) ? 0 : -1;
+    } else if (mb->count == 0) {
+        mb->capacity = capacity;
+        mb->head = 0;
+        result = 0;
+    }
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return result;
+}
+
+// Buffer of owner starting at addr. Called with ipc_lock held.
+static ipc_buffer_t* buffer_find_locked(proc_shared_t* owner, uint32_t addr) {
+    if (!owner || !addr) {
+        return NULL;
+    }
+    for (int i = 0; i < IPC_MAX_BUFFERS; i++) {
+        if (buffer_pool[i].owner == owner && buffer_pool[i].addr == addr) {
+            return &buffer_pool[i];
+        }
+    }
+    return NULL;
+}
+
+// Unmap the pages and give the frames back. Called with ipc_lock held.
+static void buffer_free_locked(ipc_buffer_t* buf) {
+    for (uint32_t i = 0; i < buf->pages; i++) {
+        uint32_t va = buf->addr + i * PAGE_SIZE;
+        uint32_t phys = get_phys_addr(va);
+        unmap_page(va);
+        free_page(phys);
+    }
+    vm_window_free(&ipc_window, buf->addr, buf->pages);
+    buf->owner = NULL;
+}
+
+// The owning process is gone; queued messages and page buffers are discarded
+void ipc_mailbox_release(proc_shared_t* owner) {
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = owner->mailbox;
+    if (mb) {
+        owner->mailbox = NULL;
+        mb->owner = NULL;
     }
-    
-    ipc_msg_t* msg = &message_queue[queue_tail];
-    msg->sender = process_get_current()->pid;
+    for (int i = 0; i < IPC_MAX_BUFFERS; i++) {
+        if (buffer_pool[i].owner == owner) {
+            buffer_free_locked(&buffer_pool[i]);
+        }
+    }
+    spin_unlock_irqrestore(&ipc_lock, flags);
+}
+
+// Queue a message on mb, which must have room. Only the payload actually
+// sent is copied. Called with ipc_lock held.
+static void mailbox_post_locked(ipc_mailbox_t* mb, uint32_t receiver, uint8_t type,
+                                uint8_t msg_flags, const void* data, uint16_t len) {
+    process_t* current = process_get_current();
+    ipc_msg_t* msg = &mb->slots[slot_index(mb, mb->count)];
+    msg->sender = current ? (uint32_t)current->tgid : 0;
     msg->receiver = receiver;
     msg->type = type;
+    msg->flags = msg_flags;
     msg->length = len;
-    
-    if (data && len > 0) {
+    if (len > 0) {
         memcpy(msg->data, data, len);
     }
-    
-    queue_tail = (queue_tail + 1) % MAX_MESSAGES;
-    queue_count++;
-    
+
+    mb->count++;
+    mb->stats.sent++;
+    if (mb->count > mb->stats.max_depth) {
+        mb->stats.max_depth = mb->count;
+    }
+}
+
+// Mailbox of a live receiver with room for one more message, or NULL
+// with the drop counted. Called with ipc_lock held.
+static ipc_mailbox_t* mailbox_reserve_locked(process_t* target) {
+    ipc_mailbox_t* mb = mailbox_get_locked(target->shared);
+    if (!mb || mb->count == mb->capacity) {
+        if (mb) {
+            mb->stats.dropped++;
+        }
+        return NULL;
+    }
+    return mb;
+}
+
+int ipc_send(uint32_t receiver, uint8_t type, void* data, uint16_t len) {
+    if (len > MAX_MSG_SIZE || (len > 0 && !data)) {
+        return -2;
+    }
+
+    process_t* target = process_get((int)receiver);
+    if (!target || target->state == PROCESS_EMPTY || target->state == PROCESS_ZOMBIE) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = mailbox_reserve_locked(target);
+    if (!mb) {
+        spin_unlock_irqrestore(&ipc_lock, flags);
+        return -1;
+    }
+    mailbox_post_locked(mb, receiver, type, 0, data, len);
+    spin_unlock_irqrestore(&ipc_lock, flags);
+
+    wake_up(&mb->recv_wait);
+    poll_notify();
+    return 0;
+}
+
+void* ipc_buffer_alloc(proc_shared_t* owner, uint32_t pages) {
+    if (!owner || pages == 0 || pages > IPC_BUFFER_MAX_PAGES) {
+        return NULL;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_buffer_t* buf = NULL;
+    for (int i = 0; i < IPC_MAX_BUFFERS; i++) {
+        if (!buffer_pool[i].owner) {
+            buf = &buffer_pool[i];
+            break;
+        }
+    }
+    uint32_t base = buf ? vm_window_alloc(&ipc_window, pages) : 0;
+    if (!base) {
+        spin_unlock_irqrestore(&ipc_lock, flags);
+        return NULL;
+    }
+
+    buf->owner = owner;
+    buf->addr = base;
+    buf->pages = 0;
+    for (uint32_t i = 0; i < pages; i++) {
+        uint32_t phys = alloc_page();
+        if (!phys) {
+            // Undo the pages mapped so far and the rest of the run
+            vm_window_free(&ipc_window, base + i * PAGE_SIZE, pages - i);
+            buffer_free_locked(buf);
+            spin_unlock_irqrestore(&ipc_lock, flags);
+            return NULL;
+        }
+        map_page(base + i * PAGE_SIZE, phys, IPC_BUFFER_FLAGS);
+        buf->pages++;
+    }
+    void* addr = (void*)base;
+    memset(addr, 0, pages * PAGE_SIZE);
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return addr;
+}
+
+int ipc_buffer_free(proc_shared_t* owner, void* addr) {
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_buffer_t* buf = buffer_find_locked(owner, (uint32_t)addr);
+    if (buf) {
+        buffer_free_locked(buf);
+    }
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return buf ? 0 : -1;
+}
+
+int ipc_send_pages(uint32_t receiver, uint8_t type, void* addr) {
+    process_t* target = process_get((int)receiver);
+    if (!target || target->state == PROCESS_EMPTY || target->state == PROCESS_ZOMBIE) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_buffer_t* buf = buffer_find_locked(current_owner(), (uint32_t)addr);
+    ipc_mailbox_t* mb = buf ? mailbox_reserve_locked(target) : NULL;
+    uint32_t base = mb ? vm_window_alloc(&ipc_window, buf->pages) : 0;
+    if (!base) {
+        spin_unlock_irqrestore(&ipc_lock, flags);
+        return -1;
+    }
+
+    // Move the frames; the old run stops translating page by page
+    for (uint32_t i = 0; i < buf->pages; i++) {
+        uint32_t from = buf->addr + i * PAGE_SIZE;
+        uint32_t phys = get_phys_addr(from);
+        unmap_page(from);
+        map_page(base + i * PAGE_SIZE, phys, IPC_BUFFER_FLAGS);
+    }
+    vm_window_free(&ipc_window, buf->addr, buf->pages);
+    buf->addr = base;
+    buf->owner = target->shared;
+
+    ipc_page_grant_t grant = { buf->addr, buf->pages };
+    mailbox_post_locked(mb, receiver, type, IPC_MSG_PAGES, &grant, sizeof(grant));
+    mb->stats.pages_received += buf->pages;
+    spin_unlock_irqrestore(&ipc_lock, flags);
+
+    wake_up(&mb->recv_wait);
+    poll_notify();
+    return 0;
+}
+
+// Position of the oldest message from sender (any if 0), or -1
+static int mailbox_find(const ipc_mailbox_t* mb, uint32_t sender) {
+    if (sender == 0) {
+        return mb->count ? 0 : -1;
+    }
+    for (uint32_t i = 0; i < mb->count; i++) {
+        if (mb->slots[slot_index(mb, i)].sender == sender) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Dequeue into msg. The head is O(1); a sender filter that skips
+// messages closes the gap behind it. Called with ipc_lock held.
+static int mailbox_take_locked(ipc_mailbox_t* mb, uint32_t sender, ipc_msg_t* msg) {
+    int pos = mailbox_find(mb, sender);
+    if (pos < 0) {
+        return -1;
+    }
+
+    const ipc_msg_t* src = &mb->slots[slot_index(mb, (uint32_t)pos)];
+    memcpy(msg, src, offsetof(ipc_msg_t, data) + src->length);
+
+    for (uint32_t i = (uint32_t)pos; i > 0; i--) {
+        mb->slots[slot_index(mb, i)] = mb->slots[slot_index(mb, i - 1)];
+    }
+    mb->head = slot_index(mb, 1);
+    mb->count--;
+    mb->stats.received++;
     return 0;
 }
 
 int ipc_receive(uint32_t sender, ipc_msg_t* msg) {
-    if (queue_count == 0) {
-        return -1;
-    }
-    
-    uint32_t current_pid = process_get_current()->pid;
-    
-    for (int i = 0; i < queue_count; i++) {
-        int index = (queue_head + i) % MAX_MESSAGES;
-        ipc_msg_t* candidate = &message_queue[index];
-        
-        if (candidate->receiver == current_pid && 
-            (sender == 0 || candidate->sender == sender)) {
-            
-            memcpy(msg, candidate, sizeof(ipc_msg_t));
-            
-            // Remove message from queue
-            for (int j = i; j < queue_count - 1; j++) {
-                int src = (queue_head + j + 1) % MAX_MESSAGES;
-                int dst = (queue_head + j) % MAX_MESSAGES;
-                message_queue[dst] = message_queue[src];
+    if (!msg) {
+        return -1;
+    }
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = mailbox_get_locked(current_owner());
+    int result = mb ? mailbox_take_locked(mb, sender, msg) : -1;
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return result;
+}
+
+int ipc_receive_timeout(uint32_t sender, ipc_msg_t* msg, int32_t timeout_ms) {
+    if (!msg) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = mailbox_get_locked(current_owner());
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    if (!mb) {
+        return -1;
+    }
+
+    // The mailbox lives as long as its owner, which is the caller
+    int got;
+    if (timeout_ms < 0) {
+        wait_event(mb->recv_wait, ipc_receive(sender, msg) == 0);
+        got = 1;
+    } else {
+        got = wait_event_timeout(mb->recv_wait, ipc_receive(sender, msg) == 0,
+                                 timer_ms_to_ticks((uint32_t)timeout_ms));
+    }
+
+    if (!got) {
+        flags = spin_lock_irqsave(&ipc_lock);
+        mb->stats.timeouts++;
+        spin_unlock_irqrestore(&ipc_lock, flags);
+        return -1;
+    }
+    return 0;
+}
+
+int ipc_get_stats(uint32_t pid, ipc_mailbox_stats_t* stats) {
+    process_t* p = process_get((int)pid);
+    if (!stats || !p || p->state == PROCESS_EMPTY) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ipc_lock);
+    ipc_mailbox_t* mb = p->shared ? p->shared->mailbox : NULL;
+    if (mb) {
+        memcpy(stats, &mb->stats, sizeof(ipc_mailbox_stats_t));
+        stats->capacity = mb->capacity;
+        stats->depth = mb->count;
+    } else {
+        memset(stats, 0, sizeof(ipc_mailbox_stats_t));
+    }
+    spin_unlock_irqrestore(&ipc_lock, flags);
+    return 0;
+}
+
+static int thread_alive(const process_t* p) {
+    return p && p->state != PROCESS_EMPTY && p->state != PROCESS_ZOMBIE;
+}
+
+// Sleep until a peer makes us runnable, running next straight away if it
+// is blocked on us. Called with interrupts disabled.
+static void rendezvous_block(process_t* self, process_t* next) {
+    process_set_state(self, PROCESS_BLOCKED);
+    if (next && next->state == PROCESS_BLOCKED) {
+        call_stats.handoffs++;
+        process_handoff(next);
+    } else {
+        schedule();
+    }
+    while (self->state == PROCESS_BLOCKED) {
+        process_idle();
+    }
+}
+
+int ipc_call(uint32_t server, const ipc_short_t* request, ipc_short_t* reply) {
+    process_t* self = process_get_current();
+    process_t* target = process_get((int)server);
+    if (!self || !request || !reply || !thread_alive(target) || target == self) {
+        return -1;
+    }
+    rendezvous_t* srv = &rendezvous[server];
+    rendezvous_t* me = &rendezvous[self->pid];
+
+    uint32_t flags = irq_save();
+    call_stats.calls++;
+    if (srv->state != RV_RECEIVING) {
+        call_stats.queued++;
+        wait_event(srv->callers, srv->state == RV_RECEIVING || !thread_alive(target));
+    }
+    if (!thread_alive(target)) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    // The server is parked in ipc_reply_wait(): hand it the request
+    *srv->buf = *request;
+    srv->peer = (uint32_t)self->pid;
+    srv->state = RV_IDLE;
+
+    me->state = RV_CALLING;
+    me->buf = reply;
+    me->peer = server;
+    me->result = 0;
+    while (me->state == RV_CALLING) {
+        rendezvous_block(self, target);
+        target = NULL;
+    }
+
+    int result = me->result;
+    irq_restore(flags);
+    return result;
+}
+
+int ipc_reply_wait(uint32_t caller, const ipc_short_t* reply, ipc_short_t* request) {
+    process_t* self = process_get_current();
+    if (!self || !request) {
+        return -1;
+    }
+    rendezvous_t* me = &rendezvous[self->pid];
+
+    uint32_t flags = irq_save();
+    process_t* client = NULL;
+    if (caller) {
+        client = process_get((int)caller);
+        rendezvous_t* c = client ? &rendezvous[caller] : NULL;
+        if (!reply || !c || c->state != RV_CALLING || c->peer != (uint32_t)self->pid) {
+            irq_restore(flags);
+            return -1;
+        }
+        *c->buf = *reply;
+        c->state = RV_IDLE;
+    }
+
+    me->state = RV_RECEIVING;
+    me->buf = request;
+    wake_up(&me->callers);
+
+    // Run the client we answered first; the next call wakes us
+    while (me->state == RV_RECEIVING) {
+        rendezvous_block(self, client);
+        client = NULL;
+    }
+
+    int from = (int)me->peer;
+    irq_restore(flags);
+    return from;
+}
+
+void ipc_get_call_stats(ipc_call_stats_t* stats) {
+    if (stats) {
+        uint32_t flags = irq_save();
+        memcpy(stats, &call_stats, sizeof(ipc_call_stats_t));
+        irq_restore(flags);
+    }
+}
+
+// Fail the calls waiting on an exiting thread. Called with interrupts
+// disabled after the thread became a zombie.
+void ipc_thread_exit(process_t* thread) {
+    rendezvous_t* me = &rendezvous[thread->pid];
+    me->state = RV_IDLE;
+    wake_up_all(&me->callers);
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        rendezvous_t* c = &rendezvous[i];
+        if (c->state == RV_CALLING && c->peer == (uint32_t)thread->pid) {
+            c->state = RV_IDLE;
+            c->result = -1;
+            process_t* p = process_get(i);
+            if (p->state == PROCESS_BLOCKED) {
+                process_set_state(p, PROCESS_READY);
             }
-            
-            queue_count--;
-            return 0;
         }
     }
-    
-    return -1;
+}
+
+// Echo server for the benchmark: the main thread answers mailbox
+// messages, a second thread answers calls
+static volatile int echo_pid = -1;
+static volatile int echo_call_tid = -1;
+static volatile int echo_started = 0;
+static wait_queue_t echo_ready;
+
+static void echo_call_server(void* arg) {
+    (void)arg;
+    ipc_short_t request, reply;
+    int caller = 0;
+    while (1) {
+        caller = ipc_reply_wait((uint32_t)caller, &reply, &request);
+        reply = request;
+    }
+}
+
+static void echo_mailbox_server(void) {
+    echo_call_tid = thread_create(echo_call_server, NULL, 0, 0);
+    echo_started = 1;
+    wake_up_all(&echo_ready);
+
+    ipc_msg_t msg;
+    while (1) {
+        if (ipc_receive_timeout(0, &msg, -1) == 0) {
+            ipc_send(msg.sender, msg.type, msg.data, msg.length);
+        }
+    }
+}
+
+static uint32_t cycles_per_round(uint64_t start, uint32_t rounds) {
+    uint64_t elapsed = rdtsc() - start;
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    return cycles / rounds;
+}
+
+int ipc_pingpong_benchmark(uint32_t rounds, ipc_bench_t* result) {
+    if (!rounds || !result || !process_get_current()) {
+        return -1;
+    }
+
+    if (echo_pid < 0) {
+        wait_queue_init(&echo_ready, "ipc_echo");
+        echo_pid = process_create("ipcecho", echo_mailbox_server);
+        if (echo_pid < 0) {
+            log_error("Failed to create ipcecho");
+            return -1;
+        }
+    }
+    wait_event(echo_ready, echo_started);
+    if (echo_call_tid < 0) {
+        return -1;
+    }
+
+    // Same 16-byte payload both ways
+    ipc_short_t request, reply;
+    memset(&request, 0, sizeof(request));
+    ipc_msg_t msg;
+
+    uint64_t start = rdtsc();
+    for (uint32_t i = 0; i < rounds; i++) {
+        if (ipc_send((uint32_t)echo_pid, 0, request.words, sizeof(request.words)) != 0 ||
+            ipc_receive_timeout((uint32_t)echo_pid, &msg, -1) != 0) {
+            return -1;
+        }
+    }
+    result->mailbox_cycles = cycles_per_round(start, rounds);
+
+    uint32_t handoffs = call_stats.handoffs;
+    start = rdtsc();
+    for (uint32_t i = 0; i < rounds; i++) {
+        if (ipc_call((uint32_t)echo_call_tid, &request, &reply) != 0) {
+            return -1;
+        }
+    }
+    result->call_cycles = cycles_per_round(start, rounds);
+    result->handoffs = call_stats.handoffs - handoffs;
+    return 0;
 }
@@ -0,0 +1,57 @@
+#include "../include/ipc.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "IPC CALL Test: "
+#include "test_output.h"
+
+#define CALL_ROUNDS 3
+
+// Server thread: answers every call with its first word incremented
+static void increment_server(void* arg) {
+    (void)arg;
+    ipc_short_t request, reply;
+    uint32_t caller = 0;
+    while (1) {
+        caller = syscall(SYS_IPC_REPLY_WAIT, caller, (uint32_t)&reply, (uint32_t)&request);
+        reply = request;
+        reply.words[0]++;
+    }
+}
+
+// Synchronous call/reply test process
+void ipc_call_test_process(void) {
+    char msg[] = "IPC CALL Test: Call/reply test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    int server = (int)syscall(SYS_THREAD_CREATE, (uint32_t)increment_server, 0, 0);
+    report(server > 0, "server thread");
+
+    ipc_short_t request, reply;
+    memset(&request, 0, sizeof(request));
+    int ok = 1;
+    for (uint32_t i = 0; i < CALL_ROUNDS; i++) {
+        request.label = i;
+        request.words[0] = i * 10;
+        if (syscall(SYS_IPC_CALL, (uint32_t)server, (uint32_t)&request, (uint32_t)&reply) != SYS_SUCCESS ||
+            reply.label != i || reply.words[0] != i * 10 + 1) {
+            ok = 0;
+        }
+    }
+    report(ok, "replies");
+
+    ipc_call_stats_t st;
+    ipc_get_call_stats(&st);
+    report(st.handoffs > 0, "direct handoff");
+
+    report(syscall(SYS_IPC_CALL, syscall(SYS_GETTID, 0, 0, 0), (uint32_t)&request, (uint32_t)&reply) ==
+           (uint32_t)SYS_ERROR, "self call rejected");
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,64 @@
+#include "../include/ipc.h"
+#include "../include/memory.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "IPC Page Test: "
+#include "test_output.h"
+
+// Zero-copy transfer test process: a page buffer sent to itself
+void ipc_page_test_process(void) {
+    char msg[] = "IPC Page Test: Page transfer test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    uint32_t self = syscall(SYS_GETPID, 0, 0, 0);
+    const uint32_t pages = 16;
+
+    uint32_t addr = syscall(SYS_IPC_BUF_ALLOC, pages, 0, 0);
+    report(addr != (uint32_t)SYS_ERROR && addr >= IPC_WINDOW_BASE, "alloc");
+    if (addr != (uint32_t)SYS_ERROR) {
+        uint32_t* words = (uint32_t*)addr;
+        uint32_t count = pages * PAGE_SIZE / sizeof(uint32_t);
+        for (uint32_t i = 0; i < count; i++) {
+            words[i] = i ^ 0xA5A5A5A5;
+        }
+
+        report(syscall(SYS_IPC_SEND_PAGES, self, 7, addr) == SYS_SUCCESS, "send pages");
+
+        ipc_msg_t m;
+        ipc_page_grant_t grant = { 0, 0 };
+        int got = syscall(SYS_IPC_RECEIVE, 0, (uint32_t)&m, 0) == SYS_SUCCESS;
+        if (got) {
+            memcpy(&grant, m.data, sizeof(grant));
+        }
+        report(got && m.type == 7 && (m.flags & IPC_MSG_PAGES) &&
+               m.length == sizeof(grant) && grant.pages == pages, "grant received");
+
+        // The data arrived through the page tables, not a copy
+        int intact = grant.addr != 0;
+        uint32_t* moved = (uint32_t*)grant.addr;
+        for (uint32_t i = 0; intact && i < count; i++) {
+            intact = moved[i] == (i ^ 0xA5A5A5A5);
+        }
+        report(intact, "contents moved");
+
+        // The old address no longer names a buffer
+        report(syscall(SYS_IPC_SEND_PAGES, self, 7, addr) == (uint32_t)SYS_ERROR,
+               "sender lost buffer");
+        report(syscall(SYS_IPC_BUF_FREE, grant.addr, 0, 0) == SYS_SUCCESS, "free");
+        report(syscall(SYS_IPC_BUF_FREE, grant.addr, 0, 0) == (uint32_t)SYS_ERROR,
+               "double free rejected");
+    }
+
+    ipc_mailbox_stats_t st;
+    syscall(SYS_GET_STATS, STATS_IPC, (uint32_t)&st, self);
+    report(st.pages_received == pages && st.depth == 0, "stats");
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
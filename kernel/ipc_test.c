@@ -0,0 +1,53 @@
+#include "../include/ipc.h"
+#include "../include/vdso.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "IPC Test: "
+#include "test_output.h"
+
+// Mailbox test process: messages to itself
+void ipc_test_process(void) {
+    char msg[] = "IPC Test: Mailbox test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    uint32_t self = syscall(SYS_GETPID, 0, 0, 0);
+    report(syscall(SYS_IPC_MAILBOX, 4, 0, 0) == SYS_SUCCESS, "create");
+
+    // The fifth send finds the mailbox full
+    int sent = 0;
+    for (uint32_t i = 0; i < 5; i++) {
+        if (syscall4(SYS_IPC_SEND, self, i, (uint32_t)&i, sizeof(i)) == SYS_SUCCESS) {
+            sent++;
+        }
+    }
+    report(sent == 4, "full mailbox refuses");
+
+    ipc_msg_t m;
+    int in_order = 1;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (syscall(SYS_IPC_RECEIVE, 0, (uint32_t)&m, 0) != SYS_SUCCESS ||
+            m.type != i || m.sender != self || m.length != sizeof(uint32_t)) {
+            in_order = 0;
+        }
+    }
+    report(in_order, "FIFO receive");
+
+    // An empty mailbox times out after sleeping
+    uint32_t start = vdso_get_ticks();
+    uint32_t r = syscall(SYS_IPC_RECEIVE, 0, (uint32_t)&m, 50);
+    report(r == (uint32_t)SYS_ERROR && vdso_get_ticks() - start >= 5, "receive timeout");
+
+    ipc_mailbox_stats_t st;
+    syscall(SYS_GET_STATS, STATS_IPC, (uint32_t)&st, self);
+    report(st.capacity == 4 && st.depth == 0 && st.max_depth == 4 && st.sent == 4 &&
+           st.received == 4 && st.dropped == 1 && st.timeouts == 1, "stats");
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
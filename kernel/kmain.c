@@ -12,8 +12,25 @@
 #include "../drivers/net_ne2k.h"
 #include "../include/pci.h"
 #include "../include/idt.h"
+#include "../include/gdt.h"
+#include "../include/usermode.h"
+#include "../include/uring.h"
+#include "../include/vdso.h"
+#include "../include/systrace.h"
+#include "../include/file.h"
+#include "../include/poll.h"
+#include "../include/ipc.h"
+#include "../include/shm.h"
+#include "../include/pipe.h"
 #include "../include/memory.h"
 #include "../include/power.h"
+#include "../include/console.h"
+#include "../include/softirq.h"
+#include "../include/workqueue.h"
+#include "../include/futex.h"
+#include "../include/coroutine.h"
+#include "../drivers/mouse.h"
+#include "../kernel/fpu.h"
 
 extern void shell_init(void);
 extern void shell_run(void);
@@ -25,11 +42,16 @@ void kmain(void) {
     log_init();
     log_info("Kernel started");
 
+    gdt_init();
+    usermode_init();
     idt_init();
+    softirq_init();
+    fpu_init();
     log_info("IDT initialized");
     memory_init();
     log_info("Memory initialized");
     paging_init();
+    vdso_init();
     log_info("Paging initialized");
     
     vga_init();
@@ -45,7 +67,16 @@ void kmain(void) {
     vga_print("Networking: SKIPPED\n");
     
     vga_print("Initializing process management...\n");
+    file_init();
+    poll_init();
+    pipe_init();
+    ipc_init();
+    shm_init();
     process_init();
+    workqueue_init();
+    co_executor_init();
+    futex_init();
+    uring_init();
     vga_print("Process management: READY\n");
     
     vga_print("Initializing timer...\n");
@@ -58,15 +89,21 @@ void kmain(void) {
     vga_print("Filesystem: READY\n");
     
     vga_print("Initializing system call interface...\n");
+    systrace_init();
     syscall_init();
     vga_print("Syscalls: READY\n");
     
+    console_init();
+
     vga_print("Initializing keyboard...\n");
     keyboard_init();
     vga_print("Keyboard driver: READY\n");
     
     vga_print("Enabling IRQ 1...\n");
     enable_irq(1);
+
+    // Finishes setup asynchronously on the coroutine executor
+    mouse_init();
     
     // Perform final initializations
     power_init();
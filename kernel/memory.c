@@ -6,6 +6,15 @@
 static page_directory_t kernel_page_directory __attribute__((aligned(PAGE_SIZE)));
 static page_table_t kernel_page_table __attribute__((aligned(PAGE_SIZE)));
 
+// Page tables for regions beyond the identity-mapped first 4MB,
+// handed out by map_page() on first use
+#define EXTRA_PAGE_TABLES 4
+static page_table_t extra_page_tables[EXTRA_PAGE_TABLES] __attribute__((aligned(PAGE_SIZE)));
+static uint32_t extra_tables_used = 0;
+
+// End of the kernel image, from the linker script
+extern char _end[];
+
 // Bitmap for physical memory allocation
 #define MAX_PAGES 1024  // 4MB of physical memory for simplicity
 static uint32_t page_bitmap[MAX_PAGES / 32];
@@ -22,11 +31,19 @@ void memory_init(void) {
     // Clear page bitmap
     memset(page_bitmap, 0, sizeof(page_bitmap));
     
-    // Mark first 1MB as used (Kernel + BIOS + VGA holes)
-    for (uint32_t i = 0; i < 256; i++) {
+    // Mark first 1MB (BIOS + VGA holes) and the kernel image as used;
+    // the image's bss runs past 1MB
+    uint32_t reserved = ((uint32_t)_end + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (reserved < 256) {
+        reserved = 256;
+    }
+    if (reserved > MAX_PAGES) {
+        reserved = MAX_PAGES;
+    }
+    for (uint32_t i = 0; i < reserved; i++) {
         page_bitmap[i / 32] |= (1 << (i % 32));
     }
-    used_pages = 256;
+    used_pages = reserved;
     
     // Initialize heap
     heap_init();
@@ -37,6 +54,8 @@ void paging_init(void) {
     // Clear page directory and page table
     memset(&kernel_page_directory, 0, sizeof(kernel_page_directory));
     memset(&kernel_page_table, 0, sizeof(kernel_page_table));
+    memset(extra_page_tables, 0, sizeof(extra_page_tables));
+    extra_tables_used = 0;
     
     // Map first 4MB of physical memory to virtual address 0x00000000
     for (uint32_t i = 0; i < 1024; i++) {
@@ -87,55 +106,112 @@ void free_page(uint32_t page_addr) {
     }
 }
 
+// Page table covering virt_addr, or NULL
+static page_table_t* find_page_table(uint32_t virt_addr) {
+    uint32_t entry = kernel_page_directory.entries[virt_addr >> 22];
+    return (entry & PAGE_PRESENT) ? (page_table_t*)(entry & ~0xFFF) : NULL;
+}
+
 // Map a virtual page to a physical page
 void map_page(uint32_t virt_addr, uint32_t phys_addr, uint32_t flags) {
     uint32_t page_dir_index = virt_addr >> 22;
     uint32_t page_table_index = (virt_addr >> 12) & 0x3FF;
     
-    // Get page table (for simplicity, we assume it exists)
-    page_table_t* page_table = (page_table_t*)(kernel_page_directory.entries[page_dir_index] & ~0xFFF);
+    // Install a page table for a region mapped for the first time
+    page_table_t* page_table = find_page_table(virt_addr);
+    if (!page_table) {
+        if (extra_tables_used == EXTRA_PAGE_TABLES) {
+            return;
+        }
+        page_table = &extra_page_tables[extra_tables_used++];
+        kernel_page_directory.entries[page_dir_index] =
+            (uint32_t)page_table | PAGE_PRESENT | PAGE_WRITE | PAGE_USER;
+    } else if (flags & PAGE_USER) {
+        // Ring 3 needs the user bit at both levels; the boot table's other
+        // entries stay kernel-only through their own PTEs
+        kernel_page_directory.entries[page_dir_index] |= PAGE_USER;
+    }
     
     // Set page table entry
     page_table->entries[page_table_index] = phys_addr | flags;
     
-    // Flush TLB
-    flush_tlb();
+    // Only this page's translation can be stale
+    invlpg(virt_addr);
 }
 
 // Unmap a virtual page
 void unmap_page(uint32_t virt_addr) {
-    uint32_t page_dir_index = virt_addr >> 22;
     uint32_t page_table_index = (virt_addr >> 12) & 0x3FF;
     
     // Get page table
-    page_table_t* page_table = (page_table_t*)(kernel_page_directory.entries[page_dir_index] & ~0xFFF);
+    page_table_t* page_table = find_page_table(virt_addr);
+    if (!page_table) {
+        return;
+    }
     
     // Clear page table entry
     page_table->entries[page_table_index] = 0;
     
-    // Flush TLB
-    flush_tlb();
+    invlpg(virt_addr);
 }
 
 // Get physical address from virtual address
 uint32_t get_phys_addr(uint32_t virt_addr) {
-    uint32_t page_dir_index = virt_addr >> 22;
     uint32_t page_table_index = (virt_addr >> 12) & 0x3FF;
     uint32_t page_offset = virt_addr & 0xFFF;
     
     // Get page table
-    page_table_t* page_table = (page_table_t*)(kernel_page_directory.entries[page_dir_index] & ~0xFFF);
+    page_table_t* page_table = find_page_table(virt_addr);
+    if (!page_table) {
+        return 0;
+    }
     
     // Get physical address
     uint32_t phys_addr = page_table->entries[page_table_index] & ~0xFFF;
     return phys_addr + page_offset;
 }
 
+// Drop the TLB entry of one page
+void invlpg(uint32_t virt_addr) {
+    asm volatile ("invlpg (%0)" : : "r" (virt_addr) : "memory");
+}
+
 // Flush TLB
 void flush_tlb(void) {
     asm volatile ("mov %%cr3, %%eax; mov %%eax, %%cr3" : : : "eax");
 }
 
+void vm_window_init(vm_window_t* window, uint32_t base) {
+    window->base = base;
+    memset(window->map, 0, sizeof(window->map));
+}
+
+// First fit, marked used
+uint32_t vm_window_alloc(vm_window_t* window, uint32_t pages) {
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < VM_WINDOW_PAGES && pages; i++) {
+        if (window->map[i / 32] & (1u << (i % 32))) {
+            run = 0;
+            continue;
+        }
+        if (++run == pages) {
+            uint32_t first = i + 1 - pages;
+            for (uint32_t j = first; j <= i; j++) {
+                window->map[j / 32] |= 1u << (j % 32);
+            }
+            return window->base + first * PAGE_SIZE;
+        }
+    }
+    return 0;
+}
+
+void vm_window_free(vm_window_t* window, uint32_t addr, uint32_t pages) {
+    uint32_t first = (addr - window->base) / PAGE_SIZE;
+    for (uint32_t j = first; j < first + pages && j < VM_WINDOW_PAGES; j++) {
+        window->map[j / 32] &= ~(1u << (j % 32));
+    }
+}
+
 // Initialize heap
 void heap_init(void) {
     heap_pos = 0;
@@ -3,6 +3,8 @@
 #include "../include/vga.h"
 #include "../include/memory.h"
 #include "string.h"
+#include "process.h"
+#include "../drivers/timer.h"
 
 // Log buffer
 #define LOG_BUFFER_SIZE 256
@@ -127,9 +129,9 @@ void monitor_update_stats(void) {
     // Update memory usage (simplified)
     system_stats.used_memory = system_stats.total_memory - system_stats.free_memory;
     
-    // Update CPU time
-    system_stats.total_cpu_time = uptime_seconds * 100;
-    system_stats.idle_cpu_time = system_stats.total_cpu_time / 4; // 25% idle
+    // Update CPU time (in timer ticks)
+    system_stats.total_cpu_time = timer_get_ticks();
+    system_stats.idle_cpu_time = process_get_idle_ticks();
     
     // Calculate performance metrics
     performance_metrics.cpu_usage_percent = 
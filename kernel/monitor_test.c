@@ -2,6 +2,7 @@
 #include "../include/syscall.h"
 #include "../include/vga.h"
 #include "../include/string.h"
+#include "process.h"
 
 // Monitoring test process
 void monitor_test_process(void) {
@@ -62,6 +63,14 @@ void monitor_test_process(void) {
         syscall(SYS_WRITE, 1, (uint32_t)syscall_stats_msg, sizeof(syscall_stats_msg) - 1);
     }
     
+    // Test scheduler statistics: we have been scheduled, so we waited to run
+    sched_stats_t sched;
+    uint32_t tid = syscall(SYS_GETTID, 0, 0, 0);
+    if (syscall(SYS_GET_STATS, STATS_SCHED, (uint32_t)&sched, tid) == 0 && sched.runs > 0) {
+        char sched_msg[] = "MON Test: Scheduler statistics retrieved!\n";
+        syscall(SYS_WRITE, 1, (uint32_t)sched_msg, sizeof(sched_msg) - 1);
+    }
+    
     // Periodic monitoring
     int counter = 0;
     while (1) {
@@ -0,0 +1,267 @@
+#include "../include/mutex.h"
+#include "../drivers/vga.h"
+#include "process.h"
+#include "string.h"
+
+// Protects task priorities and held-mutex lists
+static spinlock_t pi_lock;
+
+#ifdef LOCK_STATS
+// Registry of named mutexes, linked through their stats blocks
+static mutex_stats_t* mutex_registry = NULL;
+static spinlock_t registry_lock;
+#endif
+
+// Initialize a mutex
+void mutex_init(mutex_t* mutex, const char* name) {
+    spin_lock_init(&mutex->lock, name);
+    mutex->locked = 0;
+    mutex->owner = NULL;
+    mutex->next_held = NULL;
+    wait_queue_init(&mutex->waiters, name);
+#ifdef LOCK_STATS
+    uint8_t registered = mutex->stats.registered;
+    mutex_stats_t* next = mutex->stats.next;
+    memset(&mutex->stats, 0, sizeof(mutex_stats_t));
+    mutex->stats.name = name ? name : "anon";
+
+    if (registered) {
+        // Re-initialized mutex: keep its place in the registry
+        mutex->stats.registered = 1;
+        mutex->stats.next = next;
+        return;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&registry_lock);
+    mutex->stats.next = mutex_registry;
+    mutex_registry = &mutex->stats;
+    mutex->stats.registered = 1;
+    spin_unlock_irqrestore(&registry_lock, flags);
+#endif
+}
+
+// Take the mutex if it is free and record it on the owner's held list
+static int mutex_acquire(mutex_t* mutex) {
+    int acquired = 0;
+    process_t* self = process_get_current();
+
+    uint32_t flags = spin_lock_irqsave(&mutex->lock);
+    if (!mutex->locked) {
+        mutex->locked = 1;
+        mutex->owner = self;
+        if (self) {
+            spin_lock(&pi_lock);
+            mutex->next_held = self->held_mutexes;
+            self->held_mutexes = mutex;
+            spin_unlock_no_resched(&pi_lock);
+        }
+        acquired = 1;
+#ifdef LOCK_STATS
+        mutex->stats.acquisitions++;
+#endif
+    }
+    spin_unlock_irqrestore(&mutex->lock, flags);
+    return acquired;
+}
+
+// Try to take the mutex without sleeping
+int mutex_trylock(mutex_t* mutex) {
+    return mutex_acquire(mutex);
+}
+
+// Lend the waiter's priority to the owner, and on along the chain of
+// owners that are themselves blocked on another mutex
+static void mutex_boost_owner(mutex_t* mutex, process_t* waiter) {
+    uint32_t flags = spin_lock_irqsave(&pi_lock);
+    for (int depth = 0; mutex && depth < MUTEX_PI_DEPTH; depth++) {
+        process_t* owner = mutex->owner;
+        if (!owner || owner->priority >= waiter->priority) {
+            break;
+        }
+        owner->priority = waiter->priority;
+#ifdef LOCK_STATS
+        mutex->stats.boosts++;
+#endif
+        mutex = owner->blocked_on;
+    }
+    spin_unlock_irqrestore(&pi_lock, flags);
+}
+
+// Adaptive spinning: an owner that is running on another CPU will
+// likely release soon, which is cheaper to wait out than a sleep and
+// wake-up. On a single CPU the owner cannot be running while we are,
+// so this gives up at once.
+static int mutex_spin_on_owner(mutex_t* mutex, process_t* self) {
+    for (int i = 0; i < MUTEX_SPIN_LIMIT; i++) {
+        if (!mutex->locked) {
+            if (mutex_acquire(mutex)) {
+                return 1;
+            }
+            continue;
+        }
+        process_t* owner = mutex->owner;
+        if (!owner || owner == self || owner->state != PROCESS_RUNNING) {
+            return 0;
+        }
+        cpu_relax();
+    }
+    return 0;
+}
+
+// Take the mutex, spinning briefly and then sleeping until it is released
+void mutex_lock(mutex_t* mutex) {
+    if (mutex_acquire(mutex)) {
+        return;
+    }
+
+    process_t* self = process_get_current();
+#ifdef LOCK_STATS
+    uint64_t start = rdtsc();
+    mutex->stats.contentions++;
+#endif
+
+    if (self && mutex_spin_on_owner(mutex, self)) {
+#ifdef LOCK_STATS
+        mutex->stats.spin_acquired++;
+#endif
+    } else {
+        if (self) {
+            self->blocked_on = mutex;
+        }
+        while (!mutex_acquire(mutex)) {
+            if (self) {
+                mutex_boost_owner(mutex, self);
+            }
+#ifdef LOCK_STATS
+            mutex->stats.sleeps++;
+#endif
+            wait_event(mutex->waiters, !mutex->locked);
+        }
+        if (self) {
+            self->blocked_on = NULL;
+            // Inherit from the waiters we are now holding up
+            mutex_update_priority(self);
+        }
+    }
+
+#ifdef LOCK_STATS
+    uint64_t waited = rdtsc() - start;
+    mutex->stats.wait_cycles += waited;
+    if (waited > mutex->stats.max_wait_cycles) {
+        mutex->stats.max_wait_cycles = (waited > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)waited;
+    }
+#endif
+}
+
+// Release the mutex, hand the chance to the first waiter and drop any
+// priority inherited through it
+void mutex_unlock(mutex_t* mutex) {
+    uint32_t flags = spin_lock_irqsave(&mutex->lock);
+    process_t* owner = mutex->owner;
+    if (owner) {
+        spin_lock(&pi_lock);
+        mutex_t** link = &owner->held_mutexes;
+        while (*link && *link != mutex) {
+            link = &(*link)->next_held;
+        }
+        if (*link) {
+            *link = mutex->next_held;
+        }
+        spin_unlock_no_resched(&pi_lock);
+    }
+    mutex->next_held = NULL;
+    mutex->locked = 0;
+    mutex->owner = NULL;
+    spin_unlock_irqrestore(&mutex->lock, flags);
+
+    // Wake before dropping the boost, so the waiter is runnable by the
+    // time we may lose the CPU to it
+    process_t* next = wake_up_task(&mutex->waiters);
+    if (owner) {
+        mutex_update_priority(owner);
+    }
+
+    // A waiter that outranks us once the boost is gone runs now rather
+    // than at the next tick
+    process_t* self = process_get_current();
+    if (next && self && next->priority > self->priority) {
+        process_set_need_resched();
+        preempt_check_resched();
+    }
+}
+
+int mutex_is_locked(mutex_t* mutex) {
+    return mutex->locked;
+}
+
+void mutex_update_priority(process_t* task) {
+    uint32_t flags = spin_lock_irqsave(&pi_lock);
+    uint32_t priority = task->base_priority;
+    for (mutex_t* held = task->held_mutexes; held; held = held->next_held) {
+        spin_lock(&held->waiters.lock);
+        for (wait_queue_entry_t* e = held->waiters.head; e; e = e->next) {
+            if (e->task && e->task->priority > priority) {
+                priority = e->task->priority;
+            }
+        }
+        spin_unlock_no_resched(&held->waiters.lock);
+    }
+    task->priority = priority;
+    spin_unlock_irqrestore(&pi_lock, flags);
+}
+
+void mutex_stats_dump(void) {
+#ifdef LOCK_STATS
+    char buf[16];
+    vga_print("  MUTEX             ACQUIRED  CONTENDED  SPUN  SLEPT  BOOSTS  MAX-WAIT\n");
+    for (mutex_stats_t* s = mutex_registry; s; s = s->next) {
+        vga_print("  ");
+        vga_print(s->name);
+        for (int pad = strlen(s->name); pad < 18; pad++) vga_putchar(' ');
+
+        uint32_t fields[] = { s->acquisitions, s->contentions, s->spin_acquired,
+                              s->sleeps, s->boosts, s->max_wait_cycles };
+        for (uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+            itoa((int)fields[i], buf, 10);
+            vga_print(buf);
+            vga_print("  ");
+        }
+        vga_print("\n");
+    }
+#endif
+}
+
+// Initialize a semaphore with an initial count
+void sem_init(semaphore_t* sem, int count, const char* name) {
+    spin_lock_init(&sem->lock, name);
+    sem->count = count;
+    wait_queue_init(&sem->waiters, name);
+}
+
+// Try to decrement the count without sleeping
+int sem_trydown(semaphore_t* sem) {
+    int acquired = 0;
+    uint32_t flags = spin_lock_irqsave(&sem->lock);
+    if (sem->count > 0) {
+        sem->count--;
+        acquired = 1;
+    }
+    spin_unlock_irqrestore(&sem->lock, flags);
+    return acquired;
+}
+
+// Decrement the count, sleeping while it is zero
+void sem_down(semaphore_t* sem) {
+    while (!sem_trydown(sem)) {
+        wait_event(sem->waiters, sem->count > 0);
+    }
+}
+
+// Increment the count and wake one sleeper. Safe from interrupt handlers.
+void sem_up(semaphore_t* sem) {
+    uint32_t flags = spin_lock_irqsave(&sem->lock);
+    sem->count++;
+    spin_unlock_irqrestore(&sem->lock, flags);
+
+    wake_up(&sem->waiters);
+}
@@ -1,5 +1,6 @@
 #include "../include/net.h"
 #include "log.h"
+#include "../include/softirq.h"
 
 // Simple static registry of network devices
 static net_device_t* net_devices[NET_MAX_DEVICES];
@@ -11,6 +12,11 @@ static uint32_t net_rx_bytes  = 0;
 static uint32_t net_tx_frames = 0;
 static uint32_t net_tx_bytes  = 0;
 
+// NET_RX bottom half: let every driver drain its receive ring
+static void net_rx_action(void) {
+    net_poll_all();
+}
+
 void net_init(void) {
     for (uint32_t i = 0; i < NET_MAX_DEVICES; ++i) {
         net_devices[i] = 0;
@@ -18,6 +24,7 @@ void net_init(void) {
     net_device_count = 0;
     net_rx_frames = net_rx_bytes = 0;
     net_tx_frames = net_tx_bytes = 0;
+    open_softirq(SOFTIRQ_NET_RX, net_rx_action);
     log_info("Network core initialized");
 }
 
@@ -46,6 +53,12 @@ void net_poll_all(void) {
     }
 }
 
+// Called by NIC interrupt handlers: acknowledge the card, then defer the
+// frame parsing to the NET_RX softirq instead of doing it in IRQ context
+void net_rx_schedule(void) {
+    raise_softirq(SOFTIRQ_NET_RX);
+}
+
 uint32_t net_get_device_count(void) {
     return net_device_count;
 }
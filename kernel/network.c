@@ -1,6 +1,8 @@
 #include "../include/network.h"
 #include "../include/syscall.h"
 #include "../include/vga.h"
+#include "../include/spinlock.h"
+#include "../include/poll.h"
 #include "string.h"
 
 // Global network interface
@@ -11,6 +13,12 @@ static network_packet_t packet_buffer[MAX_PACKETS];
 static int packet_head = 0;
 static int packet_tail = 0;
 static int packet_count = 0;
+static spinlock_t packet_lock;  // Protects packet_buffer and its indices
+
+// Readiness source for epoll
+static uint32_t network_poll(void) {
+    return packet_count ? POLLIN : 0;
+}
 
 // Initialize network stack
 void network_init(void) {
@@ -33,10 +41,12 @@ void network_init(void) {
     netif.active = 1;
     
     // Clear packet buffer
+    spin_lock_init(&packet_lock, "net_packets");
     memset(packet_buffer, 0, sizeof(packet_buffer));
     packet_head = 0;
     packet_tail = 0;
     packet_count = 0;
+    poll_register_source(POLL_SRC_NET, network_poll);
 }
 
 // Send a network packet
@@ -52,6 +62,7 @@ int network_send_packet(uint32_t dst_ip, uint8_t type, const void* data, uint16_
     // 4. Send to network hardware
     
     // For simulation, we'll just create a packet entry
+    uint32_t flags = spin_lock_irqsave(&packet_lock);
     if (packet_count < MAX_PACKETS) {
         network_packet_t* packet = &packet_buffer[packet_tail];
         
@@ -67,15 +78,24 @@ int network_send_packet(uint32_t dst_ip, uint8_t type, const void* data, uint16_
         packet_tail = (packet_tail + 1) % MAX_PACKETS;
         packet_count++;
         
+        spin_unlock_irqrestore(&packet_lock, flags);
+        poll_notify();
         return 0;
     }
     
+    spin_unlock_irqrestore(&packet_lock, flags);
     return -1;  // Buffer full
 }
 
 // Receive a network packet
 int network_receive_packet(network_packet_t* packet) {
-    if (packet_count == 0 || !packet) {
+    if (!packet) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&packet_lock);
+    if (packet_count == 0) {
+        spin_unlock_irqrestore(&packet_lock, flags);
         return -1;  // No packets available
     }
     
@@ -86,6 +106,7 @@ int network_receive_packet(network_packet_t* packet) {
     // Remove packet from buffer
     packet_head = (packet_head + 1) % MAX_PACKETS;
     packet_count--;
+    spin_unlock_irqrestore(&packet_lock, flags);
     
     return 0;
 }
@@ -0,0 +1,487 @@
+#include "../include/pipe.h"
+#include "../include/file.h"
+#include "../include/filesystem.h"
+#include "../include/memory.h"
+#include "../include/poll.h"
+#include "../include/spinlock.h"
+#include "../include/wait.h"
+#include "process.h"
+#include "string.h"
+
+typedef struct {
+    uint8_t* page;
+    uint32_t offset;             // First unread byte
+    uint32_t len;                // Unread bytes
+} pipe_buffer_t;
+
+typedef struct pipe {
+    uint8_t used;
+    uint8_t readers;             // Read end open
+    uint8_t writers;             // Write end open
+    uint8_t filling;             // A splice is reading into the next free buffer
+    uint8_t draining;            // A splice is writing out the oldest buffer
+    pipe_buffer_t bufs[PIPE_BUFFERS];
+    uint32_t head;               // Oldest buffer holding data
+    uint32_t nbufs;              // Buffers holding data
+    wait_queue_t read_wait;      // Readers waiting for data
+    wait_queue_t write_wait;     // Writers waiting for room
+} pipe_t;
+
+static pipe_t pipe_pool[MAX_PIPES];
+static pipe_stats_t pipe_stats;
+static spinlock_t pipe_lock;  // Protects the pool and every pipe
+
+static int pipe_read(file_t* f, void* buffer, uint32_t count, uint32_t offset);
+static int pipe_write(file_t* f, const void* buffer, uint32_t count, uint32_t offset);
+static void pipe_release(file_t* f);
+static uint32_t pipe_poll(file_t* f);
+
+static const file_ops_t pipe_read_ops = { pipe_read, NULL, pipe_release, pipe_poll };
+static const file_ops_t pipe_write_ops = { NULL, pipe_write, pipe_release, pipe_poll };
+
+void pipe_init(void) {
+    spin_lock_init(&pipe_lock, "pipe");
+    memset(pipe_pool, 0, sizeof(pipe_pool));
+    memset(&pipe_stats, 0, sizeof(pipe_stats));
+}
+
+static pipe_buffer_t* pipe_buf(pipe_t* p, uint32_t i) {
+    return &p->bufs[(p->head + i) % PIPE_BUFFERS];
+}
+
+static int pipe_has_room(pipe_t* p) {
+    if (p->nbufs < PIPE_BUFFERS) {
+        return 1;
+    }
+    pipe_buffer_t* last = pipe_buf(p, p->nbufs - 1);
+    return last->offset + last->len < PAGE_SIZE;
+}
+
+// Data to read, or end of file; a draining splice owns the oldest buffer
+static int pipe_readable(pipe_t* p) {
+    return !p->draining && (p->nbufs || !p->writers);
+}
+
+// Room to write, or nobody left to read it
+static int pipe_writable(pipe_t* p) {
+    return !p->readers || (!p->filling && pipe_has_room(p));
+}
+
+// Where the next written byte goes and how many fit there, or NULL if
+// the pipe is full. Called with pipe_lock held.
+static uint8_t* pipe_space_locked(pipe_t* p, uint32_t* room) {
+    if (p->nbufs) {
+        pipe_buffer_t* last = pipe_buf(p, p->nbufs - 1);
+        uint32_t end = last->offset + last->len;
+        if (end < PAGE_SIZE) {
+            *room = PAGE_SIZE - end;
+            return last->page + end;
+        }
+    }
+    if (p->nbufs == PIPE_BUFFERS) {
+        return NULL;
+    }
+    *room = PAGE_SIZE;
+    return pipe_buf(p, p->nbufs)->page;
+}
+
+// Account n bytes stored at pipe_space_locked(). Called with pipe_lock held.
+static void pipe_commit_locked(pipe_t* p, uint32_t n) {
+    pipe_buffer_t* last = p->nbufs ? pipe_buf(p, p->nbufs - 1) : NULL;
+    if (!last || last->offset + last->len == PAGE_SIZE) {
+        last = pipe_buf(p, p->nbufs++);
+        last->offset = 0;
+        last->len = 0;
+    }
+    last->len += n;
+    pipe_stats.bytes_written += n;
+}
+
+// Drop n bytes from the oldest buffer. Called with pipe_lock held.
+static void pipe_consume_locked(pipe_t* p, uint32_t n) {
+    pipe_buffer_t* b = pipe_buf(p, 0);
+    b->offset += n;
+    b->len -= n;
+    if (b->len == 0) {
+        p->head = (p->head + 1) % PIPE_BUFFERS;
+        p->nbufs--;
+    }
+    pipe_stats.bytes_read += n;
+}
+
+static void pipe_wake(pipe_t* p) {
+    wake_up_all(&p->read_wait);
+    wake_up_all(&p->write_wait);
+    poll_notify();
+}
+
+// Sleep until cond holds, and return with pipe_lock held and cond still true
+#define pipe_wait_locked(wq, cond, flags) \
+    do { \
+        while (1) { \
+            wait_event(wq, cond); \
+            flags = spin_lock_irqsave(&pipe_lock); \
+            if (cond) break; \
+            spin_unlock_irqrestore(&pipe_lock, flags); \
+        } \
+    } while (0)
+
+static int pipe_read(file_t* f, void* buffer, uint32_t count, uint32_t offset) {
+    (void)offset;
+    pipe_t* p = (pipe_t*)f->private_data;
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t flags;
+    pipe_wait_locked(p->read_wait, pipe_readable(p), flags);
+
+    // Whatever is there, up to count; an empty pipe here means end of file
+    uint8_t* dst = (uint8_t*)buffer;
+    uint32_t done = 0;
+    while (done < count && p->nbufs) {
+        pipe_buffer_t* b = pipe_buf(p, 0);
+        uint32_t n = b->len < count - done ? b->len : count - done;
+        memcpy(dst + done, b->page + b->offset, n);
+        pipe_consume_locked(p, n);
+        done += n;
+    }
+    spin_unlock_irqrestore(&pipe_lock, flags);
+
+    if (done) {
+        pipe_wake(p);
+    }
+    return (int)done;
+}
+
+static int pipe_write(file_t* f, const void* buffer, uint32_t count, uint32_t offset) {
+    (void)offset;
+    pipe_t* p = (pipe_t*)f->private_data;
+    const uint8_t* src = (const uint8_t*)buffer;
+    uint32_t done = 0;
+
+    while (done < count) {
+        uint32_t flags;
+        pipe_wait_locked(p->write_wait, pipe_writable(p), flags);
+        if (!p->readers) {
+            spin_unlock_irqrestore(&pipe_lock, flags);
+            return done ? (int)done : -1;
+        }
+
+        uint32_t room;
+        uint8_t* dst;
+        while (done < count && (dst = pipe_space_locked(p, &room)) != NULL) {
+            uint32_t n = room < count - done ? room : count - done;
+            memcpy(dst, src + done, n);
+            pipe_commit_locked(p, n);
+            done += n;
+        }
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        pipe_wake(p);
+    }
+    return (int)done;
+}
+
+// Called with pipe_lock held
+static void pipe_free_locked(pipe_t* p) {
+    for (int i = 0; i < PIPE_BUFFERS; i++) {
+        free_page((uint32_t)p->bufs[i].page);
+    }
+    p->used = 0;
+    pipe_stats.pipes--;
+}
+
+static void pipe_release(file_t* f) {
+    pipe_t* p = (pipe_t*)f->private_data;
+    uint32_t flags = spin_lock_irqsave(&pipe_lock);
+    if (f->ops == &pipe_read_ops) {
+        p->readers = 0;
+    } else {
+        p->writers = 0;
+    }
+    int last = !p->readers && !p->writers;
+    if (last) {
+        pipe_free_locked(p);
+    }
+    spin_unlock_irqrestore(&pipe_lock, flags);
+
+    if (!last) {
+        pipe_wake(p);
+    }
+}
+
+static uint32_t pipe_poll(file_t* f) {
+    pipe_t* p = (pipe_t*)f->private_data;
+    uint32_t flags = spin_lock_irqsave(&pipe_lock);
+    uint32_t ready;
+    if (f->ops == &pipe_read_ops) {
+        ready = (p->nbufs ? POLLIN : 0) | (p->writers ? 0 : POLLHUP);
+    } else {
+        ready = !p->readers ? POLLERR : (pipe_has_room(p) ? POLLOUT : 0);
+    }
+    spin_unlock_irqrestore(&pipe_lock, flags);
+    return ready;
+}
+
+// A pipe with its pages but no ends yet
+static pipe_t* pipe_alloc(void) {
+    pipe_t* p = NULL;
+    uint32_t flags = spin_lock_irqsave(&pipe_lock);
+    for (int i = 0; i < MAX_PIPES; i++) {
+        if (!pipe_pool[i].used) {
+            p = &pipe_pool[i];
+            break;
+        }
+    }
+    if (p) {
+        memset(p, 0, sizeof(pipe_t));
+        for (int i = 0; i < PIPE_BUFFERS; i++) {
+            // Frames are reachable through the kernel's identity map
+            uint32_t frame = alloc_page();
+            if (!frame) {
+                while (--i >= 0) {
+                    free_page((uint32_t)p->bufs[i].page);
+                }
+                p = NULL;
+                break;
+            }
+            p->bufs[i].page = (uint8_t*)frame;
+        }
+    }
+    if (p) {
+        p->used = 1;
+        wait_queue_init(&p->read_wait, "pipe_read");
+        wait_queue_init(&p->write_wait, "pipe_write");
+        pipe_stats.pipes++;
+    }
+    spin_unlock_irqrestore(&pipe_lock, flags);
+    return p;
+}
+
+int pipe_create(proc_shared_t* owner, int fds[2]) {
+    if (!owner || !fds) {
+        return -1;
+    }
+    pipe_t* p = pipe_alloc();
+    if (!p) {
+        return -1;
+    }
+
+    // Each end frees the pipe when it is released last
+    file_t* rf = file_alloc(&pipe_read_ops, O_RDONLY);
+    if (!rf) {
+        uint32_t flags = spin_lock_irqsave(&pipe_lock);
+        pipe_free_locked(p);
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        return -1;
+    }
+    rf->private_data = p;
+    p->readers = 1;
+
+    file_t* wf = file_alloc(&pipe_write_ops, O_WRONLY);
+    if (!wf) {
+        file_put(rf);
+        return -1;
+    }
+    wf->private_data = p;
+    p->writers = 1;
+
+    fds[0] = fd_install(owner, rf);
+    fds[1] = (fds[0] >= 0) ? fd_install(owner, wf) : -1;
+    if (fds[1] < 0) {
+        if (fds[0] >= 0) {
+            fd_close(owner, fds[0]);
+        } else {
+            file_put(rf);
+        }
+        file_put(wf);
+        return -1;
+    }
+    return 0;
+}
+
+// Oldest buffers out to a file, written straight from the pipe's pages
+static int splice_from_pipe(pipe_t* p, file_t* out, uint32_t len) {
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t flags;
+        if (done == 0) {
+            pipe_wait_locked(p->read_wait, pipe_readable(p), flags);
+        } else {
+            flags = spin_lock_irqsave(&pipe_lock);
+            if (!pipe_readable(p)) {
+                spin_unlock_irqrestore(&pipe_lock, flags);
+                break;
+            }
+        }
+        if (!p->nbufs) {
+            spin_unlock_irqrestore(&pipe_lock, flags);
+            break;
+        }
+
+        // The oldest buffer stays put while the writer may sleep
+        pipe_buffer_t* b = pipe_buf(p, 0);
+        uint32_t n = b->len < len - done ? b->len : len - done;
+        const uint8_t* data = b->page + b->offset;
+        p->draining = 1;
+        spin_unlock_irqrestore(&pipe_lock, flags);
+
+        int written = file_write(out, data, n);
+
+        flags = spin_lock_irqsave(&pipe_lock);
+        p->draining = 0;
+        if (written > 0) {
+            pipe_consume_locked(p, (uint32_t)written);
+            done += (uint32_t)written;
+        }
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        pipe_wake(p);
+
+        if (written < (int)n) {
+            if (written < 0 && done == 0) {
+                return -1;
+            }
+            break;
+        }
+    }
+    return (int)done;
+}
+
+// A file read straight into a free page of the pipe, a page at a time
+static int splice_to_pipe(file_t* in, pipe_t* p, uint32_t len) {
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t flags;
+        if (done == 0) {
+            pipe_wait_locked(p->write_wait,
+                             !p->readers || (!p->filling && p->nbufs < PIPE_BUFFERS), flags);
+        } else {
+            flags = spin_lock_irqsave(&pipe_lock);
+        }
+        if (!p->readers || p->filling || p->nbufs == PIPE_BUFFERS) {
+            spin_unlock_irqrestore(&pipe_lock, flags);
+            if (!p->readers && done == 0) {
+                return -1;
+            }
+            break;
+        }
+
+        // Readers never look past nbufs, so the next buffer is ours
+        pipe_buffer_t* b = pipe_buf(p, p->nbufs);
+        p->filling = 1;
+        spin_unlock_irqrestore(&pipe_lock, flags);
+
+        uint32_t want = len - done < PAGE_SIZE ? len - done : PAGE_SIZE;
+        int n = file_read(in, b->page, want);
+
+        flags = spin_lock_irqsave(&pipe_lock);
+        p->filling = 0;
+        if (n > 0) {
+            b->offset = 0;
+            b->len = (uint32_t)n;
+            p->nbufs++;
+            pipe_stats.bytes_written += (uint32_t)n;
+            done += (uint32_t)n;
+        }
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        pipe_wake(p);
+
+        if (n < (int)want) {
+            if (n < 0 && done == 0) {
+                return -1;
+            }
+            break;
+        }
+    }
+    return (int)done;
+}
+
+// Whole buffers change pipes by swapping pages; a partial one is copied
+static int splice_pipe_to_pipe(pipe_t* src, pipe_t* dst, uint32_t len) {
+    if (src == dst) {
+        return -1;
+    }
+
+    uint32_t flags;
+    while (1) {
+        pipe_wait_locked(src->read_wait, pipe_readable(src), flags);
+        if (!src->nbufs || !dst->readers || pipe_writable(dst)) {
+            break;
+        }
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        wait_event(dst->write_wait, pipe_writable(dst));
+    }
+    if (!dst->readers) {
+        spin_unlock_irqrestore(&pipe_lock, flags);
+        return -1;
+    }
+
+    uint32_t done = 0;
+    while (done < len && src->nbufs) {
+        pipe_buffer_t* b = pipe_buf(src, 0);
+        if (b->len <= len - done && dst->nbufs < PIPE_BUFFERS) {
+            pipe_buffer_t* d = pipe_buf(dst, dst->nbufs++);
+            uint8_t* spare = d->page;
+            d->page = b->page;
+            d->offset = b->offset;
+            d->len = b->len;
+            b->page = spare;
+            done += d->len;
+            pipe_stats.bytes_written += d->len;
+            pipe_consume_locked(src, d->len);
+            pipe_stats.pages_moved++;
+            continue;
+        }
+
+        uint32_t room;
+        uint8_t* space = pipe_space_locked(dst, &room);
+        if (!space) {
+            break;
+        }
+        uint32_t n = b->len < len - done ? b->len : len - done;
+        if (n > room) {
+            n = room;
+        }
+        memcpy(space, b->page + b->offset, n);
+        pipe_commit_locked(dst, n);
+        pipe_consume_locked(src, n);
+        done += n;
+    }
+    spin_unlock_irqrestore(&pipe_lock, flags);
+
+    pipe_wake(src);
+    pipe_wake(dst);
+    return (int)done;
+}
+
+static pipe_t* pipe_of(file_t* file, const file_ops_t* ops) {
+    return (file && file->ops == ops) ? (pipe_t*)file->private_data : NULL;
+}
+
+int pipe_splice(file_t* in, file_t* out, uint32_t len) {
+    pipe_t* src = pipe_of(in, &pipe_read_ops);
+    pipe_t* dst = pipe_of(out, &pipe_write_ops);
+    if (!in || !out || (!src && !dst)) {
+        return -1;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&pipe_lock);
+    pipe_stats.splices++;
+    spin_unlock_irqrestore(&pipe_lock, flags);
+
+    if (src && dst) {
+        return splice_pipe_to_pipe(src, dst, len);
+    }
+    return src ? splice_from_pipe(src, out, len) : splice_to_pipe(in, dst, len);
+}
+
+void pipe_get_stats(pipe_stats_t* stats) {
+    if (stats) {
+        uint32_t flags = spin_lock_irqsave(&pipe_lock);
+        memcpy(stats, &pipe_stats, sizeof(pipe_stats_t));
+        spin_unlock_irqrestore(&pipe_lock, flags);
+    }
+}
@@ -0,0 +1,95 @@
+#include "../include/pipe.h"
+#include "../include/filesystem.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "PIPE Test: "
+#include "test_output.h"
+
+#define PIPE_TEST_BYTES (3 * 4096 + 100)
+
+static int pipe_fds[2];
+
+// Writer thread: streams a pattern in odd-sized chunks, then hangs up
+static void writer_thread(void* arg) {
+    (void)arg;
+    uint8_t chunk[300];
+    uint32_t sent = 0;
+    while (sent < PIPE_TEST_BYTES) {
+        uint32_t n = PIPE_TEST_BYTES - sent < sizeof(chunk) ? PIPE_TEST_BYTES - sent : sizeof(chunk);
+        for (uint32_t i = 0; i < n; i++) {
+            chunk[i] = (uint8_t)(sent + i);
+        }
+        syscall(SYS_WRITE, pipe_fds[1], (uint32_t)chunk, n);
+        sent += n;
+    }
+    syscall(SYS_CLOSE, pipe_fds[1], 0, 0);
+    syscall(SYS_THREAD_EXIT, 0, 0, 0);
+}
+
+// Pipe and splice test process
+void pipe_test_process(void) {
+    char msg[] = "PIPE Test: Pipe test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    report(syscall(SYS_PIPE, (uint32_t)pipe_fds, 0, 0) == SYS_SUCCESS, "create");
+    int writer = (int)syscall(SYS_THREAD_CREATE, (uint32_t)writer_thread, 0, 0);
+    report(writer > 0, "writer thread");
+
+    // More than the pipe holds, so the writer blocks on a full pipe
+    uint8_t buf[512];
+    uint32_t received = 0;
+    int in_order = 1;
+    int n;
+    while ((n = (int)syscall(SYS_READ, pipe_fds[0], (uint32_t)buf, sizeof(buf))) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (buf[i] != (uint8_t)(received + i)) {
+                in_order = 0;
+            }
+        }
+        received += (uint32_t)n;
+    }
+    report(in_order && received == PIPE_TEST_BYTES, "stream through a full pipe");
+    report(n == 0, "end of file after close");
+    syscall(SYS_CLOSE, pipe_fds[0], 0, 0);
+
+    // File -> pipe -> pipe -> file without a user buffer
+    int a[2], b[2];
+    syscall(SYS_PIPE, (uint32_t)a, 0, 0);
+    syscall(SYS_PIPE, (uint32_t)b, 0, 0);
+    int src = (int)syscall(SYS_OPEN, (uint32_t)"/hello.txt", O_RDONLY, 0);
+    int dst = (int)syscall(SYS_OPEN, (uint32_t)"/splice.txt", O_RDWR | O_CREAT, 0);
+    report(syscall(SYS_SPLICE, src, a[1], 64) == 14, "splice file to pipe");
+
+    pipe_stats_t before, after;
+    syscall(SYS_GET_STATS, STATS_PIPE, (uint32_t)&before, 0);
+    report(syscall(SYS_SPLICE, a[0], b[1], 64) == 14, "splice pipe to pipe");
+    syscall(SYS_GET_STATS, STATS_PIPE, (uint32_t)&after, 0);
+    report(after.pages_moved == before.pages_moved + 1, "page moved, not copied");
+
+    report(syscall(SYS_SPLICE, b[0], dst, 64) == 14, "splice pipe to file");
+    char text[16];
+    memset(text, 0, sizeof(text));
+    syscall(SYS_SEEK, dst, 0, 0);
+    syscall(SYS_READ, dst, (uint32_t)text, 14);
+    report(memcmp(text, "Hello, World!\n", 14) == 0, "contents");
+    report(syscall(SYS_SPLICE, src, dst, 64) == (uint32_t)SYS_ERROR, "splice needs a pipe");
+
+    // Nobody left to read
+    syscall(SYS_CLOSE, b[0], 0, 0);
+    report(syscall(SYS_WRITE, b[1], (uint32_t)"x", 1) == (uint32_t)SYS_ERROR, "write without reader");
+
+    syscall(SYS_CLOSE, a[0], 0, 0);
+    syscall(SYS_CLOSE, a[1], 0, 0);
+    syscall(SYS_CLOSE, b[1], 0, 0);
+    syscall(SYS_CLOSE, src, 0, 0);
+    syscall(SYS_CLOSE, dst, 0, 0);
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,227 @@
+#include "../include/poll.h"
+#include "../include/file.h"
+#include "../include/filesystem.h"
+#include "../include/wait.h"
+#include "../drivers/timer.h"
+#include "process.h"
+#include "cpu.h"
+#include "string.h"
+
+typedef struct {
+    uint8_t used;
+    uint32_t target;             // Descriptor number or EPOLL_SOURCE(id)
+    uint32_t events;
+    uint32_t data;
+    file_t* file;                // Referenced file for descriptor targets
+} epoll_item_t;
+
+typedef struct epoll {
+    uint8_t used;
+    epoll_item_t items[EPOLL_MAX_ITEMS];
+} epoll_t;
+
+static epoll_t epoll_pool[MAX_EPOLL];
+static poll_source_fn sources[POLL_NR_SOURCES];
+
+// One queue for every epoll_wait() sleeper: sources only know that their
+// state changed, so each sleeper re-checks its own interest set
+static wait_queue_t poll_wait;
+
+static void epoll_release(file_t* f);
+static const file_ops_t epoll_file_ops = { NULL, NULL, epoll_release, NULL };
+
+void poll_init(void) {
+    wait_queue_init(&poll_wait, "poll");
+    memset(epoll_pool, 0, sizeof(epoll_pool));
+}
+
+void poll_register_source(uint32_t id, poll_source_fn fn) {
+    if (id < POLL_NR_SOURCES) {
+        sources[id] = fn;
+    }
+}
+
+void poll_notify(void) {
+    wake_up_all(&poll_wait);
+}
+
+static epoll_t* epoll_of(file_t* file) {
+    return (file && file->ops == &epoll_file_ops) ? (epoll_t*)file->private_data : NULL;
+}
+
+static void epoll_release(file_t* f) {
+    epoll_t* ep = (epoll_t*)f->private_data;
+    for (int i = 0; i < EPOLL_MAX_ITEMS; i++) {
+        if (ep->items[i].used) {
+            file_put(ep->items[i].file);
+        }
+    }
+    memset(ep, 0, sizeof(epoll_t));
+}
+
+int epoll_create(proc_shared_t* owner) {
+    if (!owner) {
+        return -1;
+    }
+
+    epoll_t* ep = NULL;
+    uint32_t flags = irq_save();
+    for (int i = 0; i < MAX_EPOLL; i++) {
+        if (!epoll_pool[i].used) {
+            ep = &epoll_pool[i];
+            ep->used = 1;
+            break;
+        }
+    }
+    irq_restore(flags);
+    if (!ep) {
+        return -1;
+    }
+
+    file_t* file = file_alloc(&epoll_file_ops, O_RDONLY);
+    if (!file) {
+        ep->used = 0;
+        return -1;
+    }
+    file->private_data = ep;
+
+    int fd = fd_install(owner, file);
+    if (fd < 0) {
+        file_put(file);
+    }
+    return fd;
+}
+
+static epoll_item_t* epoll_find(epoll_t* ep, uint32_t target) {
+    for (int i = 0; i < EPOLL_MAX_ITEMS; i++) {
+        if (ep->items[i].used && ep->items[i].target == target) {
+            return &ep->items[i];
+        }
+    }
+    return NULL;
+}
+
+static int epoll_add(epoll_t* ep, proc_shared_t* owner, uint32_t target, const epoll_event_t* event) {
+    file_t* file = NULL;
+    if (target >= EPOLL_SOURCE_BASE) {
+        if (target - EPOLL_SOURCE_BASE >= POLL_NR_SOURCES) {
+            return -1;
+        }
+    } else {
+        file = fd_get(owner, (int)target);
+        // An instance inside another could form a cycle
+        if (!file || epoll_of(file)) {
+            file_put(file);
+            return -1;
+        }
+    }
+
+    epoll_item_t* item = NULL;
+    uint32_t flags = irq_save();
+    if (!epoll_find(ep, target)) {
+        for (int i = 0; i < EPOLL_MAX_ITEMS; i++) {
+            if (!ep->items[i].used) {
+                item = &ep->items[i];
+                item->used = 1;
+                item->target = target;
+                item->events = event->events;
+                item->data = event->data;
+                item->file = file;
+                break;
+            }
+        }
+    }
+    irq_restore(flags);
+
+    if (!item) {
+        file_put(file);
+        return -1;
+    }
+
+    // The new target may already be ready for a thread sleeping on this set
+    poll_notify();
+    return 0;
+}
+
+int epoll_ctl(file_t* epfile, proc_shared_t* owner, int op, uint32_t target, const epoll_event_t* event) {
+    epoll_t* ep = epoll_of(epfile);
+    if (!ep || (op != EPOLL_CTL_DEL && !event)) {
+        return -1;
+    }
+
+    if (op == EPOLL_CTL_ADD) {
+        return epoll_add(ep, owner, target, event);
+    }
+
+    file_t* dropped = NULL;
+    int result = -1;
+    uint32_t flags = irq_save();
+    epoll_item_t* item = epoll_find(ep, target);
+    if (item && op == EPOLL_CTL_MOD) {
+        item->events = event->events;
+        item->data = event->data;
+        result = 0;
+    } else if (item && op == EPOLL_CTL_DEL) {
+        dropped = item->file;
+        memset(item, 0, sizeof(epoll_item_t));
+        result = 0;
+    }
+    irq_restore(flags);
+
+    file_put(dropped);
+    if (result == 0 && op == EPOLL_CTL_MOD) {
+        poll_notify();
+    }
+    return result;
+}
+
+static uint32_t epoll_item_ready(const epoll_item_t* item) {
+    uint32_t ready;
+    if (item->file) {
+        ready = file_poll(item->file);
+    } else {
+        poll_source_fn fn = sources[item->target - EPOLL_SOURCE_BASE];
+        ready = fn ? fn() : 0;
+    }
+    return ready & (item->events | POLLERR | POLLHUP);
+}
+
+// Store up to max ready items in events
+static uint32_t epoll_scan(epoll_t* ep, epoll_event_t* events, uint32_t max) {
+    uint32_t n = 0;
+    uint32_t flags = irq_save();
+    for (int i = 0; i < EPOLL_MAX_ITEMS && n < max; i++) {
+        if (!ep->items[i].used) continue;
+        uint32_t ready = epoll_item_ready(&ep->items[i]);
+        if (ready) {
+            events[n].events = ready;
+            events[n].data = ep->items[i].data;
+            n++;
+        }
+    }
+    irq_restore(flags);
+    return n;
+}
+
+int epoll_wait(file_t* epfile, epoll_event_t* events, uint32_t max_events, int32_t timeout_ms) {
+    epoll_t* ep = epoll_of(epfile);
+    if (!ep || !events || !max_events) {
+        return -1;
+    }
+    if (max_events > EPOLL_MAX_ITEMS) {
+        max_events = EPOLL_MAX_ITEMS;
+    }
+
+    uint32_t n = epoll_scan(ep, events, max_events);
+    if (n || timeout_ms == 0) {
+        return (int)n;
+    }
+
+    if (timeout_ms < 0) {
+        wait_event(poll_wait, (n = epoll_scan(ep, events, max_events)) != 0);
+    } else {
+        wait_event_timeout(poll_wait, (n = epoll_scan(ep, events, max_events)) != 0,
+                           timer_ms_to_ticks((uint32_t)timeout_ms));
+    }
+    return (int)n;
+}
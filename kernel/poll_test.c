@@ -0,0 +1,67 @@
+#include "../include/poll.h"
+#include "../include/vdso.h"
+#include "../include/filesystem.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "POLL Test: "
+#include "test_output.h"
+
+// Readiness multiplexing test process
+void poll_test_process(void) {
+    char msg[] = "POLL Test: Readiness multiplexing test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    int ep = (int)syscall(SYS_EPOLL_CREATE, 0, 0, 0);
+    report(ep >= 0, "epoll_create");
+
+    epoll_event_t ev;
+    epoll_event_t out[4];
+
+    // Sources with nothing pending
+    ev.events = POLLIN;
+    ev.data = 1;
+    report(syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_ADD, EPOLL_SOURCE(POLL_SRC_IPC), (uint32_t)&ev) == SYS_SUCCESS,
+           "add IPC source");
+    ev.data = 2;
+    syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_ADD, EPOLL_SOURCE(POLL_SRC_NET), (uint32_t)&ev);
+    report(syscall4(SYS_EPOLL_WAIT, ep, (uint32_t)out, 4, 0) == 0, "nothing ready");
+
+    // The timeout puts the caller to sleep for at least its length
+    uint32_t start = vdso_get_ticks();
+    int n = (int)syscall4(SYS_EPOLL_WAIT, ep, (uint32_t)out, 4, 50);
+    report(n == 0 && vdso_get_ticks() - start >= 5, "timeout");
+
+    // A ramfs file is always ready
+    int fd = (int)syscall(SYS_OPEN, (uint32_t)"/poll_test.txt", O_RDWR | O_CREAT, 0);
+    ev.events = POLLIN | POLLOUT;
+    ev.data = 3;
+    syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_ADD, fd, (uint32_t)&ev);
+    n = (int)syscall4(SYS_EPOLL_WAIT, ep, (uint32_t)out, 4, -1);
+    report(n == 1 && out[0].data == 3 && out[0].events == (POLLIN | POLLOUT), "file ready");
+
+    ev.events = POLLOUT;
+    syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_MOD, fd, (uint32_t)&ev);
+    n = (int)syscall4(SYS_EPOLL_WAIT, ep, (uint32_t)out, 4, 0);
+    report(n == 1 && out[0].events == POLLOUT, "interest mask");
+
+    report(syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_DEL, fd, 0) == SYS_SUCCESS &&
+           syscall4(SYS_EPOLL_WAIT, ep, (uint32_t)out, 4, 0) == 0, "remove");
+    report(syscall4(SYS_EPOLL_CTL, ep, EPOLL_CTL_ADD, ep, (uint32_t)&ev) == (uint32_t)SYS_ERROR,
+           "nesting rejected");
+
+    // An epoll descriptor has no data of its own
+    char byte;
+    report(syscall(SYS_READ, ep, (uint32_t)&byte, 1) == (uint32_t)SYS_ERROR, "read rejected");
+
+    syscall(SYS_CLOSE, fd, 0, 0);
+    syscall(SYS_CLOSE, ep, 0, 0);
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,52 @@
+#include "../include/preempt.h"
+#include "../include/softirq.h"
+#include "process.h"
+#include "cpu.h"
+
+// Used before process_init(), when there is no current task yet
+static volatile int boot_preempt_count = 0;
+
+static volatile int* preempt_count_ptr(void) {
+    process_t* current = process_get_current();
+    return current ? &current->preempt_count : &boot_preempt_count;
+}
+
+void preempt_disable(void) {
+    (*preempt_count_ptr())++;
+    asm volatile ("" : : : "memory");
+}
+
+void preempt_enable_no_resched(void) {
+    asm volatile ("" : : : "memory");
+    (*preempt_count_ptr())--;
+}
+
+void preempt_enable(void) {
+    preempt_enable_no_resched();
+    preempt_check_resched();
+}
+
+int preempt_count(void) {
+    return *preempt_count_ptr();
+}
+
+void preempt_check_resched(void) {
+    // Interrupt context reschedules from irq_exit(); with interrupts off
+    // the pending request is picked up at the next IRQ exit instead
+    if (!process_need_resched() || preempt_count() != 0 ||
+        in_interrupt() || !irqs_enabled()) {
+        return;
+    }
+
+    uint32_t flags = irq_save();
+    schedule();
+    irq_restore(flags);
+}
+
+void cond_resched(void) {
+    preempt_check_resched();
+}
+
+uint32_t preempt_get_max_latency(void) {
+    return process_get_max_resched_latency();
+}
@@ -2,7 +2,16 @@
 #include "../include/vga.h"
 #include "../include/string.h"
 #include "../include/idt.h"
+#include "../include/gdt.h"
+#include "../include/mutex.h"
+#include "../include/usermode.h"
+#include "../include/uring.h"
+#include "../include/vdso.h"
+#include "../include/systrace.h"
+#include "../include/ipc.h"
+#include "../include/shm.h"
 #include "context.h"
+#include "cpu.h"
 
 // Local VGA functions for process system
 static void proc_vga_print(const char* str) {
@@ -18,6 +27,20 @@ static int current_process = 0;
 static int scheduler_ticks = 0;
 static process_t* current_process_ptr = NULL;
 
+// Per-process state shared by its threads; nr_threads == 0 marks a free slot
+static proc_shared_t shared_pool[MAX_PROCESSES];
+
+// Set from interrupt context when the running task should give up the CPU
+static volatile int need_resched = 0;
+
+// Preemption latency: TSC of the pending request and worst case seen
+static uint64_t resched_requested_at = 0;
+static uint32_t max_resched_latency = 0;
+
+// Idle accounting: set while the CPU is halted waiting for work
+static volatile int cpu_idle = 0;
+static volatile uint32_t idle_ticks = 0;
+
 // External test process functions
 extern void test_process_1(void);
 extern void test_process_2(void);
@@ -40,14 +63,37 @@ void __stack_chk_fail_local(void) {
 void process_init(void) {
     for (int i = 0; i < MAX_PROCESSES; i++) {
         processes[i].state = PROCESS_EMPTY;
+        processes[i].joinable = 0;
+        wait_queue_init(&processes[i].exit_wait, "thread_exit");
+        shared_pool[i].nr_threads = 0;
     }
     
     // Create the first process slot properly
     process_t* p = &processes[0];
     p->pid = 0;
+    p->tgid = 0;
+    p->shared = &shared_pool[0];
+    p->shared->tgid = 0;
+    p->shared->nr_threads = 1;
+    p->shared->cr3 = 0;
+    p->shared->uid = 0;
+    p->shared->gid = 0;
+    p->shared->uring = NULL;
+    p->shared->trace = NULL;
+    p->shared->mailbox = NULL;
+    fd_table_init(p->shared);
+    p->tls_base = 0;
+    p->tls_limit = 0;
+    p->base_priority = 1;
+    p->held_mutexes = NULL;
+    p->blocked_on = NULL;
+    memset(&p->sched, 0, sizeof(sched_stats_t));
+    p->sched.state_since = rdtsc();
     p->state = PROCESS_RUNNING;
     p->priority = 1;
     p->runtime = 0;
+    p->preempt_count = 0;
+    p->fpu_used = 0;
     strncpy(p->name, "kernel", MAX_PROCESS_NAME - 1);
 
     // next_pid must be 1 so process_print_list loops correctly
@@ -56,30 +102,78 @@ void process_init(void) {
     current_process_ptr = &processes[current_process];
 }
 
-int process_create(const char* name, void (*entry_point)()) {
-    // Find an empty slot instead of just using next_pid
-    int pid_to_assign = -1;
+// Find a free thread slot. Zombies can be reused unless a joiner may
+// still collect their exit status.
+static int alloc_thread_slot(void) {
     for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (processes[i].state == PROCESS_EMPTY || processes[i].state == PROCESS_ZOMBIE) {
-            pid_to_assign = i;
-            break;
+        if (processes[i].state == PROCESS_EMPTY ||
+            (processes[i].state == PROCESS_ZOMBIE && !processes[i].joinable)) {
+            if (i >= next_pid) next_pid = i + 1;
+            return i;
         }
     }
+    return -1;
+}
 
-    if (pid_to_assign == -1 || pid_to_assign >= MAX_PROCESSES) {
-        return -1; // No more process slots
+// Find a free per-process shared state
+static proc_shared_t* alloc_shared(void) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (shared_pool[i].nr_threads == 0) {
+            return &shared_pool[i];
+        }
     }
+    return NULL;
+}
 
-    if (pid_to_assign >= next_pid) next_pid = pid_to_assign + 1;
-
-    process_t* p = &processes[pid_to_assign];
-    p->pid = pid_to_assign;
+// Common setup of a new, not yet runnable thread
+static process_t* thread_setup(int tid, const char* name, proc_shared_t* shared) {
+    process_t* p = &processes[tid];
+    p->pid = tid;
+    p->tgid = shared->tgid;
+    p->shared = shared;
+    shared->nr_threads++;
     memset(p->name, 0, MAX_PROCESS_NAME);
     strncpy(p->name, name, MAX_PROCESS_NAME - 1);
-    
-    p->state = PROCESS_READY;
+
     p->priority = 1;
+    p->base_priority = 1;
+    p->held_mutexes = NULL;
+    p->blocked_on = NULL;
     p->runtime = 0;
+    p->preempt_count = 0;
+    p->tls_base = 0;
+    p->tls_limit = 0;
+    p->joinable = 0;
+    p->exit_status = 0;
+    p->timer_armed = 0;
+    memset(&p->sched, 0, sizeof(sched_stats_t));
+    p->sched.state_since = rdtsc();
+    fpu_release(p);  // Slot may be a zombie's whose FPU state is still live
+    return p;
+}
+
+int process_create(const char* name, void (*entry_point)()) {
+    uint32_t flags = irq_save();
+    int pid_to_assign = alloc_thread_slot();
+    proc_shared_t* shared = alloc_shared();
+    if (pid_to_assign == -1 || !shared) {
+        irq_restore(flags);
+        return -1; // No more process slots
+    }
+
+    // New process: its own shared state, credentials inherited
+    proc_shared_t* parent = current_process_ptr ? current_process_ptr->shared : NULL;
+    shared->tgid = pid_to_assign;
+    shared->nr_threads = 0;
+    shared->cr3 = 0;
+    shared->uid = parent ? parent->uid : 0;
+    shared->gid = parent ? parent->gid : 0;
+    shared->uring = NULL;
+    shared->trace = NULL;
+    shared->mailbox = NULL;
+    fd_table_init(shared);
+
+    process_t* p = thread_setup(pid_to_assign, name, shared);
     
     // Set up process context if we have an entry point
     if (entry_point) {
@@ -87,16 +181,91 @@ int process_create(const char* name, void (*entry_point)()) {
         uint32_t stack_top = (uint32_t)p->stack + STACK_SIZE;
         context_init(&p->context, entry_point, stack_top);
     }
+    p->state = PROCESS_READY;
+    irq_restore(flags);
     
     return pid_to_assign;
 }
 
+// Start a thread in the calling process. tls_limit == 0 means no TLS block.
+int thread_create(void (*entry_point)(void*), void* arg, uint32_t tls_base, uint32_t tls_limit) {
+    if (!entry_point || !current_process_ptr) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    int tid = alloc_thread_slot();
+    if (tid == -1) {
+        irq_restore(flags);
+        return -1;
+    }
+
+    process_t* p = thread_setup(tid, current_process_ptr->name, current_process_ptr->shared);
+    p->tls_base = tls_base;
+    p->tls_limit = tls_limit;
+    p->joinable = 1;
+    context_init_arg(&p->context, entry_point, arg, (uint32_t)p->stack + STACK_SIZE);
+    p->state = PROCESS_READY;
+    irq_restore(flags);
+
+    return tid;
+}
+
+// Wait for a thread of the same process to exit and collect its status
+int thread_join(int tid, int* status) {
+    process_t* self = current_process_ptr;
+    process_t* t = process_get(tid);
+    if (!self || !t || t == self || !t->joinable || t->tgid != self->tgid) {
+        return -1;
+    }
+
+    wait_event(t->exit_wait, t->state == PROCESS_ZOMBIE || !t->joinable);
+
+    // Another joiner may have collected it first
+    uint32_t flags = irq_save();
+    int ok = t->joinable && t->state == PROCESS_ZOMBIE;
+    if (ok) {
+        if (status) {
+            *status = t->exit_status;
+        }
+        t->joinable = 0;  // Slot can be reused now
+    }
+    irq_restore(flags);
+    return ok ? 0 : -1;
+}
+
+// End the calling thread; the process goes away with its last thread
+void thread_exit(int status) {
+    process_exit(status);
+}
+
+// Exit the calling thread. Other threads of the process keep running;
+// the shared state is released together with the last one.
 void process_exit(int status) {
-    UNUSED(status);  // Will be used when process cleanup is implemented
-    // TODO: Clean up process resources
-    // For now, just mark as zombie
-    if (current_process_ptr) {
-        current_process_ptr->state = PROCESS_ZOMBIE;
+    irq_save();
+    process_t* self = current_process_ptr;
+    if (self) {
+        self->exit_status = status;
+        process_set_state(self, PROCESS_ZOMBIE);
+        fpu_release(self);
+        if (self->shared && --self->shared->nr_threads == 0) {
+            // Last thread: the shared slot is free again
+            uring_release(self->shared);
+            systrace_release(self->shared);
+            ipc_mailbox_release(self->shared);
+            shm_release(self->shared);
+            fd_table_release(self->shared);
+
+            // Nobody is left to join the process's threads: their
+            // zombies, this one included, become reusable slots
+            for (int i = 0; i < MAX_PROCESSES; i++) {
+                if (processes[i].state == PROCESS_ZOMBIE && processes[i].shared == self->shared) {
+                    processes[i].joinable = 0;
+                }
+            }
+        }
+        ipc_thread_exit(self);
+        wake_up_all(&self->exit_wait);
     }
     // A process that exits should not return, it should yield.
     schedule();
@@ -152,53 +321,252 @@ void process_print_list(void) {
     }
 }
 
-// Simple round-robin scheduler with context switching
+static void print_padded(uint32_t value, int width) {
+    char buf[16];
+    itoa((int)value, buf, 10);
+    for (int pad = strlen(buf); pad < width; pad++) proc_vga_print(" ");
+    proc_vga_print(buf);
+}
+
+// Per-task scheduler statistics plus a run-queue latency histogram
+// summed over all tasks. Times are in units of 2^20 TSC cycles.
+void process_print_schedstat(void) {
+    uint32_t hist[SCHED_LAT_BUCKETS];
+    memset(hist, 0, sizeof(hist));
+
+    proc_vga_print("  PID   RUN-M  READY-M  BLOCK-M   VOL  INVOL  AVG-LAT  MAX-LAT  NAME\n");
+    for (int i = 0; i < next_pid; i++) {
+        process_t* p = &processes[i];
+        if (p->state == PROCESS_EMPTY) continue;
+
+        // Charge the current state up to now without changing it
+        uint64_t open = rdtsc() - p->sched.state_since;
+        uint64_t run = p->sched.time_running + (p->state == PROCESS_RUNNING ? open : 0);
+        uint64_t ready = p->sched.time_ready + (p->state == PROCESS_READY ? open : 0);
+        uint64_t blocked = p->sched.time_blocked + (p->state == PROCESS_BLOCKED ? open : 0);
+
+        // Each latency is clamped to 32 bits, so the average fits
+        uint32_t avg = p->sched.runs ? div64_32(p->sched.total_latency, p->sched.runs) : 0;
+
+        print_padded(p->pid, 5);
+        print_padded((uint32_t)(run >> 20), 8);
+        print_padded((uint32_t)(ready >> 20), 9);
+        print_padded((uint32_t)(blocked >> 20), 9);
+        print_padded(p->sched.voluntary_switches, 6);
+        print_padded(p->sched.involuntary_switches, 7);
+        print_padded(avg, 9);
+        print_padded(p->sched.max_latency, 9);
+        proc_vga_print("  ");
+        proc_vga_print(p->name);
+        proc_vga_print("\n");
+
+        for (int b = 0; b < SCHED_LAT_BUCKETS; b++) {
+            hist[b] += p->sched.latency_hist[b];
+        }
+    }
+
+    proc_vga_print("  Run-queue latency (cycles): ");
+    for (int b = 0; b < SCHED_LAT_BUCKETS; b++) {
+        if (!hist[b]) continue;
+        char buf[16];
+        proc_vga_print(" 2^");
+        itoa(b, buf, 10);
+        proc_vga_print(buf);
+        proc_vga_print(":");
+        itoa((int)hist[b], buf, 10);
+        proc_vga_print(buf);
+    }
+    proc_vga_print("\n");
+}
+
+// Make next the current task and switch to it. Called with interrupts disabled.
+static void switch_to(process_t* old_process, process_t* next, int preempted) {
+    current_process = (int)(next - processes);
+    current_process_ptr = next;
+
+    if (old_process) {
+        if (old_process->state == PROCESS_RUNNING) {
+            // Still runnable: preempted if a reschedule was forced on it
+            process_set_state(old_process, PROCESS_READY);
+            if (preempted) {
+                old_process->sched.involuntary_switches++;
+            } else {
+                old_process->sched.voluntary_switches++;
+            }
+        } else {
+            old_process->sched.voluntary_switches++;
+        }
+    }
+    process_set_state(current_process_ptr, PROCESS_RUNNING);
+
+    // Perform context switch if we have a different process
+    if (old_process) {
+        fpu_switch(current_process_ptr);
+        usermode_set_kernel_stack((uint32_t)current_process_ptr->stack + STACK_SIZE);
+        vdso_set_task(current_process_ptr);
+        if (old_process->tls_limit || current_process_ptr->tls_limit) {
+            gdt_set_tls(current_process_ptr->tls_base, current_process_ptr->tls_limit);
+        }
+        context_switch(&old_process->context, &current_process_ptr->context);
+    }
+}
+
 void schedule(void) {
     scheduler_ticks++;
     
+    // Measure how long a pending reschedule request waited for us
+    int preempted = need_resched;
+    if (need_resched) {
+        uint64_t waited = rdtsc() - resched_requested_at;
+        uint32_t latency = (waited > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)waited;
+        if (latency > max_resched_latency) {
+            max_resched_latency = latency;
+        }
+        need_resched = 0;
+    }
+    
     // Do not switch if only the kernel process exists
     if (next_pid <= 1) {
         return;
     }
 
-    // Update current process runtime
-    if (current_process_ptr) {
-        current_process_ptr->runtime++;
-        if (current_process_ptr->state == PROCESS_RUNNING)
-            current_process_ptr->state = PROCESS_READY;
+    process_t* old_process = current_process_ptr;
+    if (old_process) {
+        old_process->runtime++;
     }
-    
-    // Find next ready process
-    int next = current_process;
-    int attempts = 0;
-    
-    do {
-        next = (next + 1) % next_pid;
-        attempts++;
-        
-        // Skip empty slots and zombie processes
-        if (processes[next].state == PROCESS_READY) {
-            process_t* old_process = current_process_ptr;
-            current_process = next;
-            current_process_ptr = &processes[current_process];
-            current_process_ptr->state = PROCESS_RUNNING;
-            
-            // Perform context switch if we have a different process
-            if (old_process != current_process_ptr && old_process && current_process_ptr) {
-                context_switch(&old_process->context, &current_process_ptr->context);
-            }
-            
-            return;
+
+    // Pick the highest-priority runnable process; round-robin among
+    // equals, so the current process (visited last) only keeps the CPU
+    // if nobody else of its priority is ready
+    int next = -1;
+    int idx = current_process;
+    for (int attempts = 0; attempts < next_pid; attempts++) {
+        idx = (idx + 1) % next_pid;
+        process_state_t state = processes[idx].state;
+        if ((state == PROCESS_READY || (state == PROCESS_RUNNING && idx == current_process)) &&
+            (next < 0 || processes[idx].priority > processes[next].priority)) {
+            next = idx;
         }
-    } while (attempts < MAX_PROCESSES);
-    
-    // No ready processes found, stay with current
-    if (current_process_ptr && current_process_ptr->state == PROCESS_READY) {
-        current_process_ptr->state = PROCESS_RUNNING;
     }
+
+    if (next < 0 || &processes[next] == old_process) {
+        return;
+    }
+
+    switch_to(old_process, &processes[next], preempted);
+}
+
+// Direct handoff: run next now without scanning the run queue. The
+// caller has already set its own state (usually BLOCKED waiting for
+// next to answer). next must not be running. Called with interrupts
+// disabled.
+void process_handoff(process_t* next) {
+    process_t* old_process = current_process_ptr;
+    if (!old_process || !next || next == old_process ||
+        next->state == PROCESS_EMPTY || next->state == PROCESS_ZOMBIE) {
+        return;
+    }
+    old_process->runtime++;
+    switch_to(old_process, next, 0);
+}
+
+// Change a task's state, charging the time spent in the old one.
+// Called with interrupts disabled.
+void process_set_state(process_t* p, process_state_t state) {
+    uint64_t now = rdtsc();
+    uint64_t delta = now - p->sched.state_since;
+
+    switch (p->state) {
+        case PROCESS_RUNNING:
+            p->sched.time_running += delta;
+            break;
+        case PROCESS_READY:
+            p->sched.time_ready += delta;
+            if (state == PROCESS_RUNNING) {
+                uint32_t latency = (delta > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)delta;
+                p->sched.total_latency += latency;
+                p->sched.runs++;
+                if (latency > p->sched.max_latency) {
+                    p->sched.max_latency = latency;
+                }
+                int bucket = latency ? 31 - __builtin_clz(latency) : 0;
+                p->sched.latency_hist[bucket]++;
+            }
+            break;
+        case PROCESS_BLOCKED:
+            p->sched.time_blocked += delta;
+            if (state == PROCESS_READY) {
+                p->sched.wakeups++;
+            }
+            break;
+        default:
+            break;
+    }
+
+    p->sched.state_since = now;
+    p->state = state;
+}
+
+// Change a task's base priority; inherited boosts are kept
+int process_set_priority(int pid, uint32_t priority) {
+    process_t* p = process_get(pid);
+    if (!p || p->state == PROCESS_EMPTY || p->state == PROCESS_ZOMBIE) {
+        return -1;
+    }
+    p->base_priority = priority;
+    mutex_update_priority(p);
+    return 0;
 }
 
 // Get current process
 process_t* process_get_current(void) {
     return current_process_ptr;
 }
+
+// Ask for a reschedule at the next IRQ exit or preemption point
+void process_set_need_resched(void) {
+    if (!need_resched) {
+        resched_requested_at = rdtsc();
+        need_resched = 1;
+    }
+}
+
+int process_need_resched(void) {
+    return need_resched;
+}
+
+// Worst-case cycles between a reschedule request and schedule() running
+uint32_t process_get_max_resched_latency(void) {
+    return max_resched_latency;
+}
+
+// Halt until the next interrupt, charging the time to idle.
+// Must be called with interrupts disabled; returns with them disabled.
+void process_idle(void) {
+    cpu_idle = 1;
+    asm volatile ("sti; hlt; cli" : : : "memory");
+    cpu_idle = 0;
+}
+
+// Called from the timer interrupt on every tick
+void process_timer_tick(uint32_t now) {
+    if (cpu_idle) {
+        idle_ticks++;
+    }
+
+    // Wake timed sleepers whose deadline passed; wait_finish() takes
+    // them off their wait queue
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        process_t* p = &processes[i];
+        if (p->timer_armed && p->state == PROCESS_BLOCKED &&
+            (int32_t)(now - p->wake_deadline) >= 0) {
+            p->timer_armed = 0;
+            process_set_state(p, PROCESS_READY);
+        }
+    }
+}
+
+// Number of timer ticks that arrived while the CPU was idle
+uint32_t process_get_idle_ticks(void) {
+    return idle_ticks;
+}
@@ -3,10 +3,14 @@
 
 #include <stdint.h>
 #include "context.h"
+#include "fpu.h"
+#include "../include/wait.h"
+#include "../include/file.h"
 
 #define MAX_PROCESSES 8
 #define MAX_PROCESS_NAME 32
 #define STACK_SIZE 4096
+#define THREAD_TLS_SIZE 4096  // TLS segment limit for threads created by syscall
 
 typedef enum {
     PROCESS_EMPTY = 0,
@@ -16,14 +20,62 @@ typedef enum {
     PROCESS_ZOMBIE
 } process_state_t;
 
-typedef struct {
+#define SCHED_LAT_BUCKETS 32  // log2(cycles) latency histogram
+
+// Per-task scheduler accounting, in TSC cycles
+typedef struct sched_stats {
+    uint64_t state_since;        // TSC of the last state change
+    uint64_t time_running;
+    uint64_t time_ready;         // Waiting on the run queue
+    uint64_t time_blocked;
+    uint64_t total_latency;      // Sum of READY-to-RUNNING waits
+    uint32_t max_latency;
+    uint32_t runs;               // READY-to-RUNNING transitions
+    uint32_t wakeups;            // BLOCKED-to-READY transitions
+    uint32_t voluntary_switches;   // Blocked, yielded or exited
+    uint32_t involuntary_switches; // Preempted while runnable
+    uint32_t latency_hist[SCHED_LAT_BUCKETS];  // Bucket n: [2^n, 2^(n+1)) cycles
+} sched_stats_t;
+
+// Resources shared by every thread of a process
+typedef struct proc_shared {
+    int tgid;                    // Process id: tid of the first thread
+    int nr_threads;              // Live threads; the slot is free at zero
+    uint32_t cr3;                // Page directory (0: kernel directory)
+    uint32_t uid;                // Credentials
+    uint32_t gid;
+    struct uring* uring;         // Submission/completion rings, if set up
+    struct trace_ring* trace;    // Syscall trace records, if traced
+    struct ipc_mailbox* mailbox; // IPC messages, created on first use
+    struct file* fds[MAX_FDS];   // Descriptor table
+} proc_shared_t;
+
+// One schedulable thread. Single-threaded processes have exactly one;
+// pid is the thread id and tgid the id of the owning process.
+typedef struct process {
     int pid;
+    int tgid;
+    proc_shared_t* shared;
     char name[MAX_PROCESS_NAME];
     process_state_t state;
-    uint32_t priority;
+    uint32_t priority;           // Effective priority (higher runs first)
+    uint32_t base_priority;      // Priority without inheritance boosts
+    struct mutex* held_mutexes;  // Mutexes owned, for dropping boosts
+    struct mutex* blocked_on;    // Mutex this task sleeps on, if any
     uint32_t runtime;
+    volatile int preempt_count;  // Non-zero: must not be preempted
     uint8_t stack[STACK_SIZE];
     cpu_context_t context;
+    uint32_t tls_base;           // TLS segment loaded into %gs (limit 0: none)
+    uint32_t tls_limit;
+    uint8_t joinable;            // Slot kept as a zombie until joined
+    int exit_status;
+    wait_queue_t exit_wait;      // Joiners sleep here
+    uint32_t wake_deadline;      // Timer tick ending a timed sleep
+    uint8_t timer_armed;         // wake_deadline is in force
+    sched_stats_t sched;
+    uint8_t fpu_used;            // Has touched the FPU; fpu_state is valid
+    uint8_t fpu_state[FPU_STATE_SIZE] __attribute__((aligned(16)));
 } process_t;
 
 void process_init(void);
@@ -32,6 +84,25 @@ void process_exit(int status);
 process_t* process_get(int pid);
 void process_print_list(void);
 void schedule(void);
+void process_handoff(process_t* next);
+void process_set_state(process_t* p, process_state_t state);
+void process_print_schedstat(void);
+int process_set_priority(int pid, uint32_t priority);
 process_t* process_get_current(void);
 
+// Threads share the creating process's address space and credentials
+int thread_create(void (*entry_point)(void*), void* arg, uint32_t tls_base, uint32_t tls_limit);
+int thread_join(int tid, int* status);
+void thread_exit(int status);
+
+// Deferred rescheduling from interrupt context
+void process_set_need_resched(void);
+int process_need_resched(void);
+uint32_t process_get_max_resched_latency(void);
+
+// Idle time accounting and timed-sleep expiry
+void process_idle(void);
+void process_timer_tick(uint32_t now);
+uint32_t process_get_idle_ticks(void);
+
 #endif
@@ -0,0 +1,144 @@
+#include "../include/filesystem.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "RAMFS Test: "
+#include "test_output.h"
+
+#define RAMFS_TEST_FILES 24
+
+static void test_name(char* buf, uint32_t i) {
+    memcpy(buf, "/idx_", 5);
+    buf[5] = (char)('a' + i / 10);
+    buf[6] = (char)('0' + i % 10);
+    buf[7] = '\0';
+}
+
+static int try_open(const char* path, uint32_t flags) {
+    uint32_t fd = syscall(SYS_OPEN, (uint32_t)path, flags, 0);
+    if (fd == (uint32_t)SYS_ERROR) {
+        return 0;
+    }
+    syscall(SYS_CLOSE, fd, 0, 0);
+    return 1;
+}
+
+// Filename index and page-backed file test process
+void ramfs_test_process(void) {
+    char msg[] = "RAMFS Test: Filename index test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    char name[8];
+    int created = 1;
+    for (uint32_t i = 0; i < RAMFS_TEST_FILES; i++) {
+        test_name(name, i);
+        created &= try_open(name, O_RDWR | O_CREAT);
+    }
+    report(created, "create");
+
+    // Every other file goes; the rest must still be found
+    int removed = 1;
+    for (uint32_t i = 0; i < RAMFS_TEST_FILES; i += 2) {
+        test_name(name, i);
+        removed &= syscall(SYS_UNLINK, (uint32_t)name, 0, 0) == SYS_SUCCESS;
+    }
+    report(removed, "unlink");
+
+    int lookups = 1;
+    for (uint32_t i = 0; i < RAMFS_TEST_FILES; i++) {
+        test_name(name, i);
+        lookups &= try_open(name, O_RDONLY) == (int)(i & 1);
+    }
+    report(lookups, "lookup after unlink");
+    report(syscall(SYS_UNLINK, (uint32_t)"/idx_a0", 0, 0) == (uint32_t)SYS_ERROR, "double unlink rejected");
+    report(try_open("/hello.txt", O_RDONLY), "built-in file still found");
+
+    // Freed slots are reused
+    int reused = 1;
+    for (uint32_t i = 0; i < RAMFS_TEST_FILES; i += 2) {
+        test_name(name, i);
+        reused &= try_open(name, O_RDWR | O_CREAT);
+    }
+    report(reused, "recreate");
+
+    for (uint32_t i = 0; i < RAMFS_TEST_FILES; i++) {
+        test_name(name, i);
+        syscall(SYS_UNLINK, (uint32_t)name, 0, 0);
+    }
+
+    // File data lives in pages allocated on write
+    ramfs_stats_t base, st;
+    syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&base, 0);
+    int fd = (int)syscall(SYS_OPEN, (uint32_t)"/pages.bin", O_RDWR | O_CREAT, 0);
+    report(fd >= 3, "open page file");
+    if (fd >= 3) {
+        static uint8_t block[3 * 4096 + 10];
+        for (uint32_t i = 0; i < sizeof(block); i++) {
+            block[i] = (uint8_t)(i * 7);
+        }
+        report(syscall(SYS_WRITE, fd, (uint32_t)block, sizeof(block)) == sizeof(block),
+               "write past 4KB");
+        syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+        report(st.data_pages == base.data_pages + 4, "pages track size");
+
+        // A byte far out leaves a hole that costs nothing
+        uint32_t far = 40 * 4096;
+        report(syscall4(SYS_PWRITE, fd, (uint32_t)"Z", 1, far) == 1, "sparse write");
+        syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+        report(st.data_pages == base.data_pages + 5 && st.index_pages == base.index_pages + 1,
+               "hole not allocated");
+
+        uint8_t check[16];
+        memset(check, 0xFF, sizeof(check));
+        syscall4(SYS_PREAD, fd, (uint32_t)check, sizeof(check), 20 * 4096);
+        int zeros = 1;
+        for (uint32_t i = 0; i < sizeof(check); i++) {
+            zeros &= check[i] == 0;
+        }
+        report(zeros, "hole reads as zeros");
+
+        memset(check, 0, sizeof(check));
+        syscall4(SYS_PREAD, fd, (uint32_t)check, sizeof(check), 4096 - 8);
+        int same = 1;
+        for (uint32_t i = 0; i < sizeof(check); i++) {
+            same &= check[i] == (uint8_t)((4096 - 8 + i) * 7);
+        }
+        report(same, "read across pages");
+
+        report(syscall(SYS_FTRUNCATE, fd, 100, 0) == SYS_SUCCESS, "truncate");
+        syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+        report(st.data_pages == base.data_pages + 1 && st.index_pages == base.index_pages,
+               "truncate frees pages");
+        syscall(SYS_CLOSE, fd, 0, 0);
+    }
+    syscall(SYS_UNLINK, (uint32_t)"/pages.bin", 0, 0);
+    syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+    report(st.data_pages == base.data_pages && st.files == base.files, "unlink frees pages");
+
+    // An unlinked file lives on behind its open descriptor, and a file
+    // created after it gets a different slot
+    fd = (int)syscall(SYS_OPEN, (uint32_t)"/doomed.txt", O_RDWR | O_CREAT, 0);
+    syscall(SYS_WRITE, fd, (uint32_t)"old", 3);
+    report(syscall(SYS_UNLINK, (uint32_t)"/doomed.txt", 0, 0) == SYS_SUCCESS &&
+           !try_open("/doomed.txt", O_RDONLY), "unlink while open");
+    int other = (int)syscall(SYS_OPEN, (uint32_t)"/doomed.txt", O_RDWR | O_CREAT, 0);
+    syscall(SYS_WRITE, other, (uint32_t)"new", 3);
+    char old[4] = { 0 };
+    syscall4(SYS_PREAD, fd, (uint32_t)old, 3, 0);
+    report(memcmp(old, "old", 3) == 0, "open fd keeps unlinked data");
+    syscall(SYS_CLOSE, other, 0, 0);
+    syscall(SYS_UNLINK, (uint32_t)"/doomed.txt", 0, 0);
+    syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+    report(st.files == base.files + 1, "slot held until close");
+    syscall(SYS_CLOSE, fd, 0, 0);
+    syscall(SYS_GET_STATS, STATS_RAMFS, (uint32_t)&st, 0);
+    report(st.files == base.files && st.data_pages == base.data_pages, "last close frees");
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
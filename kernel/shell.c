@@ -3,26 +3,30 @@
 #include "../include/string.h"
 #include "io.h"
 #include "../include/idt.h"
+#include "../include/spinlock.h"
+#include "../include/mutex.h"
+#include "../include/console.h"
+#include "../include/preempt.h"
+#include "context.h"
+#include "fpu.h"
+#include "../include/systrace.h"
+#include "../include/ipc.h"
 
 shell_state_t shell_state;
 command_history_t history;
 
-extern char keyboard_getchar(void);
 extern void serial_putchar(uint16_t com, char c);
 extern void enable_interrupts(void);
 extern int vga_get_cursor_y(void);
 extern void process_print_list(void);
+extern void process_print_schedstat(void);
 extern uint32_t timer_get_ticks(void);
+extern uint32_t process_get_idle_ticks(void);
 
 static void serial_print(const char* str) {
     // Temporarily disabled to prevent potential hangs on hardware polling
 }
 
-static char shell_serial_getchar(void) {
-    if (inb(0x3F8 + 5) & 1) return inb(0x3F8);
-    return 0;
-}
-
 static void shell_print(const char* str) {
     vga_print(str);
     serial_print(str);
@@ -56,6 +60,14 @@ void shell_execute_command(const char* command) {
         shell_print("  whoami    - Show current user\n");
         shell_print("  ver       - Show OS version\n");
         shell_print("  uptime    - Show system uptime\n");
+        shell_print("  lockstat  - Show lock statistics\n");
+        shell_print("  latency   - Show max preemption latency\n");
+        shell_print("  ctxbench  - Measure context switch cost\n");
+        shell_print("  schedstat - Show scheduler statistics\n");
+        shell_print("  sysstat   - Show per-syscall call counts and cycles\n");
+        shell_print("  constat   - Show console output statistics\n");
+        shell_print("  ipcbench  - Compare mailbox and call/reply round trips\n");
+        shell_print("  strace [on|off] <pid> - Trace a process / dump its trace\n");
         shell_print("  testcmd   - Run test command\n");
     } else if (strcmp(command, "clear") == 0) {
         vga_clear();
@@ -73,7 +85,83 @@ void shell_execute_command(const char* command) {
         shell_print("Uptime: ");
         itoa((int)timer_get_ticks(), buf, 10);
         shell_print(buf);
-        shell_print(" ticks\n");
+        shell_print(" ticks (idle: ");
+        itoa((int)process_get_idle_ticks(), buf, 10);
+        shell_print(buf);
+        shell_print(")\n");
+    } else if (strcmp(command, "lockstat") == 0) {
+        lock_stats_dump();
+        mutex_stats_dump();
+    } else if (strcmp(command, "latency") == 0) {
+        char buf[16];
+        shell_print("Max preemption latency: ");
+        itoa((int)preempt_get_max_latency(), buf, 10);
+        shell_print(buf);
+        shell_print(" cycles\n");
+    } else if (strcmp(command, "schedstat") == 0) {
+        process_print_schedstat();
+    } else if (strcmp(command, "sysstat") == 0) {
+        systrace_dump_counters();
+    } else if (strcmp(command, "ipcbench") == 0) {
+        ipc_bench_t bench;
+        char buf[16];
+        if (ipc_pingpong_benchmark(1000, &bench) != 0) {
+            shell_print("IPC benchmark failed\n");
+        } else {
+            shell_print("Round trip: mailbox ");
+            itoa((int)bench.mailbox_cycles, buf, 10);
+            shell_print(buf);
+            shell_print(" cycles, call/reply ");
+            itoa((int)bench.call_cycles, buf, 10);
+            shell_print(buf);
+            shell_print(" cycles (");
+            itoa((int)bench.handoffs, buf, 10);
+            shell_print(buf);
+            shell_print(" direct handoffs)\n");
+        }
+    } else if (strcmp(command, "constat") == 0) {
+        console_stats_t st;
+        char buf[16];
+        console_get_stats(&st);
+        shell_print("Console: ");
+        itoa((int)st.bytes_written, buf, 10);
+        shell_print(buf);
+        shell_print(" bytes in ");
+        itoa((int)st.vga_flushes, buf, 10);
+        shell_print(buf);
+        shell_print(" VGA flushes, serial ");
+        itoa((int)st.serial_interrupts, buf, 10);
+        shell_print(buf);
+        shell_print(" THRE irqs, ");
+        itoa((int)st.serial_stalls, buf, 10);
+        shell_print(buf);
+        shell_print(" stalls, ");
+        itoa((int)st.serial_dropped, buf, 10);
+        shell_print(buf);
+        shell_print(" dropped\n");
+    } else if (strncmp(command, "strace on ", 10) == 0) {
+        shell_print(systrace_enable(atoi(command + 10), 1) == 0 ? "Tracing\n" : "No such process\n");
+    } else if (strncmp(command, "strace off ", 11) == 0) {
+        shell_print(systrace_enable(atoi(command + 11), 0) == 0 ? "Tracing stopped\n" : "No such process\n");
+    } else if (strncmp(command, "strace ", 7) == 0) {
+        systrace_dump_trace(atoi(command + 7));
+    } else if (strcmp(command, "ctxbench") == 0) {
+        char buf[16];
+        context_bench_t bench;
+        context_switch_benchmark(10000, &bench);
+        shell_print("Context switch: ");
+        itoa((int)bench.switch_cycles, buf, 10);
+        shell_print(buf);
+        shell_print(" cycles, full-frame switch ");
+        itoa((int)bench.full_switch_cycles, buf, 10);
+        shell_print(buf);
+        shell_print(" (eager FPU save/restore would add ");
+        itoa((int)fpu_save_restore_cycles(), buf, 10);
+        shell_print(buf);
+        shell_print(", lazy restores so far: ");
+        itoa((int)fpu_get_restore_count(), buf, 10);
+        shell_print(buf);
+        shell_print(")\n");
     } else if (strcmp(command, "testcmd") == 0) {
         shell_print("Test command executed!\n");
     } else if (strlen(command) > 0) {
@@ -86,6 +174,7 @@ void shell_execute_command(const char* command) {
 void shell_run(void) {
     char input_buffer[SHELL_BUFFER_SIZE];
     int buffer_pos = 0;
+    int last_was_cr = 0;
     char c;
     
     while (1) {
@@ -106,15 +195,15 @@ void shell_run(void) {
         memset(input_buffer, 0, SHELL_BUFFER_SIZE);
         
         while (1) {
-            c = keyboard_getchar(); 
-            if (c == 0) {
-                c = shell_serial_getchar();
-            }
+            // Sleeps until keyboard or serial input arrives
+            c = console_getchar();
 
-            if (c == 0) {
-                __asm__ volatile("pause"); 
+            // Swallow the \n of a CRLF sequence; the \r already ended the line
+            if (c == '\n' && last_was_cr) {
+                last_was_cr = 0;
                 continue;
             }
+            last_was_cr = (c == '\r');
 
             if (c == '\n' || c == '\r') {
                 vga_putchar('\n');
@@ -128,11 +217,6 @@ void shell_run(void) {
                 if (buffer_pos > 0) {
                     shell_execute_command(input_buffer);
                 }
-
-                // Drain potential \n after \r (common CRLF sequence)
-                if (c == '\r' && shell_serial_getchar() == '\n') {
-                    // consumed
-                }
                 break;
             } else if (c == '\b' || (uint8_t)c == 0x7F) {
                 if (buffer_pos > 0) {
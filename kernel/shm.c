@@ -0,0 +1,200 @@
+#include "../include/shm.h"
+#include "../include/memory.h"
+#include "../include/spinlock.h"
+#include "process.h"
+#include "string.h"
+
+typedef struct {
+    uint8_t used;
+    uint32_t key;
+    uint32_t pages;
+    uint32_t attachments;
+    uint32_t frames[SHM_MAX_PAGES];
+} shm_segment_t;
+
+typedef struct {
+    proc_shared_t* owner;        // NULL: slot free
+    shm_segment_t* segment;
+    uint32_t addr;
+} shm_attach_t;
+
+#define SHM_PAGE_FLAGS (PAGE_PRESENT | PAGE_WRITE | PAGE_USER)
+
+static shm_segment_t segments[SHM_MAX_SEGMENTS];
+static shm_attach_t attachments[SHM_MAX_ATTACH];
+static vm_window_t shm_window;
+static spinlock_t shm_lock;  // Protects segments, attachments and the window
+
+void shm_init(void) {
+    spin_lock_init(&shm_lock, "shm");
+    memset(segments, 0, sizeof(segments));
+    memset(attachments, 0, sizeof(attachments));
+    vm_window_init(&shm_window, SHM_WINDOW_BASE);
+}
+
+// Called with shm_lock held
+static void segment_free_locked(shm_segment_t* seg) {
+    for (uint32_t i = 0; i < seg->pages; i++) {
+        free_page(seg->frames[i]);
+    }
+    seg->used = 0;
+}
+
+int shm_create(uint32_t key, uint32_t size) {
+    uint32_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (pages == 0 || pages > SHM_MAX_PAGES) {
+        return -1;
+    }
+
+    int id = -1;
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    if (key != SHM_KEY_PRIVATE) {
+        for (int i = 0; i < SHM_MAX_SEGMENTS; i++) {
+            if (segments[i].used && segments[i].key == key) {
+                id = (segments[i].pages >= pages) ? i : -2;
+                break;
+            }
+        }
+    }
+    if (id == -1) {
+        for (int i = 0; i < SHM_MAX_SEGMENTS; i++) {
+            if (!segments[i].used) {
+                id = i;
+                break;
+            }
+        }
+        shm_segment_t* seg = (id >= 0) ? &segments[id] : NULL;
+        if (seg) {
+            seg->used = 1;
+            seg->key = key;
+            seg->attachments = 0;
+            seg->pages = 0;
+            while (seg->pages < pages) {
+                uint32_t phys = alloc_page();
+                if (!phys) {
+                    segment_free_locked(seg);
+                    id = -1;
+                    break;
+                }
+                // Frames below 4MB are reachable through the identity map
+                memset((void*)phys, 0, PAGE_SIZE);
+                seg->frames[seg->pages++] = phys;
+            }
+        }
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+    return (id >= 0) ? id : -1;
+}
+
+int shm_remove(int id) {
+    if (id < 0 || id >= SHM_MAX_SEGMENTS) {
+        return -1;
+    }
+
+    int result = -1;
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    shm_segment_t* seg = &segments[id];
+    if (seg->used) {
+        seg->key = SHM_KEY_PRIVATE;
+        if (seg->attachments == 0) {
+            segment_free_locked(seg);
+        }
+        result = 0;
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+    return result;
+}
+
+void* shm_attach(proc_shared_t* owner, int id) {
+    if (!owner || id < 0 || id >= SHM_MAX_SEGMENTS) {
+        return NULL;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    shm_segment_t* seg = &segments[id];
+    shm_attach_t* at = NULL;
+    for (int i = 0; i < SHM_MAX_ATTACH && seg->used; i++) {
+        if (!attachments[i].owner) {
+            at = &attachments[i];
+            break;
+        }
+    }
+    uint32_t addr = at ? vm_window_alloc(&shm_window, seg->pages) : 0;
+    if (addr) {
+        for (uint32_t i = 0; i < seg->pages; i++) {
+            map_page(addr + i * PAGE_SIZE, seg->frames[i], SHM_PAGE_FLAGS);
+        }
+        at->owner = owner;
+        at->segment = seg;
+        at->addr = addr;
+        seg->attachments++;
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+    return (void*)addr;
+}
+
+// Called with shm_lock held
+static void detach_locked(shm_attach_t* at) {
+    shm_segment_t* seg = at->segment;
+    for (uint32_t i = 0; i < seg->pages; i++) {
+        unmap_page(at->addr + i * PAGE_SIZE);
+    }
+    vm_window_free(&shm_window, at->addr, seg->pages);
+    at->owner = NULL;
+    if (--seg->attachments == 0) {
+        segment_free_locked(seg);
+    }
+}
+
+int shm_detach(proc_shared_t* owner, void* addr) {
+    int result = -1;
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    for (int i = 0; i < SHM_MAX_ATTACH; i++) {
+        if (attachments[i].owner && attachments[i].owner == owner &&
+            attachments[i].addr == (uint32_t)addr) {
+            detach_locked(&attachments[i]);
+            result = 0;
+            break;
+        }
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+    return result;
+}
+
+// The owning process is gone
+void shm_release(proc_shared_t* owner) {
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    for (int i = 0; i < SHM_MAX_ATTACH; i++) {
+        if (attachments[i].owner == owner) {
+            detach_locked(&attachments[i]);
+        }
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+}
+
+uint32_t shm_phys_addr(uint32_t addr) {
+    if (addr < SHM_WINDOW_BASE || addr >= SHM_WINDOW_BASE + VM_WINDOW_PAGES * PAGE_SIZE) {
+        return 0;
+    }
+    return get_phys_addr(addr);
+}
+
+void shm_get_stats(shm_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(shm_stats_t));
+    uint32_t flags = spin_lock_irqsave(&shm_lock);
+    for (int i = 0; i < SHM_MAX_SEGMENTS; i++) {
+        if (segments[i].used) {
+            stats->segments++;
+            stats->pages += segments[i].pages;
+        }
+    }
+    for (int i = 0; i < SHM_MAX_ATTACH; i++) {
+        if (attachments[i].owner) {
+            stats->attachments++;
+        }
+    }
+    spin_unlock_irqrestore(&shm_lock, flags);
+}
@@ -0,0 +1,115 @@
+#include "../include/shm.h"
+#include "../include/spsc.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_PREFIX "SHM Test: "
+#include "test_output.h"
+
+#define SHM_TEST_KEY     0x5350
+#define SHM_TEST_RECORDS 1000
+#define SHM_TEST_SIZE    8192
+
+typedef struct {
+    uint32_t seq;
+    uint32_t value;
+} record_t;
+
+// Producer thread: attaches the segment at its own address and sends
+// the records in batches of eight
+static void producer_thread(void* arg) {
+    (void)arg;
+    uint32_t id = syscall(SYS_SHM_CREATE, SHM_TEST_KEY, SHM_TEST_SIZE, 0);
+    void* mem = (void*)syscall(SYS_SHM_ATTACH, id, 0, 0);
+
+    spsc_producer_t p;
+    if (spsc_producer_init(&p, mem) == 0) {
+        for (uint32_t i = 0; i < SHM_TEST_RECORDS; i++) {
+            record_t r = { i, i * 3 };
+            while (spsc_push(&p, &r) != 0) {
+                spsc_wait_space(&p);
+            }
+            if ((i & 7) == 7) {
+                spsc_publish(&p);
+            }
+        }
+        spsc_publish(&p);
+    }
+    syscall(SYS_SHM_DETACH, (uint32_t)mem, 0, 0);
+    syscall(SYS_THREAD_EXIT, 0, 0, 0);
+}
+
+// Shared memory and SPSC channel test process
+void shm_test_process(void) {
+    char msg[] = "SHM Test: Shared memory channel test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    uint32_t id = syscall(SYS_SHM_CREATE, SHM_TEST_KEY, SHM_TEST_SIZE, 0);
+    report(id != (uint32_t)SYS_ERROR, "create");
+    report(syscall(SYS_SHM_CREATE, SHM_TEST_KEY, SHM_TEST_SIZE, 0) == id, "same key same segment");
+
+    void* mem = (void*)syscall(SYS_SHM_ATTACH, id, 0, 0);
+    report((uint32_t)mem != (uint32_t)SYS_ERROR, "attach");
+    if ((uint32_t)mem == (uint32_t)SYS_ERROR) {
+        goto idle;
+    }
+
+    // A second mapping of the same frames
+    uint32_t* alias = (uint32_t*)syscall(SYS_SHM_ATTACH, id, 0, 0);
+    ((volatile uint32_t*)mem)[0] = 0x12345678;
+    report((uint32_t)alias != (uint32_t)mem && alias[0] == 0x12345678, "second mapping");
+    syscall(SYS_SHM_DETACH, (uint32_t)alias, 0, 0);
+
+    int capacity = spsc_init(mem, SHM_TEST_SIZE, sizeof(record_t));
+    report(capacity == 512, "ring format");
+
+    spsc_consumer_t c;
+    spsc_consumer_init(&c, mem);
+    int producer = (int)syscall(SYS_THREAD_CREATE, (uint32_t)producer_thread, 0, 0);
+    report(producer > 0, "producer thread");
+
+    // Records arrive in order; slots go back in batches
+    uint32_t expected = 0;
+    int in_order = 1;
+    while (producer > 0 && expected < SHM_TEST_RECORDS) {
+        const record_t* r = spsc_peek(&c);
+        if (!r) {
+            spsc_wait_data(&c);
+            continue;
+        }
+        if (r->seq != expected || r->value != expected * 3) {
+            in_order = 0;
+        }
+        expected++;
+        spsc_next(&c);
+        if ((expected & 15) == 0) {
+            spsc_release(&c);
+        }
+    }
+    spsc_release(&c);
+    report(in_order && expected == SHM_TEST_RECORDS, "records in order");
+
+    shm_stats_t st;
+    syscall(SYS_GET_STATS, STATS_SHM, (uint32_t)&st, 0);
+    report(st.segments >= 1 && st.attachments >= 1, "stats");
+    report(syscall(SYS_SHM_DETACH, (uint32_t)mem, 0, 0) == SYS_SUCCESS, "detach");
+    report(syscall(SYS_SHM_DETACH, (uint32_t)mem, 0, 0) == (uint32_t)SYS_ERROR, "double detach rejected");
+
+    // A segment nobody attached is only freed by removing it
+    shm_stats_t before, after;
+    syscall(SYS_GET_STATS, STATS_SHM, (uint32_t)&before, 0);
+    id = syscall(SYS_SHM_CREATE, SHM_KEY_PRIVATE, SHM_TEST_SIZE, 0);
+    report(syscall(SYS_SHM_REMOVE, id, 0, 0) == SYS_SUCCESS, "remove");
+    syscall(SYS_GET_STATS, STATS_SHM, (uint32_t)&after, 0);
+    report(after.pages == before.pages &&
+           syscall(SYS_SHM_ATTACH, id, 0, 0) == (uint32_t)SYS_ERROR, "removed segment freed");
+
+idle:
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
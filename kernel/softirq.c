@@ -0,0 +1,139 @@
+#include "../include/softirq.h"
+#include "../include/spinlock.h"
+#include "../include/preempt.h"
+#include "process.h"
+
+// Restart do_softirq() at most this many times per IRQ exit, so a flood
+// of raises cannot starve process context
+#define MAX_SOFTIRQ_RESTART 8
+
+static softirq_handler_t softirq_vec[NR_SOFTIRQS];
+static volatile uint32_t softirq_pending = 0;
+static volatile uint32_t irq_nesting = 0;
+static volatile int softirq_running = 0;
+
+// Pending tasklets, run in FIFO order
+static tasklet_t* tasklet_head = NULL;
+static tasklet_t* tasklet_tail = NULL;
+static spinlock_t tasklet_lock;
+
+static void tasklet_action(void);
+
+void softirq_init(void) {
+    for (int i = 0; i < NR_SOFTIRQS; i++) {
+        softirq_vec[i] = NULL;
+    }
+    softirq_pending = 0;
+    irq_nesting = 0;
+    softirq_running = 0;
+
+    spin_lock_init(&tasklet_lock, "tasklets");
+    tasklet_head = NULL;
+    tasklet_tail = NULL;
+    open_softirq(SOFTIRQ_TASKLET, tasklet_action);
+}
+
+void open_softirq(uint32_t nr, softirq_handler_t handler) {
+    if (nr < NR_SOFTIRQS) {
+        softirq_vec[nr] = handler;
+    }
+}
+
+// Mark a softirq pending. Cheap enough for top halves: one locked OR.
+void raise_softirq(uint32_t nr) {
+    if (nr < NR_SOFTIRQS) {
+        asm volatile ("lock orl %1, %0" : "+m"(softirq_pending) : "r"(1u << nr) : "memory");
+    }
+}
+
+void irq_enter(void) {
+    irq_nesting++;
+}
+
+int in_interrupt(void) {
+    return irq_nesting > 0 || softirq_running;
+}
+
+// Run pending bottom halves. Entered with interrupts disabled; handlers
+// run with interrupts enabled so new IRQs are not delayed behind them.
+static void do_softirq(void) {
+    int restart = MAX_SOFTIRQ_RESTART;
+
+    softirq_running = 1;
+    while (softirq_pending && restart-- > 0) {
+        uint32_t pending;
+        // Atomically take the whole pending mask
+        pending = 0;
+        asm volatile ("xchgl %0, %1" : "+r"(pending), "+m"(softirq_pending) : : "memory");
+
+        asm volatile ("sti" : : : "memory");
+        for (uint32_t nr = 0; pending; nr++, pending >>= 1) {
+            if ((pending & 1) && softirq_vec[nr]) {
+                softirq_vec[nr]();
+            }
+        }
+        asm volatile ("cli" : : : "memory");
+    }
+    softirq_running = 0;
+}
+
+void irq_exit(void) {
+    irq_nesting--;
+
+    // Only the outermost IRQ processes bottom halves, and never recursively
+    if (irq_nesting != 0 || softirq_running) {
+        return;
+    }
+    if (softirq_pending) {
+        do_softirq();
+    }
+
+    // Reschedule only after bottom halves are done, so a context switch
+    // never happens with softirq_running set, and never while the
+    // interrupted task is inside a preempt-disabled section: it will
+    // reschedule itself from preempt_enable()
+    if (process_need_resched() && preempt_count() == 0) {
+        schedule();
+    }
+}
+
+void tasklet_init(tasklet_t* t, void (*func)(uint32_t), uint32_t data) {
+    t->func = func;
+    t->data = data;
+    t->scheduled = 0;
+    t->next = NULL;
+}
+
+// Queue a tasklet; safe from interrupt handlers
+void tasklet_schedule(tasklet_t* t) {
+    uint32_t flags = spin_lock_irqsave(&tasklet_lock);
+    if (!t->scheduled) {
+        t->scheduled = 1;
+        t->next = NULL;
+        if (tasklet_tail) {
+            tasklet_tail->next = t;
+        } else {
+            tasklet_head = t;
+        }
+        tasklet_tail = t;
+        raise_softirq(SOFTIRQ_TASKLET);
+    }
+    spin_unlock_irqrestore(&tasklet_lock, flags);
+}
+
+static void tasklet_action(void) {
+    // Detach the current list so tasklets may reschedule themselves
+    uint32_t flags = spin_lock_irqsave(&tasklet_lock);
+    tasklet_t* list = tasklet_head;
+    tasklet_head = NULL;
+    tasklet_tail = NULL;
+    spin_unlock_irqrestore(&tasklet_lock, flags);
+
+    while (list) {
+        tasklet_t* t = list;
+        list = list->next;
+        t->next = NULL;
+        t->scheduled = 0;
+        t->func(t->data);
+    }
+}
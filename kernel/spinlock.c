@@ -0,0 +1,85 @@
+#include "../include/spinlock.h"
+#include "../drivers/vga.h"
+#include "string.h"
+
+#ifdef LOCK_STATS
+// Registry of named locks, linked through their stats blocks
+static lock_stats_t* lock_registry = NULL;
+static spinlock_t registry_lock;
+#endif
+
+void spin_lock_init(spinlock_t* lock, const char* name) {
+    lock->next = 0;
+    lock->owner = 0;
+#ifdef LOCK_STATS
+    uint8_t registered = lock->stats.registered;
+    lock_stats_t* next = lock->stats.next;
+    memset(&lock->stats, 0, sizeof(lock_stats_t));
+    lock->stats.name = name ? name : "anon";
+
+    if (registered) {
+        // Re-initialized lock: keep its place in the registry
+        lock->stats.registered = 1;
+        lock->stats.next = next;
+        return;
+    }
+
+    if (lock != &registry_lock) {
+        uint32_t flags = spin_lock_irqsave(&registry_lock);
+        lock->stats.next = lock_registry;
+        lock_registry = &lock->stats;
+        lock->stats.registered = 1;
+        spin_unlock_irqrestore(&registry_lock, flags);
+    }
+#else
+    (void)name;
+#endif
+}
+
+#ifdef LOCK_STATS
+void lock_stat_acquired(spinlock_t* lock, int contended) {
+    lock->stats.acquisitions++;
+    if (contended) {
+        lock->stats.contentions++;
+    }
+    lock->stats.acquired_at = rdtsc();
+}
+
+void lock_stat_released(spinlock_t* lock) {
+    uint64_t elapsed = rdtsc() - lock->stats.acquired_at;
+    uint32_t held = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    lock->stats.hold_cycles += held;
+    if (held > lock->stats.max_hold_cycles) {
+        lock->stats.max_hold_cycles = held;
+    }
+}
+#endif
+
+void lock_stats_dump(void) {
+#ifdef LOCK_STATS
+    char buf[16];
+    vga_print("  NAME              ACQUIRED  CONTENDED  AVG-CYC  MAX-CYC\n");
+    for (lock_stats_t* s = lock_registry; s; s = s->next) {
+        vga_print("  ");
+        vga_print(s->name);
+        for (int pad = strlen(s->name); pad < 18; pad++) vga_putchar(' ');
+
+        itoa((int)s->acquisitions, buf, 10);
+        vga_print(buf);
+        vga_print("  ");
+        itoa((int)s->contentions, buf, 10);
+        vga_print(buf);
+        vga_print("  ");
+
+        // Holds are clamped to 32 bits, so the average fits
+        itoa(s->acquisitions ? (int)div64_32(s->hold_cycles, s->acquisitions) : 0, buf, 10);
+        vga_print(buf);
+        vga_print("  ");
+        itoa((int)s->max_hold_cycles, buf, 10);
+        vga_print(buf);
+        vga_print("\n");
+    }
+#else
+    vga_print("Lock statistics disabled (rebuild with LOCK_STATS=1)\n");
+#endif
+}
@@ -0,0 +1,156 @@
+#include "../include/spsc.h"
+#include "../include/futex.h"
+#include "../include/syscall.h"
+#include "string.h"
+
+// x86 keeps stores in order and loads in order, so publishing an index
+// after the data it covers only needs the compiler held back. A store
+// followed by a load of the peer's flag can still be reordered, which
+// the sleep/wake handshake below closes with a locked exchange.
+#define compiler_barrier() asm volatile ("" : : : "memory")
+
+static inline uint32_t atomic_xchg(volatile uint32_t* ptr, uint32_t val) {
+    asm volatile ("xchgl %0, %1" : "+r"(val), "+m"(*ptr) : : "memory");
+    return val;
+}
+
+static inline uint8_t* slot(spsc_ring_t* ring, uint32_t index) {
+    return (uint8_t*)ring + ring->slots + (index & ring->mask) * ring->record_size;
+}
+
+int spsc_init(void* mem, uint32_t size, uint32_t record_size) {
+    spsc_ring_t* ring = (spsc_ring_t*)mem;
+    if (!ring || ((uint32_t)mem & (SPSC_CACHE_LINE - 1)) || record_size == 0 ||
+        size < sizeof(spsc_ring_t) + record_size) {
+        return -1;
+    }
+
+    uint32_t capacity = 1;
+    uint32_t room = (size - sizeof(spsc_ring_t)) / record_size;
+    while (capacity * 2 <= room) {
+        capacity *= 2;
+    }
+
+    memset(ring, 0, sizeof(spsc_ring_t));
+    ring->mask = capacity - 1;
+    ring->record_size = record_size;
+    ring->slots = sizeof(spsc_ring_t);
+    compiler_barrier();
+    ring->magic = SPSC_MAGIC;
+    return (int)capacity;
+}
+
+int spsc_producer_init(spsc_producer_t* p, void* mem) {
+    spsc_ring_t* ring = (spsc_ring_t*)mem;
+    if (!p || !ring || ring->magic != SPSC_MAGIC) {
+        return -1;
+    }
+    p->ring = ring;
+    p->tail = ring->tail;
+    p->head_cache = ring->head;
+    return 0;
+}
+
+int spsc_consumer_init(spsc_consumer_t* c, void* mem) {
+    spsc_ring_t* ring = (spsc_ring_t*)mem;
+    if (!c || !ring || ring->magic != SPSC_MAGIC) {
+        return -1;
+    }
+    c->ring = ring;
+    c->head = ring->head;
+    c->tail_cache = ring->tail;
+    return 0;
+}
+
+int spsc_push(spsc_producer_t* p, const void* record) {
+    spsc_ring_t* ring = p->ring;
+    if (p->tail - p->head_cache > ring->mask) {
+        // Looks full: only now touch the consumer's line
+        p->head_cache = ring->head;
+        if (p->tail - p->head_cache > ring->mask) {
+            return -1;
+        }
+    }
+    memcpy(slot(ring, p->tail), record, ring->record_size);
+    p->tail++;
+    return 0;
+}
+
+void spsc_publish(spsc_producer_t* p) {
+    spsc_ring_t* ring = p->ring;
+    if (ring->tail == p->tail) {
+        return;
+    }
+    // The exchange orders the tail store before the flag load
+    atomic_xchg(&ring->tail, p->tail);
+    if (ring->consumer_waiting) {
+        ring->consumer_waiting = 0;
+        ring->wakeups++;
+        syscall(SYS_FUTEX, (uint32_t)&ring->tail, FUTEX_WAKE, 1);
+    }
+}
+
+void spsc_wait_space(spsc_producer_t* p) {
+    spsc_ring_t* ring = p->ring;
+    spsc_publish(p);
+    while (1) {
+        uint32_t head = ring->head;
+        if (p->tail - head <= ring->mask) {
+            p->head_cache = head;
+            return;
+        }
+        // Announce the sleep, then look again: a release that missed the
+        // flag has already moved head, and FUTEX_WAIT sees it changed
+        atomic_xchg(&ring->producer_waiting, 1);
+        if (ring->head == head) {
+            syscall(SYS_FUTEX, (uint32_t)&ring->head, FUTEX_WAIT, head);
+        }
+    }
+}
+
+const void* spsc_peek(spsc_consumer_t* c) {
+    spsc_ring_t* ring = c->ring;
+    if (c->head == c->tail_cache) {
+        // Looks empty: only now touch the producer's line
+        c->tail_cache = ring->tail;
+        if (c->head == c->tail_cache) {
+            return 0;
+        }
+    }
+    compiler_barrier();  // Tail before the record
+    return slot(ring, c->head);
+}
+
+void spsc_next(spsc_consumer_t* c) {
+    c->head++;
+}
+
+void spsc_release(spsc_consumer_t* c) {
+    spsc_ring_t* ring = c->ring;
+    if (ring->head == c->head) {
+        return;
+    }
+    compiler_barrier();  // Finish reading the slots before giving them back
+    atomic_xchg(&ring->head, c->head);
+    if (ring->producer_waiting) {
+        ring->producer_waiting = 0;
+        syscall(SYS_FUTEX, (uint32_t)&ring->head, FUTEX_WAKE, 1);
+    }
+}
+
+void spsc_wait_data(spsc_consumer_t* c) {
+    spsc_ring_t* ring = c->ring;
+    spsc_release(c);
+    while (1) {
+        uint32_t tail = ring->tail;
+        if (tail != c->head) {
+            c->tail_cache = tail;
+            return;
+        }
+        atomic_xchg(&ring->consumer_waiting, 1);
+        if (ring->tail == tail) {
+            ring->sleeps++;
+            syscall(SYS_FUTEX, (uint32_t)&ring->tail, FUTEX_WAIT, tail);
+        }
+    }
+}
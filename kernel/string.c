@@ -75,6 +75,22 @@ void *memcpy(void *dest, const void *src, size_t n) {
     return dest;
 }
 
+// Memory copy that tolerates overlapping buffers
+void *memmove(void *dest, const void *src, size_t n) {
+    unsigned char *d = dest;
+    const unsigned char *s = src;
+    if (d < s) {
+        while (n--) {
+            *d++ = *s++;
+        }
+    } else {
+        while (n--) {
+            d[n] = s[n];
+        }
+    }
+    return dest;
+}
+
 // String copy with limit function
 char *strncpy(char *dest, const char *src, size_t n) {
     size_t i;
@@ -141,6 +157,23 @@ char* itoa(int value, char* str, int base) {
     return str;
 }
 
+// String to integer conversion function (decimal, optional sign)
+int atoi(const char* str) {
+    int value = 0;
+    int negative = 0;
+
+    while (*str == ' ') str++;
+    if (*str == '-' || *str == '+') {
+        negative = (*str == '-');
+        str++;
+    }
+    while (*str >= '0' && *str <= '9') {
+        value = value * 10 + (*str - '0');
+        str++;
+    }
+    return negative ? -value : value;
+}
+
 // Memory comparison function
 int memcmp(const void* ptr1, const void* ptr2, size_t size) {
     const unsigned char* p1 = ptr1;
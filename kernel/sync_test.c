@@ -0,0 +1,88 @@
+#include "../include/spinlock.h"
+#include "../include/mutex.h"
+#include "../include/syscall.h"
+#include "../include/vga.h"
+#include "../include/string.h"
+#include "process.h"
+
+static spinlock_t test_spinlock;
+static mutex_t test_mutex;
+static semaphore_t test_sem;
+static mutex_t pi_mutex;
+
+// High-priority contender for the priority inheritance test
+static void pi_waiter(void* arg) {
+    (void)arg;
+    mutex_lock(&pi_mutex);
+    mutex_unlock(&pi_mutex);
+}
+
+// Synchronization primitives test process
+void sync_test_process(void) {
+    char msg[] = "SYNC Test: Synchronization test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    // Test ticket spinlock
+    spin_lock_init(&test_spinlock, "sync_test");
+    spin_lock(&test_spinlock);
+    int nested = spin_trylock(&test_spinlock);
+    spin_unlock(&test_spinlock);
+    int reacquired = spin_trylock(&test_spinlock);
+    if (reacquired) {
+        spin_unlock(&test_spinlock);
+    }
+    if (!nested && reacquired && !spin_is_locked(&test_spinlock)) {
+        char spin_msg[] = "SYNC Test: Spinlock OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)spin_msg, sizeof(spin_msg) - 1);
+    }
+
+    // Test mutex
+    mutex_init(&test_mutex, "sync_test_mutex");
+    mutex_lock(&test_mutex);
+    int mutex_nested = mutex_trylock(&test_mutex);
+    mutex_unlock(&test_mutex);
+    if (!mutex_nested && !mutex_is_locked(&test_mutex)) {
+        char mutex_msg[] = "SYNC Test: Mutex OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)mutex_msg, sizeof(mutex_msg) - 1);
+    }
+
+    // Test semaphore counting
+    sem_init(&test_sem, 2, "sync_test_sem");
+    int first = sem_trydown(&test_sem);
+    int second = sem_trydown(&test_sem);
+    int third = sem_trydown(&test_sem);
+    sem_up(&test_sem);
+    sem_down(&test_sem);  // Must not block: count was raised to 1
+    if (first && second && !third && test_sem.count == 0) {
+        char sem_msg[] = "SYNC Test: Semaphore OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)sem_msg, sizeof(sem_msg) - 1);
+    }
+
+    // Test priority inheritance: a blocked high-priority waiter boosts us
+    mutex_init(&pi_mutex, "sync_test_pi");
+    process_t* self = process_get_current();
+    mutex_lock(&pi_mutex);
+    int waiter = thread_create(pi_waiter, NULL, 0, 0);
+    if (waiter >= 0) {
+        process_set_priority(waiter, self->base_priority + 4);
+        for (int i = 0; i < 100 && process_get(waiter)->state != PROCESS_BLOCKED; i++) {
+            syscall(SYS_YIELD, 0, 0, 0);
+        }
+    }
+    uint32_t boosted = self->priority;
+    mutex_unlock(&pi_mutex);
+    uint32_t restored = self->priority;
+    if (waiter >= 0 && thread_join(waiter, NULL) == 0 &&
+        boosted == self->base_priority + 4 && restored == self->base_priority) {
+        char pi_msg[] = "SYNC Test: Priority inheritance OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)pi_msg, sizeof(pi_msg) - 1);
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
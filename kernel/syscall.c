@@ -8,11 +8,18 @@
 #include "../include/security.h"
 #include "../include/monitor.h"
 #include "../include/power.h"
+#include "../include/futex.h"
+#include "../include/uring.h"
+#include "../include/vdso.h"
+#include "../include/systrace.h"
+#include "../include/file.h"
+#include "../include/console.h"
+#include "../include/ipc.h"
+#include "../include/shm.h"
+#include "../include/pipe.h"
 #include "string.h"
 #include "io.h"
-
-extern char keyboard_getchar(void);
-extern void serial_putchar(uint16_t com, char c);
+#include "cpu.h"
 
 typedef uint32_t (*syscall_func_t)(uint32_t, uint32_t, uint32_t, uint32_t);
 
@@ -31,6 +38,24 @@ static uint32_t sys_read_wrapper(uint32_t fd, uint32_t buf, uint32_t count, uint
     return sys_read(fd, (char*)buf, count);
 }
 
+static uint32_t sys_readv_wrapper(uint32_t fd, uint32_t iov, uint32_t iovcnt, uint32_t unused4) {
+    (void)unused4;
+    return sys_readv(fd, (const iovec_t*)iov, iovcnt);
+}
+
+static uint32_t sys_writev_wrapper(uint32_t fd, uint32_t iov, uint32_t iovcnt, uint32_t unused4) {
+    (void)unused4;
+    return sys_writev(fd, (const iovec_t*)iov, iovcnt);
+}
+
+static uint32_t sys_pread_wrapper(uint32_t fd, uint32_t buf, uint32_t count, uint32_t offset) {
+    return sys_pread(fd, (void*)buf, count, offset);
+}
+
+static uint32_t sys_pwrite_wrapper(uint32_t fd, uint32_t buf, uint32_t count, uint32_t offset) {
+    return sys_pwrite(fd, (const void*)buf, count, offset);
+}
+
 static uint32_t sys_fork_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
     (void)unused1; (void)unused2; (void)unused3; (void)unused4;
     return sys_fork();
@@ -145,9 +170,9 @@ static uint32_t sys_log_wrapper(uint32_t level, uint32_t message, uint32_t unuse
     return sys_log((uint8_t)level, (const char*)message);
 }
 
-static uint32_t sys_get_stats_wrapper(uint32_t stats_type, uint32_t buffer, uint32_t unused3, uint32_t unused4) {
-    (void)unused3; (void)unused4;
-    return sys_get_stats(stats_type, (void*)buffer);
+static uint32_t sys_get_stats_wrapper(uint32_t stats_type, uint32_t buffer, uint32_t arg, uint32_t unused4) {
+    (void)unused4;
+    return sys_get_stats(stats_type, (void*)buffer, arg);
 }
 
 static uint32_t sys_dump_logs_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
@@ -170,10 +195,156 @@ static uint32_t sys_get_power_stats_wrapper(uint32_t buffer, uint32_t unused2, u
     return sys_get_power_stats((void*)buffer);
 }
 
+static uint32_t sys_gettid_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused1; (void)unused2; (void)unused3; (void)unused4;
+    return sys_gettid();
+}
+
+static uint32_t sys_thread_create_wrapper(uint32_t entry, uint32_t arg, uint32_t tls_base, uint32_t unused4) {
+    (void)unused4;
+    return sys_thread_create(entry, arg, tls_base);
+}
+
+static uint32_t sys_thread_join_wrapper(uint32_t tid, uint32_t status, uint32_t unused3, uint32_t unused4) {
+    (void)unused3; (void)unused4;
+    return sys_thread_join(tid, (int*)status);
+}
+
+static uint32_t sys_thread_exit_wrapper(uint32_t status, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_thread_exit(status);
+}
+
+static uint32_t sys_futex_wrapper(uint32_t uaddr, uint32_t op, uint32_t val, uint32_t unused4) {
+    (void)unused4;
+    return sys_futex((uint32_t*)uaddr, op, val);
+}
+
+static uint32_t sys_ring_setup_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused1; (void)unused2; (void)unused3; (void)unused4;
+    return sys_ring_setup();
+}
+
+static uint32_t sys_ring_enter_wrapper(uint32_t to_submit, uint32_t min_complete, uint32_t unused3, uint32_t unused4) {
+    (void)unused3; (void)unused4;
+    return sys_ring_enter(to_submit, min_complete);
+}
+
+static uint32_t sys_vdso_page_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused1; (void)unused2; (void)unused3; (void)unused4;
+    return sys_vdso_page();
+}
+
+static uint32_t sys_trace_ctl_wrapper(uint32_t pid, uint32_t enable, uint32_t unused3, uint32_t unused4) {
+    (void)unused3; (void)unused4;
+    return sys_trace_ctl(pid, enable);
+}
+
+static uint32_t sys_trace_read_wrapper(uint32_t pid, uint32_t buffer, uint32_t max_records, uint32_t unused4) {
+    (void)unused4;
+    return sys_trace_read(pid, (void*)buffer, max_records);
+}
+
+static uint32_t sys_epoll_create_wrapper(uint32_t unused1, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused1; (void)unused2; (void)unused3; (void)unused4;
+    return sys_epoll_create();
+}
+
+static uint32_t sys_epoll_ctl_wrapper(uint32_t epfd, uint32_t op, uint32_t target, uint32_t event) {
+    return sys_epoll_ctl(epfd, op, target, (const epoll_event_t*)event);
+}
+
+static uint32_t sys_epoll_wait_wrapper(uint32_t epfd, uint32_t events, uint32_t max_events, uint32_t timeout_ms) {
+    return sys_epoll_wait(epfd, (epoll_event_t*)events, max_events, (int32_t)timeout_ms);
+}
+
+static uint32_t sys_ipc_send_wrapper(uint32_t receiver, uint32_t type, uint32_t data, uint32_t length) {
+    return sys_ipc_send(receiver, (uint8_t)type, (const void*)data, (uint16_t)length);
+}
+
+static uint32_t sys_ipc_receive_wrapper(uint32_t sender, uint32_t msg, uint32_t timeout_ms, uint32_t unused4) {
+    (void)unused4;
+    return sys_ipc_receive(sender, (ipc_msg_t*)msg, (int32_t)timeout_ms);
+}
+
+static uint32_t sys_ipc_mailbox_wrapper(uint32_t capacity, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_ipc_mailbox(capacity);
+}
+
+static uint32_t sys_ipc_call_wrapper(uint32_t server, uint32_t request, uint32_t reply, uint32_t unused4) {
+    (void)unused4;
+    return sys_ipc_call(server, (const ipc_short_t*)request, (ipc_short_t*)reply);
+}
+
+static uint32_t sys_ipc_reply_wait_wrapper(uint32_t caller, uint32_t reply, uint32_t request, uint32_t unused4) {
+    (void)unused4;
+    return sys_ipc_reply_wait(caller, (const ipc_short_t*)reply, (ipc_short_t*)request);
+}
+
+static uint32_t sys_ipc_buf_alloc_wrapper(uint32_t pages, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_ipc_buf_alloc(pages);
+}
+
+static uint32_t sys_ipc_buf_free_wrapper(uint32_t addr, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_ipc_buf_free((void*)addr);
+}
+
+static uint32_t sys_ipc_send_pages_wrapper(uint32_t receiver, uint32_t type, uint32_t addr, uint32_t unused4) {
+    (void)unused4;
+    return sys_ipc_send_pages(receiver, (uint8_t)type, (void*)addr);
+}
+
+static uint32_t sys_shm_create_wrapper(uint32_t key, uint32_t size, uint32_t unused3, uint32_t unused4) {
+    (void)unused3; (void)unused4;
+    return sys_shm_create(key, size);
+}
+
+static uint32_t sys_shm_attach_wrapper(uint32_t id, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_shm_attach(id);
+}
+
+static uint32_t sys_shm_detach_wrapper(uint32_t addr, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_shm_detach((void*)addr);
+}
+
+static uint32_t sys_shm_remove_wrapper(uint32_t id, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_shm_remove(id);
+}
+
+static uint32_t sys_pipe_wrapper(uint32_t fds, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_pipe((int*)fds);
+}
+
+static uint32_t sys_splice_wrapper(uint32_t fd_in, uint32_t fd_out, uint32_t len, uint32_t unused4) {
+    (void)unused4;
+    return sys_splice(fd_in, fd_out, len);
+}
+
+static uint32_t sys_unlink_wrapper(uint32_t path, uint32_t unused2, uint32_t unused3, uint32_t unused4) {
+    (void)unused2; (void)unused3; (void)unused4;
+    return sys_unlink((const char*)path);
+}
+
+static uint32_t sys_ftruncate_wrapper(uint32_t fd, uint32_t size, uint32_t unused3, uint32_t unused4) {
+    (void)unused3; (void)unused4;
+    return sys_ftruncate(fd, size);
+}
+
 static const syscall_func_t syscall_table[] = {
     [SYS_EXIT]       = sys_exit_wrapper,
     [SYS_WRITE]      = sys_write_wrapper,
     [SYS_READ]       = sys_read_wrapper,
+    [SYS_READV]      = sys_readv_wrapper,
+    [SYS_WRITEV]     = sys_writev_wrapper,
+    [SYS_PREAD]      = sys_pread_wrapper,
+    [SYS_PWRITE]     = sys_pwrite_wrapper,
     [SYS_FORK]       = sys_fork_wrapper,
     [SYS_WAIT]       = sys_wait_wrapper,
     [SYS_EXEC]       = sys_exec_wrapper,
@@ -202,18 +373,55 @@ static const syscall_func_t syscall_table[] = {
     [SYS_POWER_STATE]  = sys_power_state_wrapper,
     [SYS_GET_BATTERY_INFO] = sys_get_battery_info_wrapper,
     [SYS_GET_POWER_STATS] = sys_get_power_stats_wrapper,
+    [SYS_GETTID]     = sys_gettid_wrapper,
+    [SYS_THREAD_CREATE] = sys_thread_create_wrapper,
+    [SYS_THREAD_JOIN]   = sys_thread_join_wrapper,
+    [SYS_THREAD_EXIT]   = sys_thread_exit_wrapper,
+    [SYS_FUTEX]      = sys_futex_wrapper,
+    [SYS_RING_SETUP] = sys_ring_setup_wrapper,
+    [SYS_RING_ENTER] = sys_ring_enter_wrapper,
+    [SYS_VDSO_PAGE]  = sys_vdso_page_wrapper,
+    [SYS_TRACE_CTL]  = sys_trace_ctl_wrapper,
+    [SYS_TRACE_READ] = sys_trace_read_wrapper,
+    [SYS_EPOLL_CREATE] = sys_epoll_create_wrapper,
+    [SYS_EPOLL_CTL]    = sys_epoll_ctl_wrapper,
+    [SYS_EPOLL_WAIT]   = sys_epoll_wait_wrapper,
+    [SYS_IPC_SEND]     = sys_ipc_send_wrapper,
+    [SYS_IPC_RECEIVE]  = sys_ipc_receive_wrapper,
+    [SYS_IPC_MAILBOX]  = sys_ipc_mailbox_wrapper,
+    [SYS_IPC_CALL]     = sys_ipc_call_wrapper,
+    [SYS_IPC_REPLY_WAIT] = sys_ipc_reply_wait_wrapper,
+    [SYS_IPC_BUF_ALLOC]  = sys_ipc_buf_alloc_wrapper,
+    [SYS_IPC_BUF_FREE]   = sys_ipc_buf_free_wrapper,
+    [SYS_IPC_SEND_PAGES] = sys_ipc_send_pages_wrapper,
+    [SYS_SHM_CREATE]   = sys_shm_create_wrapper,
+    [SYS_SHM_ATTACH]   = sys_shm_attach_wrapper,
+    [SYS_SHM_DETACH]   = sys_shm_detach_wrapper,
+    [SYS_PIPE]         = sys_pipe_wrapper,
+    [SYS_SPLICE]       = sys_splice_wrapper,
+    [SYS_UNLINK]       = sys_unlink_wrapper,
+    [SYS_FTRUNCATE]    = sys_ftruncate_wrapper,
+    [SYS_SHM_REMOVE]   = sys_shm_remove_wrapper,
 };
 
-// System call interrupt handler
-void syscall_interrupt_handler(struct regs* r) {
-    uint32_t syscall_num = r->eax;
-    
+// Common dispatcher for the int $0x80 and SYSENTER entry paths
+uint32_t syscall_dispatch(uint32_t syscall_num, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4) {
+    uint64_t start = rdtsc();
+    uint32_t result = SYS_ERROR;
     if (syscall_num < sizeof(syscall_table) / sizeof(syscall_table[0]) && syscall_table[syscall_num]) {
-        uint32_t result = syscall_table[syscall_num](r->ebx, r->ecx, r->edx, r->esi);
-        r->eax = result;
-    } else {
-        r->eax = SYS_ERROR;
+        result = syscall_table[syscall_num](arg1, arg2, arg3, arg4);
     }
+
+    uint64_t elapsed = rdtsc() - start;
+    uint32_t args[4] = { arg1, arg2, arg3, arg4 };
+    systrace_account(syscall_num, args, result,
+                     (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed);
+    return result;
+}
+
+// System call interrupt handler
+void syscall_interrupt_handler(struct regs* r) {
+    r->eax = syscall_dispatch(r->eax, r->ebx, r->ecx, r->edx, r->esi);
 }
 
 void syscall_init(void) {
@@ -233,38 +441,71 @@ uint32_t syscall(uint32_t num, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
     return result;
 }
 
+// Four-argument variant; the fourth travels in %esi
+uint32_t syscall4(uint32_t num, uint32_t arg1, uint32_t arg2, uint32_t arg3, uint32_t arg4) {
+    uint32_t result;
+
+    asm volatile (
+        "int $0x80"
+        : "=a" (result)
+        : "a" (num), "b" (arg1), "c" (arg2), "d" (arg3), "S" (arg4)
+        : "memory"
+    );
+
+    return result;
+}
+
 uint32_t sys_exit(uint32_t status) {
     process_exit(status);
     return SYS_SUCCESS;
 }
 
+// Descriptor table of the calling process (NULL before the first one)
+static proc_shared_t* current_files(void) {
+    process_t* current = process_get_current();
+    return current ? current->shared : NULL;
+}
+
 uint32_t sys_write(uint32_t fd, const char* buf, uint32_t count) {
-    if (fd == 1) {
-        vga_print(buf);
-        // Note: Assuming 0x3F8 is COM1. Consider using a define.
-        for (uint32_t i = 0; i < count; i++) {
-            serial_putchar(0x3F8, buf[i]);
-        }
-        return count;
-    }
-    return SYS_ERROR;
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_write(file, buf, count);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
 }
 
 uint32_t sys_read(uint32_t fd, char* buf, uint32_t count) {
-    if (fd == 0) {
-        for (uint32_t i = 0; i < count; i++) {
-            char c = 0;
-            while ((c = keyboard_getchar()) == 0) {
-                if ((inb(0x3F8 + 5) & 1)) {
-                    c = inb(0x3F8);
-                    break;
-                }
-            }
-            buf[i] = c;
-        }
-        return count;
-    }
-    return SYS_ERROR;
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_read(file, buf, count);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_readv(uint32_t fd, const iovec_t* iov, uint32_t iovcnt) {
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_readv(file, iov, iovcnt);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_writev(uint32_t fd, const iovec_t* iov, uint32_t iovcnt) {
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_writev(file, iov, iovcnt);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_pread(uint32_t fd, void* buf, uint32_t count, uint32_t offset) {
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_pread(file, buf, count, offset);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_pwrite(uint32_t fd, const void* buf, uint32_t count, uint32_t offset) {
+    file_t* file = fd_get(current_files(), (int)fd);
+    int n = file_pwrite(file, buf, count, offset);
+    file_put(file);
+    return (n >= 0) ? n : SYS_ERROR;
 }
 
 uint32_t sys_fork(void) {
@@ -281,28 +522,60 @@ uint32_t sys_exec(const char* path) {
     return SYS_ERROR;
 }
 
+// Process id: shared by all threads of the process
 uint32_t sys_getpid(void) {
+    process_t* current = process_get_current();
+    return current ? current->tgid : 0;
+}
+
+uint32_t sys_gettid(void) {
     process_t* current = process_get_current();
     return current ? current->pid : 0;
 }
 
+uint32_t sys_thread_create(uint32_t entry, uint32_t arg, uint32_t tls_base) {
+    int tid = thread_create((void (*)(void*))entry, (void*)arg,
+                            tls_base, tls_base ? THREAD_TLS_SIZE : 0);
+    return (tid >= 0) ? tid : SYS_ERROR;
+}
+
+uint32_t sys_thread_join(uint32_t tid, int* status) {
+    return (thread_join((int)tid, status) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_thread_exit(uint32_t status) {
+    thread_exit((int)status);
+    return SYS_SUCCESS;
+}
+
 uint32_t sys_yield(void) {
     schedule();
     return SYS_SUCCESS;
 }
 
 uint32_t sys_open(const char* filename, uint32_t mode) {
-    int fd = fs_open(filename, mode);
-    return (fd >= 0) ? fd : SYS_ERROR;
+    proc_shared_t* files = current_files();
+    file_t* file = files ? file_open(filename, mode) : NULL;
+    if (!file) {
+        return SYS_ERROR;
+    }
+    int fd = fd_install(files, file);
+    if (fd < 0) {
+        file_put(file);
+        return SYS_ERROR;
+    }
+    return fd;
 }
 
 uint32_t sys_close(uint32_t fd) {
-    int result = fs_close((int)fd);
+    int result = fd_close(current_files(), (int)fd);
     return (result == 0) ? SYS_SUCCESS : SYS_ERROR;
 }
 
 uint32_t sys_seek(int fd, uint32_t position) {
-    int result = fs_seek((int)fd, position);
+    file_t* file = fd_get(current_files(), fd);
+    int result = file_seek(file, position);
+    file_put(file);
     return (result >= 0) ? result : SYS_ERROR;
 }
 
@@ -312,13 +585,89 @@ uint32_t sys_stat(const char* filename) {
 }
 
 uint32_t sys_ipc_send(uint32_t receiver, uint8_t type, const void* data, uint16_t length) {
-    (void)receiver; (void)type; (void)data; (void)length;
-    return 0;
+    return (ipc_send(receiver, type, (void*)data, length) == 0) ? SYS_SUCCESS : SYS_ERROR;
 }
 
-uint32_t sys_ipc_receive(uint32_t sender, void* msg) {
-    (void)sender; (void)msg;
-    return 0;
+// Sleeps up to timeout_ms for a message (0: poll, negative: forever)
+uint32_t sys_ipc_receive(uint32_t sender, ipc_msg_t* msg, int32_t timeout_ms) {
+    int result = (timeout_ms == 0) ? ipc_receive(sender, msg)
+                                   : ipc_receive_timeout(sender, msg, timeout_ms);
+    return (result == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_ipc_mailbox(uint32_t capacity) {
+    return (ipc_mailbox_create(current_files(), capacity) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_ipc_call(uint32_t server, const ipc_short_t* request, ipc_short_t* reply) {
+    return (ipc_call(server, request, reply) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Returns the thread id of the next caller
+uint32_t sys_ipc_reply_wait(uint32_t caller, const ipc_short_t* reply, ipc_short_t* request) {
+    int from = ipc_reply_wait(caller, reply, request);
+    return (from >= 0) ? (uint32_t)from : (uint32_t)SYS_ERROR;
+}
+
+// Returns the address of a zeroed page buffer
+uint32_t sys_ipc_buf_alloc(uint32_t pages) {
+    void* addr = ipc_buffer_alloc(current_files(), pages);
+    return addr ? (uint32_t)addr : (uint32_t)SYS_ERROR;
+}
+
+uint32_t sys_ipc_buf_free(void* addr) {
+    return (ipc_buffer_free(current_files(), addr) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_ipc_send_pages(uint32_t receiver, uint8_t type, void* addr) {
+    return (ipc_send_pages(receiver, type, addr) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Returns the segment id
+uint32_t sys_shm_create(uint32_t key, uint32_t size) {
+    int id = shm_create(key, size);
+    return (id >= 0) ? (uint32_t)id : (uint32_t)SYS_ERROR;
+}
+
+// Returns the address the segment is mapped at
+uint32_t sys_shm_attach(uint32_t id) {
+    void* addr = shm_attach(current_files(), (int)id);
+    return addr ? (uint32_t)addr : (uint32_t)SYS_ERROR;
+}
+
+uint32_t sys_shm_detach(void* addr) {
+    return (shm_detach(current_files(), addr) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_shm_remove(uint32_t id) {
+    return (shm_remove((int)id) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Stores the read end in fds[0] and the write end in fds[1]
+uint32_t sys_pipe(int* fds) {
+    return (pipe_create(current_files(), fds) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Returns the bytes moved; one of the descriptors must be a pipe
+uint32_t sys_splice(uint32_t fd_in, uint32_t fd_out, uint32_t len) {
+    proc_shared_t* owner = current_files();
+    file_t* in = fd_get(owner, (int)fd_in);
+    file_t* out = fd_get(owner, (int)fd_out);
+    int n = pipe_splice(in, out, len);
+    file_put(in);
+    file_put(out);
+    return (n >= 0) ? (uint32_t)n : (uint32_t)SYS_ERROR;
+}
+
+uint32_t sys_unlink(const char* path) {
+    return (file_unlink(path) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+uint32_t sys_ftruncate(uint32_t fd, uint32_t size) {
+    file_t* file = fd_get(current_files(), (int)fd);
+    int result = file_truncate(file, size);
+    file_put(file);
+    return (result == 0) ? SYS_SUCCESS : SYS_ERROR;
 }
 
 uint32_t sys_vm_alloc(uint32_t size, uint32_t flags) {
@@ -389,12 +738,99 @@ uint32_t sys_getgid(void) {
     return (security_get_context(&ctx) == 0) ? ctx.gid : (uint32_t)-1;
 }
 
+uint32_t sys_futex(uint32_t* uaddr, uint32_t op, uint32_t val) {
+    switch (op) {
+        case FUTEX_WAIT:
+            return (futex_wait(uaddr, val) == 0) ? SYS_SUCCESS : SYS_ERROR;
+        case FUTEX_WAKE:
+            return futex_wake(uaddr, val);
+        default:
+            return SYS_ERROR;
+    }
+}
+
+// Returns the address of the process's ring page
+uint32_t sys_ring_setup(void) {
+    process_t* current = process_get_current();
+    uring_shared_t* ring = current ? uring_setup(current->shared) : NULL;
+    return ring ? (uint32_t)ring : (uint32_t)SYS_ERROR;
+}
+
+uint32_t sys_ring_enter(uint32_t to_submit, uint32_t min_complete) {
+    process_t* current = process_get_current();
+    int n = current ? uring_enter(current->shared, to_submit, min_complete) : -1;
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_vdso_page(void) {
+    return (uint32_t)vdso_get_page();
+}
+
+// Only root may trace processes of other users
+static int may_trace(uint32_t pid) {
+    process_t* current = process_get_current();
+    process_t* target = process_get((int)pid);
+    if (!current || !target || !target->shared) {
+        return 0;
+    }
+    return current->shared->uid == 0 || current->shared->uid == target->shared->uid;
+}
+
+uint32_t sys_trace_ctl(uint32_t pid, uint32_t enable) {
+    if (!may_trace(pid)) {
+        return SYS_ERROR;
+    }
+    return (systrace_enable((int)pid, enable != 0) == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Returns the number of trace_record_t copied into buffer
+uint32_t sys_trace_read(uint32_t pid, void* buffer, uint32_t max_records) {
+    if (!may_trace(pid)) {
+        return SYS_ERROR;
+    }
+    int n = systrace_read((int)pid, (trace_record_t*)buffer, max_records);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
+uint32_t sys_epoll_create(void) {
+    int fd = epoll_create(current_files());
+    return (fd >= 0) ? (uint32_t)fd : (uint32_t)SYS_ERROR;
+}
+
+uint32_t sys_epoll_ctl(uint32_t epfd, uint32_t op, uint32_t target, const epoll_event_t* event) {
+    proc_shared_t* owner = current_files();
+    file_t* epfile = fd_get(owner, (int)epfd);
+    int result = epoll_ctl(epfile, owner, (int)op, target, event);
+    file_put(epfile);
+    return (result == 0) ? SYS_SUCCESS : SYS_ERROR;
+}
+
+// Sleeps until an interest is ready or timeout_ms passes (negative: forever)
+uint32_t sys_epoll_wait(uint32_t epfd, epoll_event_t* events, uint32_t max_events, int32_t timeout_ms) {
+    file_t* epfile = fd_get(current_files(), (int)epfd);
+    int n = epoll_wait(epfile, events, max_events, timeout_ms);
+    file_put(epfile);
+    return (n >= 0) ? n : SYS_ERROR;
+}
+
 uint32_t sys_setuid(uint32_t uid) {
-    return security_set_context(uid, sys_getgid());
+    uint32_t result = security_set_context(uid, sys_getgid());
+    process_t* current = process_get_current();
+    if (result == 0 && current) {
+        current->shared->uid = uid;  // Credentials are per process
+        vdso_set_task(current);
+    }
+    return result;
 }
 
 uint32_t sys_setgid(uint32_t gid) {
-    return security_set_context(sys_getuid(), gid);
+    uint32_t result = security_set_context(sys_getuid(), gid);
+    process_t* current = process_get_current();
+    if (result == 0 && current) {
+        current->shared->gid = gid;
+        vdso_set_task(current);
+    }
+    return result;
 }
 
 uint32_t sys_chmod(const char* path, uint32_t mode) {
@@ -410,9 +846,45 @@ uint32_t sys_log(uint8_t level, const char* message) {
     return SYS_SUCCESS;
 }
 
-uint32_t sys_get_stats(uint32_t type, void* buffer) {
-    if (type == 0) return monitor_get_system_stats((system_stats_t*)buffer);
-    if (type == 1) return monitor_get_performance_metrics((performance_metrics_t*)buffer);
+uint32_t sys_get_stats(uint32_t type, void* buffer, uint32_t arg) {
+    if (type == STATS_SYSTEM) return monitor_get_system_stats((system_stats_t*)buffer);
+    if (type == STATS_PERFORMANCE) return monitor_get_performance_metrics((performance_metrics_t*)buffer);
+    if (type == STATS_SCHED) {
+        process_t* p = process_get((int)arg);
+        if (!buffer || !p || p->state == PROCESS_EMPTY) return SYS_ERROR;
+        uint32_t flags = irq_save();
+        memcpy(buffer, &p->sched, sizeof(sched_stats_t));
+        irq_restore(flags);
+        return SYS_SUCCESS;
+    }
+    if (type == STATS_SYSCALL) {
+        if (!buffer) return SYS_ERROR;
+        systrace_get_counter(arg, (syscall_counter_t*)buffer);
+        return SYS_SUCCESS;
+    }
+    if (type == STATS_IPC) {
+        return (ipc_get_stats(arg, (ipc_mailbox_stats_t*)buffer) == 0) ? SYS_SUCCESS : SYS_ERROR;
+    }
+    if (type == STATS_CONSOLE) {
+        if (!buffer) return SYS_ERROR;
+        console_get_stats((console_stats_t*)buffer);
+        return SYS_SUCCESS;
+    }
+    if (type == STATS_SHM) {
+        if (!buffer) return SYS_ERROR;
+        shm_get_stats((shm_stats_t*)buffer);
+        return SYS_SUCCESS;
+    }
+    if (type == STATS_PIPE) {
+        if (!buffer) return SYS_ERROR;
+        pipe_get_stats((pipe_stats_t*)buffer);
+        return SYS_SUCCESS;
+    }
+    if (type == STATS_RAMFS) {
+        if (!buffer) return SYS_ERROR;
+        ramfs_get_stats((ramfs_stats_t*)buffer);
+        return SYS_SUCCESS;
+    }
     return SYS_ERROR;
 }
 
@@ -1,46 +1,131 @@
 /* System call assembly interface */
 
-.global syscall_handler
-.global syscall_entry
+.global sysenter_entry
+.global syscall_fast
+.global user_syscall_bench
+.global user_syscall_bench_end
+
+.extern syscall_dispatch
+.extern sysenter_enabled
 
 .section .text
 
-/* System call handler - called from interrupt */
-syscall_handler:
-    /* Save registers */
-    pushl %eax
+/*
+ * SYSENTER entry point. Register convention of syscall_fast:
+ *   eax = syscall number, ebx/esi/edi = arguments 1-3,
+ *   ecx = user esp, edx = user return eip.
+ * Only what SYSEXIT needs is saved; syscall_dispatch preserves the
+ * callee-saved registers. Segment registers are flat and left alone.
+ */
+sysenter_entry:
+    movl (%esp), %esp        /* MSR points at tss.esp0: the thread's kernel stack */
+    pushl %ecx               /* User esp */
+    pushl %edx               /* User eip */
+
+    pushl $0                 /* arg4 */
+    pushl %edi               /* arg3 */
+    pushl %esi               /* arg2 */
+    pushl %ebx               /* arg1 */
+    pushl %eax               /* syscall number */
+    call syscall_dispatch
+    addl $20, %esp
+
+    popl %edx
+    popl %ecx
+    sti                      /* Takes effect after SYSEXIT */
+    sysexit
+
+/* uint32_t syscall_fast(uint32_t num, uint32_t arg1, uint32_t arg2, uint32_t arg3) */
+/* SYSENTER from ring 3, a direct call from ring 0, int $0x80 without SEP */
+syscall_fast:
     pushl %ebx
-    pushl %ecx
-    pushl %edx
     pushl %esi
     pushl %edi
     pushl %ebp
-    
-    /* Call C system call dispatcher */
-    /* Arguments are already in registers: eax=syscall, ebx=arg1, ecx=arg2, edx=arg3, esi=arg4 */
-    pushl %esi      /* arg4 */
-    pushl %edx      /* arg3 */
-    pushl %ecx      /* arg2 */
-    pushl %ebx      /* arg1 */
-    pushl %eax      /* syscall number */
-    call syscall_dispatch
-    addl $20, %esp  /* Clean up stack */
-    
-    /* Return value is in eax */
-    
-    /* Restore registers */
+
+    movl 20(%esp), %eax
+    movl 24(%esp), %ebx
+    movl 28(%esp), %esi
+    movl 32(%esp), %edi
+
+    movw %cs, %cx
+    testb $3, %cl
+    jz 2f
+    cmpl $0, sysenter_enabled
+    je 3f
+
+    movl %esp, %ecx
+    movl $1f, %edx
+    sysenter
+1:
     popl %ebp
     popl %edi
     popl %esi
-    popl %edx
-    popl %ecx
     popl %ebx
-    popl %eax
-    
-    /* Return from interrupt */
-    iret
-
-/* System call entry point for user programs */
-syscall_entry:
-    int $0x80  /* Trigger software interrupt 0x80 */
     ret
+
+2:  /* Ring 0 caller: no privilege change, call the dispatcher directly */
+    pushfl
+    cli                      /* Same interrupt state as the trap paths */
+    pushl $0
+    pushl %edi
+    pushl %esi
+    pushl %ebx
+    pushl %eax
+    call syscall_dispatch
+    addl $20, %esp
+    popfl
+    jmp 1b
+
+3:  /* No SYSENTER support: legacy gate (arguments in ebx/ecx/edx) */
+    movl %esi, %ecx
+    movl %edi, %edx
+    int $0x80
+    jmp 1b
+
+/*
+ * Ring 3 half of the entry benchmark in syscall_test.c, copied into a
+ * user page and entered through enter_usermode(), so it is position
+ * independent. Times SYS_GETPID (6) through SYSENTER and through
+ * int $0x80, then exits the thread with SYS_THREAD_EXIT (39).
+ *   4(%esp) = result block: TSC before/after the SYSENTER loop, then
+ *             before/after the int $0x80 loop (four uint64_t)
+ *   8(%esp) = iterations per loop
+ */
+user_syscall_bench:
+    movl 4(%esp), %edi
+    call 0f
+0:  popl %esi
+    addl $(1f - 0b), %esi    /* SYSEXIT return address */
+
+    rdtsc
+    movl %eax, 0(%edi)
+    movl %edx, 4(%edi)
+    movl 8(%esp), %ebp
+2:  movl $6, %eax
+    movl %esp, %ecx
+    movl %esi, %edx
+    sysenter
+1:  decl %ebp
+    jnz 2b
+    rdtsc
+    movl %eax, 8(%edi)
+    movl %edx, 12(%edi)
+
+    rdtsc
+    movl %eax, 16(%edi)
+    movl %edx, 20(%edi)
+    movl 8(%esp), %ebp
+3:  movl $6, %eax
+    int $0x80
+    decl %ebp
+    jnz 3b
+    rdtsc
+    movl %eax, 24(%edi)
+    movl %edx, 28(%edi)
+
+    movl $39, %eax
+    xorl %ebx, %ebx
+    int $0x80
+4:  jmp 4b
+user_syscall_bench_end:
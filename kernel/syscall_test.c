@@ -0,0 +1,75 @@
+#include "../include/syscall.h"
+#include "../include/string.h"
+#include "../include/memory.h"
+#include "../include/usermode.h"
+#include "test_output.h"
+
+#define ROUNDTRIP_ROUNDS 10000
+#define BENCH_RESULTS 0x100  // Offset of the TSC readings in bench_page
+
+// Ring 3 half of the benchmark (syscall_asm.s)
+extern uint8_t user_syscall_bench[], user_syscall_bench_end[];
+extern int sysenter_enabled;
+
+// Code, results and stack of the ring 3 benchmark, mapped user-accessible
+static uint8_t bench_page[PAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+
+// Benchmark thread: drops to ring 3 and exits from there
+static void bench_thread(void* arg) {
+    (void)arg;
+    uint32_t* stack = (uint32_t*)(bench_page + PAGE_SIZE - 16);
+    stack[1] = (uint32_t)bench_page + BENCH_RESULTS;
+    stack[2] = ROUNDTRIP_ROUNDS;
+    enter_usermode((uint32_t)bench_page, (uint32_t)stack);
+}
+
+static uint32_t cycles_per_call(uint64_t start, uint64_t end) {
+    uint64_t elapsed = end - start;
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    return cycles / ROUNDTRIP_ROUNDS;
+}
+
+// System call entry test process. Test processes run in ring 0, where
+// syscall_fast() calls the dispatcher directly; the SYSENTER/SYSEXIT and
+// int $0x80 round trips are timed from a ring 3 thread instead.
+void syscall_test_process(void) {
+    char msg[] = "SYSCALL Test: Syscall entry test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    // Both entry paths must reach the same handler
+    uint32_t pid = syscall(SYS_GETPID, 0, 0, 0);
+    if (syscall_fast(SYS_GETPID, 0, 0, 0) == pid) {
+        char ok_msg[] = "SYSCALL Test: Direct dispatch OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)ok_msg, sizeof(ok_msg) - 1);
+    }
+
+    if (sysenter_enabled) {
+        memcpy(bench_page, user_syscall_bench,
+               (uint32_t)(user_syscall_bench_end - user_syscall_bench));
+        map_page((uint32_t)bench_page, (uint32_t)bench_page,
+                 PAGE_PRESENT | PAGE_WRITE | PAGE_USER);
+
+        int status = -1;
+        int tid = (int)syscall(SYS_THREAD_CREATE, (uint32_t)bench_thread, 0, 0);
+        if (tid >= 0 &&
+            syscall(SYS_THREAD_JOIN, (uint32_t)tid, (uint32_t)&status, 0) == SYS_SUCCESS &&
+            status == 0) {
+            uint64_t* tsc = (uint64_t*)(bench_page + BENCH_RESULTS);
+            test_print_value("SYSCALL Test: ring 3 SYSENTER cycles/call: ",
+                             cycles_per_call(tsc[0], tsc[1]));
+            test_print_value("SYSCALL Test: ring 3 int 0x80 cycles/call: ",
+                             cycles_per_call(tsc[2], tsc[3]));
+        } else {
+            char fail_msg[] = "SYSCALL Test: Ring 3 benchmark FAILED\n";
+            syscall(SYS_WRITE, 1, (uint32_t)fail_msg, sizeof(fail_msg) - 1);
+        }
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,212 @@
+#include "../include/systrace.h"
+#include "../include/syscall.h"
+#include "../drivers/vga.h"
+#include "process.h"
+#include "cpu.h"
+#include "string.h"
+
+// Record ring of one traced process. Full rings overwrite their oldest
+// record and count it as dropped.
+typedef struct trace_ring {
+    proc_shared_t* owner;        // NULL: slot free
+    uint32_t head;               // Records written
+    uint32_t tail;               // Records consumed
+    uint32_t dropped;
+    trace_record_t records[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static syscall_counter_t counters[SYSCALL_NR_MAX];
+static trace_ring_t trace_pool[MAX_PROCESSES];
+
+void systrace_init(void) {
+    memset(counters, 0, sizeof(counters));
+    memset(trace_pool, 0, sizeof(trace_pool));
+}
+
+void systrace_account(uint32_t num, const uint32_t args[4], uint32_t result, uint32_t cycles) {
+    uint32_t flags = irq_save();
+
+    syscall_counter_t* c = &counters[(num < SYSCALL_NR_MAX) ? num : SYSCALL_NR_MAX - 1];
+    c->calls++;
+    if (result == (uint32_t)SYS_ERROR) {
+        c->errors++;
+    }
+    c->total_cycles += cycles;
+    if (cycles > c->max_cycles) {
+        c->max_cycles = cycles;
+    }
+
+    // Untraced processes stop here
+    process_t* current = process_get_current();
+    trace_ring_t* ring = (current && current->shared) ? current->shared->trace : NULL;
+    if (ring) {
+        if (ring->head - ring->tail == TRACE_RING_SIZE) {
+            ring->tail++;
+            ring->dropped++;
+        }
+        trace_record_t* r = &ring->records[ring->head & (TRACE_RING_SIZE - 1)];
+        r->num = num;
+        memcpy(r->args, args, sizeof(r->args));
+        r->result = result;
+        r->cycles = cycles;
+        r->tid = current->pid;
+        ring->head++;
+    }
+
+    irq_restore(flags);
+}
+
+// Shared state of a live process, or NULL
+static proc_shared_t* shared_of(int pid) {
+    process_t* p = process_get(pid);
+    if (!p || p->state == PROCESS_EMPTY || p->state == PROCESS_ZOMBIE) {
+        return NULL;
+    }
+    return p->shared;
+}
+
+int systrace_enable(int pid, int enable) {
+    uint32_t flags = irq_save();
+    proc_shared_t* shared = shared_of(pid);
+    int result = -1;
+
+    if (shared && !enable) {
+        systrace_release(shared);
+        result = 0;
+    } else if (shared && shared->trace) {
+        result = 0;
+    } else if (shared) {
+        for (int i = 0; i < MAX_PROCESSES; i++) {
+            trace_ring_t* ring = &trace_pool[i];
+            if (!ring->owner) {
+                ring->owner = shared;
+                ring->head = 0;
+                ring->tail = 0;
+                ring->dropped = 0;
+                shared->trace = ring;
+                result = 0;
+                break;
+            }
+        }
+    }
+
+    irq_restore(flags);
+    return result;
+}
+
+int systrace_read(int pid, trace_record_t* buf, uint32_t max) {
+    if (!buf) {
+        return -1;
+    }
+
+    uint32_t flags = irq_save();
+    proc_shared_t* shared = shared_of(pid);
+    trace_ring_t* ring = shared ? shared->trace : NULL;
+    int copied = -1;
+    if (ring) {
+        copied = 0;
+        while (ring->tail != ring->head && (uint32_t)copied < max) {
+            buf[copied++] = ring->records[ring->tail & (TRACE_RING_SIZE - 1)];
+            ring->tail++;
+        }
+    }
+    irq_restore(flags);
+    return copied;
+}
+
+void systrace_get_counter(uint32_t num, syscall_counter_t* counter) {
+    if (!counter) {
+        return;
+    }
+    uint32_t flags = irq_save();
+    *counter = counters[(num < SYSCALL_NR_MAX) ? num : SYSCALL_NR_MAX - 1];
+    irq_restore(flags);
+}
+
+// The process stopped being traced or went away
+void systrace_release(proc_shared_t* owner) {
+    uint32_t flags = irq_save();
+    if (owner->trace) {
+        owner->trace->owner = NULL;
+        owner->trace = NULL;
+    }
+    irq_restore(flags);
+}
+
+static void print_field(uint32_t value, int width) {
+    char buf[16];
+    itoa((int)value, buf, 10);
+    for (int pad = strlen(buf); pad < width; pad++) {
+        vga_putchar(' ');
+    }
+    vga_print(buf);
+}
+
+static void print_hex(uint32_t value) {
+    static const char digits[] = "0123456789abcdef";
+    char buf[11];
+    buf[0] = '0';
+    buf[1] = 'x';
+    for (int i = 0; i < 8; i++) {
+        buf[2 + i] = digits[(value >> (28 - 4 * i)) & 0xF];
+    }
+    buf[10] = '\0';
+    vga_print(buf);
+}
+
+void systrace_dump_counters(void) {
+    vga_print("  NR    CALLS  ERRORS   AVG-CYC   MAX-CYC\n");
+    for (uint32_t nr = 0; nr < SYSCALL_NR_MAX; nr++) {
+        syscall_counter_t c;
+        systrace_get_counter(nr, &c);
+        if (!c.calls) continue;
+
+        // Each call adds at most 2^32-1 cycles, so the average fits
+        uint32_t avg = div64_32(c.total_cycles, c.calls);
+        print_field(nr, 4);
+        print_field(c.calls, 9);
+        print_field(c.errors, 8);
+        print_field(avg, 10);
+        print_field(c.max_cycles, 10);
+        vga_print("\n");
+    }
+}
+
+// Drains the ring, like reading it through SYS_TRACE_READ
+void systrace_dump_trace(int pid) {
+    trace_record_t rec;
+    if (systrace_read(pid, &rec, 0) < 0) {
+        vga_print("Process is not traced\n");
+        return;
+    }
+
+    while (systrace_read(pid, &rec, 1) == 1) {
+        char buf[16];
+        print_field((uint32_t)rec.tid, 4);
+        vga_print("  sys ");
+        itoa((int)rec.num, buf, 10);
+        vga_print(buf);
+        vga_print("(");
+        for (int i = 0; i < 4; i++) {
+            if (i) vga_print(", ");
+            print_hex(rec.args[i]);
+        }
+        vga_print(") = ");
+        itoa((int)rec.result, buf, 10);
+        vga_print(buf);
+        vga_print("  [");
+        itoa((int)rec.cycles, buf, 10);
+        vga_print(buf);
+        vga_print(" cycles]\n");
+    }
+
+    uint32_t flags = irq_save();
+    proc_shared_t* shared = shared_of(pid);
+    uint32_t dropped = (shared && shared->trace) ? shared->trace->dropped : 0;
+    irq_restore(flags);
+    if (dropped) {
+        vga_print("  Dropped records: ");
+        print_field(dropped, 0);
+        vga_print("\n");
+    }
+}
@@ -0,0 +1,51 @@
+#include "../include/systrace.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+#include "test_output.h"
+
+#define BAD_SYSCALL (SYSCALL_NR_MAX - 1)
+
+// Syscall accounting and tracing test process
+void systrace_test_process(void) {
+    char msg[] = "SYSTRACE Test: Syscall tracing test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    uint32_t pid = syscall(SYS_GETPID, 0, 0, 0);
+    syscall_counter_t before, after;
+    syscall(SYS_GET_STATS, STATS_SYSCALL, (uint32_t)&before, BAD_SYSCALL);
+
+    // Unknown syscalls fail and are counted as errors
+    syscall(SYS_TRACE_CTL, pid, 1, 0);
+    syscall(SYS_GETTID, 0, 0, 0);
+    syscall(BAD_SYSCALL, 1, 2, 3);
+
+    trace_record_t records[8];
+    int n = (int)syscall(SYS_TRACE_READ, pid, (uint32_t)records, 8);
+    syscall(SYS_TRACE_CTL, pid, 0, 0);
+
+    // The enabling call is the first one recorded
+    if (n == 3 && records[0].num == SYS_TRACE_CTL && records[1].num == SYS_GETTID &&
+        records[2].num == BAD_SYSCALL && records[2].args[2] == 3 &&
+        records[2].result == (uint32_t)SYS_ERROR) {
+        char trace_msg[] = "SYSTRACE Test: Trace records OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)trace_msg, sizeof(trace_msg) - 1);
+    }
+
+    syscall(SYS_GET_STATS, STATS_SYSCALL, (uint32_t)&after, BAD_SYSCALL);
+    if (after.calls == before.calls + 1 && after.errors == before.errors + 1) {
+        char count_msg[] = "SYSTRACE Test: Error counter OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)count_msg, sizeof(count_msg) - 1);
+    }
+
+    syscall(SYS_GET_STATS, STATS_SYSCALL, (uint32_t)&after, SYS_GETPID);
+    test_print_value("SYSTRACE Test: getpid calls: ", after.calls);
+    test_print_value("SYSTRACE Test: getpid max cycles: ", after.max_cycles);
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef TEST_OUTPUT_H
+#define TEST_OUTPUT_H
+
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+// Console output shared by the test processes, written through SYS_WRITE
+// like any other process would
+
+// "<label><value>\n"
+static inline void test_print_value(const char* label, uint32_t value) {
+    char buf[16];
+    syscall(SYS_WRITE, 1, (uint32_t)label, strlen(label));
+    itoa((int)value, buf, 10);
+    syscall(SYS_WRITE, 1, (uint32_t)buf, strlen(buf));
+    syscall(SYS_WRITE, 1, (uint32_t)"\n", 1);
+}
+
+// "<prefix><what> OK" or "<prefix><what> FAILED"
+static inline void test_report(const char* prefix, int ok, const char* what) {
+    syscall(SYS_WRITE, 1, (uint32_t)prefix, strlen(prefix));
+    syscall(SYS_WRITE, 1, (uint32_t)what, strlen(what));
+    syscall(SYS_WRITE, 1, (uint32_t)(ok ? " OK\n" : " FAILED\n"), ok ? 4 : 8);
+}
+
+// Tests that define TEST_PREFIX before including this file get report()
+#ifdef TEST_PREFIX
+#define report(ok, what) test_report(TEST_PREFIX, (ok), (what))
+#endif
+
+#endif // TEST_OUTPUT_H
@@ -0,0 +1,68 @@
+#include "process.h"
+#include "../include/gdt.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+
+#define TEST_THREADS 2
+#define TEST_ITERATIONS 100
+
+// Shared by all threads of the test process without any copying
+static volatile uint32_t shared_sum = 0;
+
+// One TLS block per thread: word 0 holds the thread's own index
+static uint32_t tls_blocks[TEST_THREADS][THREAD_TLS_SIZE / sizeof(uint32_t)] __attribute__((aligned(16)));
+
+static void thread_worker(void* arg) {
+    uint32_t index = (uint32_t)arg;
+    tls_write32(0, index + 1);
+
+    for (int i = 0; i < TEST_ITERATIONS; i++) {
+        // Still our own value after other threads ran with their TLS
+        uint32_t mine = tls_read32(0);
+        uint32_t flags = irq_save();
+        shared_sum += mine;
+        irq_restore(flags);
+        syscall(SYS_YIELD, 0, 0, 0);
+    }
+
+    syscall(SYS_THREAD_EXIT, index + 10, 0, 0);
+}
+
+// Threads and thread-local storage test process
+void thread_test_process(void) {
+    char msg[] = "THREAD Test: Thread test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    int tids[TEST_THREADS];
+    for (uint32_t i = 0; i < TEST_THREADS; i++) {
+        tids[i] = (int)syscall(SYS_THREAD_CREATE, (uint32_t)thread_worker, i,
+                               (uint32_t)tls_blocks[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < TEST_THREADS; i++) {
+        int status = -1;
+        if (tids[i] < 0 ||
+            syscall(SYS_THREAD_JOIN, (uint32_t)tids[i], (uint32_t)&status, 0) != SYS_SUCCESS ||
+            status != i + 10) {
+            ok = 0;
+        }
+        if (tids[i] >= 0 && process_get(tids[i])->tgid != (int)syscall(SYS_GETPID, 0, 0, 0)) {
+            ok = 0;
+        }
+    }
+
+    // Each thread adds its TLS index (1 and 2) once per iteration
+    if (ok && shared_sum == (1 + 2) * TEST_ITERATIONS) {
+        char ok_msg[] = "THREAD Test: Threads and TLS OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)ok_msg, sizeof(ok_msg) - 1);
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,80 @@
+#include "../include/ulock.h"
+#include "../include/futex.h"
+#include "../include/syscall.h"
+
+static inline uint32_t atomic_cmpxchg(volatile uint32_t* ptr, uint32_t old, uint32_t new_val) {
+    uint32_t prev;
+    asm volatile ("lock cmpxchgl %2, %1"
+                  : "=a"(prev), "+m"(*ptr)
+                  : "r"(new_val), "0"(old)
+                  : "memory");
+    return prev;
+}
+
+static inline uint32_t atomic_xchg(volatile uint32_t* ptr, uint32_t val) {
+    asm volatile ("xchgl %0, %1" : "+r"(val), "+m"(*ptr) : : "memory");
+    return val;
+}
+
+static inline void atomic_inc(volatile uint32_t* ptr) {
+    asm volatile ("lock incl %0" : "+m"(*ptr) : : "memory");
+}
+
+void umutex_init(umutex_t* m) {
+    m->state = 0;
+}
+
+int umutex_trylock(umutex_t* m) {
+    return atomic_cmpxchg(&m->state, 0, 1) == 0;
+}
+
+void umutex_lock(umutex_t* m) {
+    uint32_t c = atomic_cmpxchg(&m->state, 0, 1);
+    if (c == 0) {
+        return;  // Fast path: no syscall
+    }
+
+    // Mark the mutex contended so the owner knows to wake someone,
+    // and sleep until it is handed back free
+    if (c != 2) {
+        c = atomic_xchg(&m->state, 2);
+    }
+    while (c != 0) {
+        syscall(SYS_FUTEX, (uint32_t)&m->state, FUTEX_WAIT, 2);
+        c = atomic_xchg(&m->state, 2);
+    }
+}
+
+void umutex_unlock(umutex_t* m) {
+    // Only a mutex that saw contention needs a wake-up
+    if (atomic_xchg(&m->state, 0) == 2) {
+        syscall(SYS_FUTEX, (uint32_t)&m->state, FUTEX_WAKE, 1);
+    }
+}
+
+void ucond_init(ucond_t* c) {
+    c->seq = 0;
+}
+
+void ucond_wait(ucond_t* c, umutex_t* m) {
+    uint32_t seq = c->seq;
+    umutex_unlock(m);
+
+    // Returns at once if a signal bumped seq after we dropped the mutex
+    syscall(SYS_FUTEX, (uint32_t)&c->seq, FUTEX_WAIT, seq);
+
+    // Re-take the mutex as contended: other waiters may be queued on it
+    while (atomic_xchg(&m->state, 2) != 0) {
+        syscall(SYS_FUTEX, (uint32_t)&m->state, FUTEX_WAIT, 2);
+    }
+}
+
+void ucond_signal(ucond_t* c) {
+    atomic_inc(&c->seq);
+    syscall(SYS_FUTEX, (uint32_t)&c->seq, FUTEX_WAKE, 1);
+}
+
+void ucond_broadcast(ucond_t* c) {
+    atomic_inc(&c->seq);
+    syscall(SYS_FUTEX, (uint32_t)&c->seq, FUTEX_WAKE, 0xFFFFFFFFu);
+}
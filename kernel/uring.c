@@ -0,0 +1,264 @@
+#include "../include/uring.h"
+#include "../include/file.h"
+#include "../include/device.h"
+#include "../include/network.h"
+#include "../include/spinlock.h"
+#include "../include/wait.h"
+#include "process.h"
+#include "string.h"
+#include "log.h"
+
+// Kernel state of one ring. The indices the kernel acts on are private
+// copies, so a process scribbling on the shared page can only confuse
+// itself.
+typedef struct uring {
+    uring_shared_t* shm;          // NULL: slot free
+    proc_shared_t* owner;
+    uint32_t sq_head;             // Next SQE the worker runs
+    uint32_t sq_submit;           // End of the SQEs handed over so far
+    uint32_t cq_tail;
+    wait_queue_t cq_wait;         // Threads waiting for completions
+    uint8_t queued;               // On the worker list
+    uint8_t running;              // Being drained by the worker
+    uint8_t dead;                 // Owner exited; freed when idle
+    struct uring* next;
+} uring_t;
+
+// One ring per process at most, so the pools match the process table
+static uring_t ring_pool[MAX_PROCESSES];
+static uring_shared_t ring_pages[MAX_PROCESSES];
+
+static uring_t* work_head = NULL;
+static uring_t* work_tail = NULL;
+static spinlock_t ring_lock;
+static wait_queue_t worker_wait;
+static uring_stats_t uring_stats;
+
+// Called with ring_lock held
+static void ring_free_locked(uring_t* ring) {
+    ring->shm = NULL;
+    ring->owner = NULL;
+}
+
+// Put a ring with pending SQEs on the worker list. Called with ring_lock held.
+static void ring_queue_locked(uring_t* ring) {
+    if (ring->queued || ring->dead) {
+        return;
+    }
+    ring->queued = 1;
+    ring->next = NULL;
+    if (work_tail) {
+        work_tail->next = ring;
+    } else {
+        work_head = ring;
+    }
+    work_tail = ring;
+}
+
+static uring_t* ring_dequeue(void) {
+    uint32_t flags = spin_lock_irqsave(&ring_lock);
+    uring_t* ring = work_head;
+    if (ring) {
+        work_head = ring->next;
+        if (!work_head) {
+            work_tail = NULL;
+        }
+        ring->next = NULL;
+        ring->queued = 0;
+        ring->running = 1;
+    }
+    spin_unlock_irqrestore(&ring_lock, flags);
+    return ring;
+}
+
+// File operations resolve descriptors in the owner's table, not the worker's
+static int32_t uring_file_io(proc_shared_t* owner, const uring_sqe_t* sqe) {
+    file_t* file = fd_get(owner, sqe->fd);
+    int n = (sqe->opcode == URING_OP_READ)
+        ? file_read(file, (void*)sqe->addr, sqe->len)
+        : file_write(file, (const void*)sqe->addr, sqe->len);
+    file_put(file);
+    return n;
+}
+
+static int32_t uring_execute(proc_shared_t* owner, const uring_sqe_t* sqe) {
+    switch (sqe->opcode) {
+        case URING_OP_NOP:
+            return 0;
+        case URING_OP_READ:
+        case URING_OP_WRITE:
+            return uring_file_io(owner, sqe);
+        case URING_OP_DEVICE_READ:
+            return device_read((const char*)sqe->arg, (void*)sqe->addr, sqe->len);
+        case URING_OP_DEVICE_WRITE:
+            return device_write((const char*)sqe->arg, (const void*)sqe->addr, sqe->len);
+        case URING_OP_NET_SEND:
+            return network_send_packet(sqe->arg, (uint8_t)sqe->fd,
+                                       (const void*)sqe->addr, (uint16_t)sqe->len);
+        case URING_OP_NET_RECEIVE:
+            return network_receive_packet((network_packet_t*)sqe->addr);
+        default:
+            return -1;
+    }
+}
+
+// Run every handed-over SQE the CQ has room for
+static void uring_run(uring_t* ring) {
+    uring_shared_t* shm = ring->shm;
+    uint32_t done = 0;
+
+    while (ring->sq_head != ring->sq_submit) {
+        if (ring->cq_tail - shm->cq_head >= URING_CQ_ENTRIES) {
+            // Resumed by the next SYS_RING_ENTER once the process reaps
+            uring_stats.cq_stalls++;
+            break;
+        }
+
+        // Copy first: the process may reuse the slot once sq_head moves
+        uring_sqe_t sqe = shm->sqes[ring->sq_head & (URING_ENTRIES - 1)];
+        shm->sq_head = ++ring->sq_head;
+
+        uring_cqe_t* cqe = &shm->cqes[ring->cq_tail & (URING_CQ_ENTRIES - 1)];
+        cqe->user_data = sqe.user_data;
+        cqe->res = uring_execute(ring->owner, &sqe);
+        asm volatile ("" : : : "memory");  // CQE contents before the tail
+        shm->cq_tail = ++ring->cq_tail;
+        done++;
+    }
+
+    uring_stats.completed += done;
+    if (done) {
+        wake_up_all(&ring->cq_wait);
+    }
+}
+
+// The "kuring" worker: drains rings in submission order
+static void uring_worker(void) {
+    while (1) {
+        wait_event(worker_wait, work_head != NULL);
+
+        uring_t* ring;
+        while ((ring = ring_dequeue()) != NULL) {
+            if (!ring->dead) {
+                uring_run(ring);
+            }
+
+            uint32_t flags = spin_lock_irqsave(&ring_lock);
+            ring->running = 0;
+            if (ring->dead && !ring->queued) {
+                ring_free_locked(ring);
+            }
+            spin_unlock_irqrestore(&ring_lock, flags);
+        }
+    }
+}
+
+void uring_init(void) {
+    spin_lock_init(&ring_lock, "uring");
+    wait_queue_init(&worker_wait, "kuring");
+    memset(ring_pool, 0, sizeof(ring_pool));
+    memset(&uring_stats, 0, sizeof(uring_stats));
+    work_head = NULL;
+    work_tail = NULL;
+
+    if (process_create("kuring", uring_worker) < 0) {
+        log_error("Failed to create kuring thread");
+    }
+}
+
+// Map a ring into the process; a second call returns the same ring
+uring_shared_t* uring_setup(proc_shared_t* owner) {
+    if (!owner) {
+        return NULL;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ring_lock);
+    uring_t* ring = owner->uring;
+    if (!ring) {
+        for (int i = 0; i < MAX_PROCESSES; i++) {
+            if (!ring_pool[i].shm) {
+                ring = &ring_pool[i];
+                ring->shm = &ring_pages[i];
+                break;
+            }
+        }
+        if (ring) {
+            memset(ring->shm, 0, sizeof(uring_shared_t));
+            ring->owner = owner;
+            ring->sq_head = 0;
+            ring->sq_submit = 0;
+            ring->cq_tail = 0;
+            ring->queued = 0;
+            ring->running = 0;
+            ring->dead = 0;
+            wait_queue_init(&ring->cq_wait, "uring_cq");
+            owner->uring = ring;
+            uring_stats.setups++;
+        }
+    }
+    spin_unlock_irqrestore(&ring_lock, flags);
+
+    return ring ? ring->shm : NULL;
+}
+
+// Hand up to to_submit published SQEs to the worker, then wait until at
+// least min_complete completions are unreaped. Returns the number of
+// SQEs handed over, or -1 without a ring.
+int uring_enter(proc_shared_t* owner, uint32_t to_submit, uint32_t min_complete) {
+    uring_t* ring = owner ? owner->uring : NULL;
+    if (!ring) {
+        return -1;
+    }
+
+    uint32_t flags = spin_lock_irqsave(&ring_lock);
+    uint32_t published = ring->shm->sq_tail - ring->sq_submit;
+    uint32_t room = URING_ENTRIES - (ring->sq_submit - ring->sq_head);
+    uint32_t n = to_submit;
+    if (n > published) n = published;
+    if (n > room) n = room;
+    ring->sq_submit += n;
+
+    // Also requeue work left behind by a CQ stall
+    int kick = ring->sq_head != ring->sq_submit;
+    if (kick) {
+        ring_queue_locked(ring);
+    }
+    uring_stats.enters++;
+    uring_stats.submitted += n;
+    spin_unlock_irqrestore(&ring_lock, flags);
+
+    if (kick) {
+        wake_up(&worker_wait);
+    }
+
+    if (min_complete) {
+        if (min_complete > URING_CQ_ENTRIES) {
+            min_complete = URING_CQ_ENTRIES;
+        }
+        wait_event(ring->cq_wait, ring->cq_tail - ring->shm->cq_head >= min_complete);
+    }
+    return (int)n;
+}
+
+// The owning process is gone. Called with interrupts disabled.
+void uring_release(proc_shared_t* owner) {
+    uint32_t flags = spin_lock_irqsave(&ring_lock);
+    uring_t* ring = owner->uring;
+    if (ring) {
+        owner->uring = NULL;
+        ring->dead = 1;
+        // A queued or running ring is freed by the worker
+        if (!ring->queued && !ring->running) {
+            ring_free_locked(ring);
+        }
+    }
+    spin_unlock_irqrestore(&ring_lock, flags);
+}
+
+void uring_get_stats(uring_stats_t* stats) {
+    if (stats) {
+        uint32_t flags = spin_lock_irqsave(&ring_lock);
+        memcpy(stats, &uring_stats, sizeof(uring_stats_t));
+        spin_unlock_irqrestore(&ring_lock, flags);
+    }
+}
@@ -0,0 +1,92 @@
+#include "../include/uring.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+#include "cpu.h"
+#include "test_output.h"
+
+#define BATCH_ROUNDS 16
+
+// Queue a full SQ of NOPs, submit with one trap and reap the results
+static uint32_t run_nop_batch(uring_shared_t* ring) {
+    uint32_t queued = 0;
+    uring_sqe_t* sqe;
+    while ((sqe = uring_get_sqe(ring)) != NULL) {
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = URING_OP_NOP;
+        sqe->user_data = queued++;
+        uring_sq_push(ring);
+    }
+
+    syscall(SYS_RING_ENTER, queued, queued, 0);
+
+    uint32_t reaped = 0;
+    uring_cqe_t* cqe;
+    while ((cqe = uring_peek_cqe(ring)) != NULL) {
+        if (cqe->res == 0 && cqe->user_data == reaped) {
+            reaped++;
+        }
+        uring_cqe_seen(ring);
+    }
+    return reaped;
+}
+
+// Batched syscall ring test process
+void uring_test_process(void) {
+    char msg[] = "URING Test: Ring test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    uint32_t addr = syscall(SYS_RING_SETUP, 0, 0, 0);
+    if (addr == (uint32_t)SYS_ERROR) {
+        char fail_msg[] = "URING Test: Ring setup failed\n";
+        syscall(SYS_WRITE, 1, (uint32_t)fail_msg, sizeof(fail_msg) - 1);
+    } else {
+        uring_shared_t* ring = (uring_shared_t*)addr;
+
+        // A real operation goes through the same path as the syscall
+        static char ring_msg[] = "URING Test: Write via ring OK\n";
+        uring_sqe_t* sqe = uring_get_sqe(ring);
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = URING_OP_WRITE;
+        sqe->fd = 1;
+        sqe->addr = (uint32_t)ring_msg;
+        sqe->len = sizeof(ring_msg) - 1;
+        uring_sq_push(ring);
+        syscall(SYS_RING_ENTER, 1, 1, 0);
+        uring_cqe_t* cqe = uring_peek_cqe(ring);
+        if (cqe && cqe->res == (int32_t)(sizeof(ring_msg) - 1)) {
+            char ok_msg[] = "URING Test: Write completion OK\n";
+            syscall(SYS_WRITE, 1, (uint32_t)ok_msg, sizeof(ok_msg) - 1);
+        }
+        if (cqe) {
+            uring_cqe_seen(ring);
+        }
+
+        // Batches: one trap per URING_ENTRIES operations
+        uring_stats_t before, after;
+        uring_get_stats(&before);
+        uint32_t ops = 0;
+        uint64_t start = rdtsc();
+        for (int i = 0; i < BATCH_ROUNDS; i++) {
+            ops += run_nop_batch(ring);
+        }
+        uint64_t elapsed = rdtsc() - start;
+        uring_get_stats(&after);
+
+        if (ops == BATCH_ROUNDS * URING_ENTRIES) {
+            char batch_msg[] = "URING Test: Batched completions OK\n";
+            syscall(SYS_WRITE, 1, (uint32_t)batch_msg, sizeof(batch_msg) - 1);
+        }
+        uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+        test_print_value("URING Test: Cycles/op: ", ops ? cycles / ops : 0);
+        test_print_value("URING Test: Ops per trap: ",
+                    (after.submitted - before.submitted) / (after.enters - before.enters));
+    }
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
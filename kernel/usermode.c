@@ -4,17 +4,47 @@
 #include "../include/idt.h"
 #include "../include/vga.h"
 #include "../include/string.h"
+#include "../include/gdt.h"
+#include "cpu.h"
+
+// SYSENTER MSRs
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+
+#define CPUID_EDX_SEP (1u << 11)
+
+// Fast system call entry stub (syscall_asm.s)
+extern void sysenter_entry(void);
 
 // TSS for task switching
 static tss_t kernel_tss;
 
+// Set when the fast SYSENTER/SYSEXIT path can be used; read by syscall_fast
+int sysenter_enabled = 0;
+
 // Initialize user mode
 void usermode_init(void) {
-    // Set up TSS
+    // Set up TSS; esp0 is replaced with the running thread's stack on every switch
     setup_tss(0x200000);  // Kernel stack at 2MB
-    
-    // For now, skip GDT setup and just set up TSS
-    // In a real implementation, we'd set up user mode segments in GDT
+    gdt_set_tss((uint32_t)&kernel_tss, sizeof(tss_t) - 1);
+
+    uint32_t eax, ebx, ecx, edx;
+    asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    if (edx & CPUID_EDX_SEP) {
+        // SYSENTER loads CS from the MSR and SS = CS + 8; SYSEXIT returns
+        // to CS + 16 and SS + 24, matching the GDT layout. ESP points at
+        // tss.esp0, which the entry stub dereferences to find the stack.
+        wrmsr(MSR_SYSENTER_CS, GDT_KERNEL_CS);
+        wrmsr(MSR_SYSENTER_ESP, (uint32_t)&kernel_tss.esp0);
+        wrmsr(MSR_SYSENTER_EIP, (uint32_t)sysenter_entry);
+        sysenter_enabled = 1;
+    }
+}
+
+// Kernel stack used for traps and SYSENTER from ring 3
+void usermode_set_kernel_stack(uint32_t esp0) {
+    kernel_tss.esp0 = esp0;
 }
 
 // Set up TSS
@@ -28,30 +58,30 @@ void setup_tss(uint32_t kernel_stack) {
     kernel_tss.fs = USER_DS;
     kernel_tss.gs = USER_DS;
     kernel_tss.ss = USER_DS;
+    kernel_tss.iomap_base = sizeof(tss_t);  // No I/O permission bitmap
 }
 
-// Enter user mode
+// Enter user mode; does not return. The current kernel stack is abandoned
+// and reused from its top (tss.esp0) by the next trap or SYSENTER.
 void enter_usermode(uint32_t entry_point, uint32_t stack_top) {
     asm volatile (
         "cli\n"
-        "mov $0x20, %%ax\n"     // User data segment
+        "mov %[ds], %%eax\n"    // User data segment
         "mov %%ax, %%ds\n"
         "mov %%ax, %%es\n"
         "mov %%ax, %%fs\n"
         "mov %%ax, %%gs\n"
-        
-        "mov %0, %%esp\n"        // User stack
-        "push $0x20\n"           // User data segment
-        "push %%esp\n"           // User stack pointer
-        "pushf\n"                // EFLAGS
-        "pop %%eax\n"
-        "or $0x200, %%eax\n"     // Enable interrupts
-        "push %%eax\n"
-        "push $0x18\n"           // User code segment
-        "push %1\n"              // Entry point
+
+        "push %[ds]\n"          // User stack segment
+        "push %[esp]\n"         // User stack pointer
+        "pushf\n"               // EFLAGS
+        "orl $0x200, (%%esp)\n" // Enable interrupts
+        "push %[cs]\n"          // User code segment
+        "push %[eip]\n"         // Entry point
         "iret\n"
-        : : "r" (stack_top), "r" (entry_point)
-        : "eax"
+        : : [esp] "r" (stack_top), [eip] "r" (entry_point),
+            [cs] "i" (USER_CS), [ds] "i" (USER_DS)
+        : "eax", "memory"
     );
 }
 
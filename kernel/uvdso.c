@@ -0,0 +1,89 @@
+#include "../include/vdso.h"
+#include "../include/syscall.h"
+#include "cpu.h"
+
+static vdso_data_t* vdso_data = 0;
+
+// The page address never changes; look it up once
+static inline vdso_data_t* vdso(void) {
+    if (!vdso_data) {
+        vdso_data = (vdso_data_t*)syscall(SYS_VDSO_PAGE, 0, 0, 0);
+    }
+    return vdso_data;
+}
+
+static inline uint32_t vdso_read_begin(const vdso_data_t* d) {
+    uint32_t seq;
+    while ((seq = d->seq) & 1) {
+        cpu_relax();
+    }
+    asm volatile ("" : : : "memory");
+    return seq;
+}
+
+static inline int vdso_read_retry(const vdso_data_t* d, uint32_t seq) {
+    asm volatile ("" : : : "memory");
+    return d->seq != seq;
+}
+
+uint32_t vdso_get_ticks(void) {
+    // A single aligned word needs no retry loop
+    return vdso()->ticks;
+}
+
+int vdso_getpid(void) {
+    return vdso()->pid;
+}
+
+int vdso_gettid(void) {
+    return vdso()->tid;
+}
+
+uint32_t vdso_getuid(void) {
+    return vdso()->uid;
+}
+
+uint32_t vdso_getgid(void) {
+    return vdso()->gid;
+}
+
+int vdso_clock_gettime(int clock, vdso_timespec_t* ts) {
+    if (!ts || (clock != VDSO_CLOCK_REALTIME && clock != VDSO_CLOCK_MONOTONIC)) {
+        return -1;
+    }
+
+    vdso_data_t* d = vdso();
+    uint32_t seq, ticks, hz, mult, boot_time;
+    uint64_t tick_tsc, now;
+    do {
+        seq = vdso_read_begin(d);
+        ticks = d->ticks;
+        hz = d->hz;
+        mult = d->tsc_mult;
+        boot_time = d->boot_time;
+        tick_tsc = d->tick_tsc;
+        now = rdtsc();
+    } while (vdso_read_retry(d, seq));
+
+    if (hz == 0) {
+        return -1;
+    }
+
+    // Interpolate within the current tick using the calibrated TSC
+    uint32_t ns_per_tick = 1000000000u / hz;
+    uint32_t ns = 0;
+    if (mult) {
+        uint64_t delta = now - tick_tsc;
+        uint32_t delta32 = (delta > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)delta;
+        uint64_t scaled = ((uint64_t)delta32 * mult) >> VDSO_TSC_SHIFT;
+        // A tick interrupt may be pending; never run into the next tick
+        ns = (scaled >= ns_per_tick) ? ns_per_tick - 1 : (uint32_t)scaled;
+    }
+
+    ts->tv_sec = ticks / hz;
+    ts->tv_nsec = (ticks % hz) * ns_per_tick + ns;
+    if (clock == VDSO_CLOCK_REALTIME) {
+        ts->tv_sec += boot_time;
+    }
+    return 0;
+}
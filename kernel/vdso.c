@@ -0,0 +1,146 @@
+#include "../include/vdso.h"
+#include "../include/memory.h"
+#include "../drivers/timer.h"
+#include "process.h"
+#include "cpu.h"
+#include "io.h"
+#include "string.h"
+
+#define CMOS_ADDR 0x70
+#define CMOS_DATA 0x71
+
+#define NS_PER_TICK (1000000000u / TIMER_HZ)
+
+// Recalibrate the TSC rate over this many ticks (power of two)
+#define VDSO_CAL_SHIFT 4
+#define VDSO_CAL_TICKS (1u << VDSO_CAL_SHIFT)
+
+static union {
+    vdso_data_t data;
+    uint8_t bytes[PAGE_SIZE];
+} vdso_page __attribute__((aligned(PAGE_SIZE)));
+
+static uint64_t cal_start_tsc = 0;
+static uint32_t cal_ticks = 0;
+
+// Writers run with interrupts disabled, so they never race each other
+static inline void vdso_write_begin(void) {
+    vdso_page.data.seq++;
+    asm volatile ("" : : : "memory");
+}
+
+static inline void vdso_write_end(void) {
+    asm volatile ("" : : : "memory");
+    vdso_page.data.seq++;
+}
+
+static uint8_t cmos_read(uint8_t reg) {
+    outb(CMOS_ADDR, reg);
+    return inb(CMOS_DATA);
+}
+
+static uint8_t bcd_to_bin(uint8_t v) {
+    return (v & 0x0F) + (v >> 4) * 10;
+}
+
+// Wall clock from the CMOS RTC, in seconds since 1970 (years 2000-2099)
+static uint32_t rtc_read_epoch(void) {
+    static const uint16_t days_before_month[12] = {
+        0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+    };
+
+    while (cmos_read(0x0A) & 0x80) {
+        cpu_relax();  // Update in progress
+    }
+    uint8_t sec = cmos_read(0x00);
+    uint8_t min = cmos_read(0x02);
+    uint8_t hour = cmos_read(0x04);
+    uint8_t day = cmos_read(0x07);
+    uint8_t mon = cmos_read(0x08);
+    uint8_t year = cmos_read(0x09);
+    uint8_t status_b = cmos_read(0x0B);
+
+    uint8_t pm = hour & 0x80;    // 12-hour mode only
+    hour &= 0x7F;
+    if (!(status_b & 0x04)) {
+        sec = bcd_to_bin(sec);
+        min = bcd_to_bin(min);
+        hour = bcd_to_bin(hour);
+        day = bcd_to_bin(day);
+        mon = bcd_to_bin(mon);
+        year = bcd_to_bin(year);
+    }
+    if (!(status_b & 0x02)) {
+        // 12-hour mode: 12 AM is hour 0, 12 PM stays 12
+        hour %= 12;
+        if (pm) {
+            hour += 12;
+        }
+    }
+    if (mon < 1 || mon > 12 || day < 1) {
+        return 0;
+    }
+
+    uint32_t full_year = 2000 + year;
+    uint32_t days = (full_year - 1970) * 365 + (full_year - 1969) / 4;
+    days += days_before_month[mon - 1] + day - 1;
+    if (mon > 2 && (full_year % 4) == 0) {
+        days++;
+    }
+    return days * 86400 + hour * 3600 + min * 60 + sec;
+}
+
+void vdso_init(void) {
+    memset(&vdso_page, 0, sizeof(vdso_page));
+    vdso_page.data.hz = TIMER_HZ;
+    vdso_page.data.boot_time = rtc_read_epoch();
+    vdso_page.data.tick_tsc = rdtsc();
+    cal_start_tsc = vdso_page.data.tick_tsc;
+    cal_ticks = 0;
+
+    // Readable from ring 3, never writable there. Kernel stores still go
+    // through since CR0.WP is clear.
+    uint32_t addr = (uint32_t)&vdso_page;
+    map_page(addr, addr, PAGE_PRESENT | PAGE_USER);
+}
+
+void vdso_tick(uint32_t ticks) {
+    uint64_t now = rdtsc();
+
+    vdso_write_begin();
+    vdso_page.data.ticks = ticks;
+    vdso_page.data.tick_tsc = now;
+
+    if (++cal_ticks == VDSO_CAL_TICKS) {
+        uint64_t elapsed = now - cal_start_tsc;
+        if (elapsed <= 0xFFFFFFFFu) {
+            uint32_t per_tick = (uint32_t)elapsed >> VDSO_CAL_SHIFT;
+            uint64_t scaled = (uint64_t)NS_PER_TICK << VDSO_TSC_SHIFT;
+            // Quotient fits 32 bits unless the TSC is absurdly slow
+            if (per_tick > (uint32_t)(scaled >> 32)) {
+                vdso_page.data.tsc_per_tick = per_tick;
+                vdso_page.data.tsc_mult = div64_32(scaled, per_tick);
+            }
+        }
+        cal_start_tsc = now;
+        cal_ticks = 0;
+    }
+    vdso_write_end();
+}
+
+// Called with interrupts disabled
+void vdso_set_task(struct process* task) {
+    if (!task) {
+        return;
+    }
+    vdso_write_begin();
+    vdso_page.data.pid = task->tgid;
+    vdso_page.data.tid = task->pid;
+    vdso_page.data.uid = task->shared ? task->shared->uid : 0;
+    vdso_page.data.gid = task->shared ? task->shared->gid : 0;
+    vdso_write_end();
+}
+
+vdso_data_t* vdso_get_page(void) {
+    return &vdso_page.data;
+}
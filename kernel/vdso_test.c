@@ -0,0 +1,72 @@
+#include "../include/vdso.h"
+#include "../include/syscall.h"
+#include "../include/string.h"
+#include "cpu.h"
+#include "test_output.h"
+
+#define QUERY_ROUNDS 10000
+
+static uint32_t cycles_per_round(uint64_t start) {
+    uint64_t elapsed = rdtsc() - start;
+    uint32_t cycles = (elapsed > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)elapsed;
+    return cycles / QUERY_ROUNDS;
+}
+
+// Trap-free time and identity test process
+void vdso_test_process(void) {
+    char msg[] = "VDSO Test: Kernel data page test started!\n";
+    syscall(SYS_WRITE, 1, (uint32_t)msg, sizeof(msg) - 1);
+
+    if ((uint32_t)vdso_getpid() == syscall(SYS_GETPID, 0, 0, 0) &&
+        (uint32_t)vdso_gettid() == syscall(SYS_GETTID, 0, 0, 0) &&
+        vdso_getuid() == syscall(SYS_GETUID, 0, 0, 0)) {
+        char id_msg[] = "VDSO Test: Identity matches syscalls\n";
+        syscall(SYS_WRITE, 1, (uint32_t)id_msg, sizeof(id_msg) - 1);
+    }
+
+    // The monotonic clock must never go backwards
+    vdso_timespec_t prev, now;
+    vdso_clock_gettime(VDSO_CLOCK_MONOTONIC, &prev);
+    int monotonic = 1;
+    uint64_t start = rdtsc();
+    for (int i = 0; i < QUERY_ROUNDS; i++) {
+        vdso_clock_gettime(VDSO_CLOCK_MONOTONIC, &now);
+        if (now.tv_sec < prev.tv_sec ||
+            (now.tv_sec == prev.tv_sec && now.tv_nsec < prev.tv_nsec)) {
+            monotonic = 0;
+        }
+        prev = now;
+    }
+    uint32_t clock_cycles = cycles_per_round(start);
+    if (monotonic) {
+        char mono_msg[] = "VDSO Test: Monotonic clock OK\n";
+        syscall(SYS_WRITE, 1, (uint32_t)mono_msg, sizeof(mono_msg) - 1);
+    }
+
+    start = rdtsc();
+    for (int i = 0; i < QUERY_ROUNDS; i++) {
+        syscall(SYS_GETPID, 0, 0, 0);
+    }
+    uint32_t trap_cycles = cycles_per_round(start);
+
+    start = rdtsc();
+    for (int i = 0; i < QUERY_ROUNDS; i++) {
+        vdso_getpid();
+    }
+    uint32_t vdso_cycles = cycles_per_round(start);
+
+    test_print_value("VDSO Test: clock_gettime cycles: ", clock_cycles);
+    test_print_value("VDSO Test: getpid via trap cycles: ", trap_cycles);
+    test_print_value("VDSO Test: getpid via page cycles: ", vdso_cycles);
+
+    vdso_clock_gettime(VDSO_CLOCK_REALTIME, &now);
+    test_print_value("VDSO Test: Wall clock seconds: ", now.tv_sec);
+
+    while (1) {
+        // Yield to other processes
+        syscall(SYS_YIELD, 0, 0, 0);
+
+        // Simple delay
+        for (volatile int i = 0; i < 50000; i++);
+    }
+}
@@ -0,0 +1,158 @@
+#include "../include/wait.h"
+#include "process.h"
+#include "cpu.h"
+#include "../drivers/timer.h"
+
+void wait_queue_init(wait_queue_t* wq, const char* name) {
+    spin_lock_init(&wq->lock, name);
+    wq->head = NULL;
+    wq->tail = NULL;
+}
+
+int wait_queue_empty(wait_queue_t* wq) {
+    return wq->head == NULL;
+}
+
+uint32_t wait_prepare(wait_queue_t* wq, wait_queue_entry_t* entry) {
+    uint32_t flags = irq_save();
+    process_t* self = process_get_current();
+
+    entry->task = self;
+    entry->next = NULL;
+    entry->woken = 0;
+
+    spin_lock(&wq->lock);
+    if (wq->tail) {
+        wq->tail->next = entry;
+    } else {
+        wq->head = entry;
+    }
+    wq->tail = entry;
+    spin_unlock(&wq->lock);
+
+    // Mark ourselves blocked before the caller re-checks its condition,
+    // so a wake_up() that races with the check cannot be lost
+    if (self) {
+        process_set_state(self, PROCESS_BLOCKED);
+    }
+
+    // Interrupts stay disabled until wait_finish()
+    return flags;
+}
+
+void wait_block(void) {
+    process_t* self = process_get_current();
+
+    schedule();
+
+    // schedule() leaves us current when nothing else is runnable;
+    // idle until an interrupt handler wakes us. Before process_init()
+    // there is no task to block, so just wait for the next interrupt.
+    if (!self) {
+        process_idle();
+        return;
+    }
+    while (self->state == PROCESS_BLOCKED) {
+        process_idle();
+    }
+}
+
+uint32_t wait_deadline(uint32_t timeout_ticks) {
+    return timer_get_ticks() + timeout_ticks;
+}
+
+int wait_timed_out(uint32_t deadline) {
+    return (int32_t)(timer_get_ticks() - deadline) >= 0;
+}
+
+// The timer tick makes us runnable again at the deadline
+void wait_block_timeout(uint32_t deadline) {
+    process_t* self = process_get_current();
+    if (self) {
+        self->wake_deadline = deadline;
+        self->timer_armed = 1;
+    }
+    wait_block();
+    if (self) {
+        self->timer_armed = 0;
+    }
+}
+
+void wait_finish(wait_queue_t* wq, wait_queue_entry_t* entry, uint32_t flags) {
+    process_t* self = entry->task;
+
+    spin_lock(&wq->lock);
+    if (!entry->woken) {
+        // Condition became true without a wake_up(): unlink ourselves
+        wait_queue_entry_t* prev = NULL;
+        wait_queue_entry_t* cur = wq->head;
+        while (cur && cur != entry) {
+            prev = cur;
+            cur = cur->next;
+        }
+        if (cur) {
+            if (prev) {
+                prev->next = cur->next;
+            } else {
+                wq->head = cur->next;
+            }
+            if (wq->tail == cur) {
+                wq->tail = prev;
+            }
+        }
+    }
+    spin_unlock(&wq->lock);
+
+    if (self) {
+        process_set_state(self, PROCESS_RUNNING);
+    }
+    irq_restore(flags);
+}
+
+// Pop the first sleeper and make it runnable. Called with wq->lock held.
+static int wake_one_locked(wait_queue_t* wq, process_t** task) {
+    wait_queue_entry_t* entry = wq->head;
+    if (!entry) {
+        return 0;
+    }
+    if (task) {
+        *task = entry->task;
+    }
+
+    wq->head = entry->next;
+    if (!wq->head) {
+        wq->tail = NULL;
+    }
+    entry->next = NULL;
+    entry->woken = 1;
+
+    if (entry->task && entry->task->state == PROCESS_BLOCKED) {
+        process_set_state(entry->task, PROCESS_READY);
+    }
+    return 1;
+}
+
+int wake_up(wait_queue_t* wq) {
+    uint32_t flags = spin_lock_irqsave(&wq->lock);
+    int woken = wake_one_locked(wq, NULL);
+    spin_unlock_irqrestore(&wq->lock, flags);
+    return woken;
+}
+
+struct process* wake_up_task(wait_queue_t* wq) {
+    process_t* task = NULL;
+    uint32_t flags = spin_lock_irqsave(&wq->lock);
+    wake_one_locked(wq, &task);
+    spin_unlock_irqrestore(&wq->lock, flags);
+    return task;
+}
+
+int wake_up_all(wait_queue_t* wq) {
+    int woken = 0;
+    uint32_t flags = spin_lock_irqsave(&wq->lock);
+    while (wake_one_locked(wq, NULL)) {
+        woken++;
+    }
+    spin_unlock_irqrestore(&wq->lock, flags);
+    return woken;
+}
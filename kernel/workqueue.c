@@ -0,0 +1,84 @@
+#include "../include/workqueue.h"
+#include "../include/spinlock.h"
+#include "../include/wait.h"
+#include "process.h"
+#include "log.h"
+
+// Single global queue served by the "kworker" kernel thread
+static work_t* work_head = NULL;
+static work_t* work_tail = NULL;
+static spinlock_t work_lock;
+static wait_queue_t worker_wait;
+static volatile uint32_t work_processed = 0;
+
+static work_t* work_dequeue(void) {
+    uint32_t flags = spin_lock_irqsave(&work_lock);
+    work_t* work = work_head;
+    if (work) {
+        work_head = work->next;
+        if (!work_head) {
+            work_tail = NULL;
+        }
+        work->next = NULL;
+        // Clear before running so the work can be re-queued from its own func
+        work->pending = 0;
+    }
+    spin_unlock_irqrestore(&work_lock, flags);
+    return work;
+}
+
+// Worker thread: sleeps until work is queued, then runs it in order
+static void worker_thread(void) {
+    while (1) {
+        wait_event(worker_wait, work_head != NULL);
+
+        work_t* work;
+        while ((work = work_dequeue()) != NULL) {
+            work->func(work);
+            work_processed++;
+        }
+    }
+}
+
+void workqueue_init(void) {
+    spin_lock_init(&work_lock, "workqueue");
+    wait_queue_init(&worker_wait, "kworker");
+    work_head = NULL;
+    work_tail = NULL;
+
+    if (process_create("kworker", worker_thread) < 0) {
+        log_error("Failed to create kworker thread");
+    }
+}
+
+void work_init(work_t* work, void (*func)(work_t*), void* data) {
+    work->func = func;
+    work->data = data;
+    work->pending = 0;
+    work->next = NULL;
+}
+
+int queue_work(work_t* work) {
+    uint32_t flags = spin_lock_irqsave(&work_lock);
+    if (work->pending) {
+        spin_unlock_irqrestore(&work_lock, flags);
+        return 0;
+    }
+
+    work->pending = 1;
+    work->next = NULL;
+    if (work_tail) {
+        work_tail->next = work;
+    } else {
+        work_head = work;
+    }
+    work_tail = work;
+    spin_unlock_irqrestore(&work_lock, flags);
+
+    wake_up(&worker_wait);
+    return 1;
+}
+
+uint32_t workqueue_get_processed(void) {
+    return work_processed;
+}